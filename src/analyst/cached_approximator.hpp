@@ -4,6 +4,7 @@
 #include <pomagma/platform/hash_map.hpp>
 #include <pomagma/platform/async_map.hpp>
 #include <pomagma/platform/unique_set.hpp>
+#include <pomagma/analyst/term_arena.hpp>
 #include <tbb/concurrent_unordered_map.h>
 
 namespace pomagma
@@ -64,24 +65,13 @@ public:
 
         struct Hash
         {
-            std::hash<std::string> hash_string;
-            std::hash<const HashedApproximation *> hash_pointer;
-
-            uint64_t operator() (const Term & x) const
-            {
-                FNV_hash::HashState state;
-                state.add(x.arity);
-                state.add(hash_string(x.name));
-                state.add(hash_pointer(x.arg0));
-                state.add(hash_pointer(x.arg1));
-                state.add(x.ob);
-                return state.get();
-            }
+            uint64_t operator() (const Term & x) const { return x.hash; }
         };
 
         bool operator== (const Term & o) const
         {
-            return arity == o.arity
+            return hash == o.hash
+               and arity == o.arity
                and name == o.name
                and arg0 == o.arg0
                and arg1 == o.arg1
@@ -89,11 +79,23 @@ public:
         }
         bool operator!= (const Term & o) const { return not operator==(o); }
 
+        Term () {}
+        Term (
+                Arity a,
+                const std::string * n,
+                const HashedApproximation * a0,
+                const HashedApproximation * a1,
+                Ob o)
+            : arity(a), name(n), arg0(a0), arg1(a1), ob(o),
+              hash(hash_term(arity, name, arg0, arg1, ob))
+        {}
+
         Arity arity;
-        std::string name;
+        const std::string * name; // interned
         const HashedApproximation * arg0;
         const HashedApproximation * arg1;
         Ob ob;
+        uint64_t hash;
     };
 
 private:
@@ -147,7 +149,7 @@ public:
             const Term & term,
             Cache::Callback callback)
     {
-        const Term * key = m_terms.insert_or_delete(new Term(term));
+        const Term * key = m_terms.insert(term);
         m_cache.find_async(key, callback);
     }
 
@@ -155,7 +157,7 @@ private:
 
     Approximation compute (const Term * term)
     {
-        const auto & name = term->name;
+        const auto & name = * term->name;
         auto * arg0 = term->arg0;
         auto * arg1 = term->arg1;
 
@@ -186,7 +188,7 @@ private:
     WorkerPool<Task, Processor> m_pool;
     AsyncFunction m_function;
     UniqueSet<HashedApproximation, HashedApproximation::Hash> m_approximations;
-    UniqueSet<Term, Term::Hash> m_terms;
+    TermArena<Term> m_terms;
     Cache m_cache;
 };
 
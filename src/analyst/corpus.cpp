@@ -1,5 +1,6 @@
 #include "corpus.hpp"
-#include <pomagma/platform/unique_set.hpp>
+#include <tbb/concurrent_unordered_set.h>
+#include <omp.h>
 #include <map>
 #include <queue>
 
@@ -8,24 +9,33 @@ namespace pomagma
 
 //----------------------------------------------------------------------------
 // Dag
+//
+// The dag may be built concurrently from openmp threads: terms are
+// hash-consed in a concurrent arena. Between fork() and join(), each thread
+// counts its terms in its own histogram; join() folds them into the total.
 
 class Corpus::Dag
 {
 public:
 
     Dag (Signature & signature)
-        : m_signature(signature),
-          m_new_term(new Term())
+        : m_signature(signature)
     {}
 
-    const Term * semi_true () { return nullary_function("I"); }
-    const Term * semi_false () { return nullary_function("BOT"); }
+    // interned names are compared and hashed by address
+    const std::string * intern (const std::string & name)
+    {
+        return & * m_names.insert(name).first;
+    }
+
+    const Term * semi_true () { return nullary_function(intern("I")); }
+    const Term * semi_false () { return nullary_function(intern("BOT")); }
     const Term * semi_and (const Term * lhs, const Term * rhs)
     {
         if (lhs > rhs) {
             std::swap(lhs, rhs);
         }
-        return binary_function("APP", lhs, rhs);
+        return binary_function(intern("APP"), lhs, rhs);
     }
 
     const Term * hole ()
@@ -33,14 +43,14 @@ public:
         return get(Term(Term::HOLE));
     }
     const Term * variable (
-            const std::string & name)
+            const std::string * name)
     {
         return get(Term(Term::VARIABLE, name));
     }
     const Term * nullary_function (
-            const std::string & name)
+            const std::string * name)
     {
-        if (auto * fun = m_signature.nullary_function(name)) {
+        if (auto * fun = m_signature.nullary_function(* name)) {
             if (Ob ob = fun->find()) {
                 return get(Term(ob));
             }
@@ -48,11 +58,11 @@ public:
         return get(Term(Term::NULLARY_FUNCTION, name));
     }
     const Term * injective_function (
-            const std::string & name,
+            const std::string * name,
             const Term * arg)
     {
         if (arg->ob) {
-            if (auto * fun = m_signature.injective_function(name)) {
+            if (auto * fun = m_signature.injective_function(* name)) {
                 if (Ob ob = fun->find(arg->ob)) {
                     return get(Term(ob));
                 }
@@ -61,12 +71,12 @@ public:
         return get(Term(Term::INJECTIVE_FUNCTION, name, arg));
     }
     const Term * binary_function (
-            const std::string & name,
+            const std::string * name,
             const Term * lhs,
             const Term * rhs)
     {
         if (lhs->ob and rhs->ob) {
-            if (auto * fun = m_signature.binary_function(name)) {
+            if (auto * fun = m_signature.binary_function(* name)) {
                 if (Ob ob = fun->find(lhs->ob, rhs->ob)) {
                     return get(Term(ob));
                 }
@@ -75,12 +85,12 @@ public:
         return get(Term(Term::BINARY_FUNCTION, name, lhs, rhs));
     }
     const Term * symmetric_function (
-            const std::string & name,
+            const std::string * name,
             const Term * lhs,
             const Term * rhs)
     {
         if (lhs->ob and rhs->ob) {
-            if (auto * fun = m_signature.symmetric_function(name)) {
+            if (auto * fun = m_signature.symmetric_function(* name)) {
                 if (Ob ob = fun->find(lhs->ob, rhs->ob)) {
                     return get(Term(ob));
                 }
@@ -92,17 +102,17 @@ public:
         return get(Term(Term::SYMMETRIC_FUNCTION, name, lhs, rhs));
     }
     const Term * binary_relation (
-            const std::string & name,
+            const std::string * name,
             const Term * lhs,
             const Term * rhs)
     {
         if (lhs->ob and rhs->ob) {
-            if (auto * rel = m_signature.binary_relation(name)) {
+            if (auto * rel = m_signature.binary_relation(* name)) {
                 if (rel->find(lhs->ob, rhs->ob)) {
                     return semi_true();
                 }
             }
-            std::string negated = m_signature.negate(name);
+            std::string negated = m_signature.negate(* name);
             if (auto * negated_rel = m_signature.binary_relation(negated)) {
                 if (negated_rel->find(lhs->ob, rhs->ob)) {
                     return semi_false();
@@ -118,30 +128,51 @@ public:
         if (lhs->ob and rhs->ob and lhs == rhs) {
             return semi_true();
         } else {
-            const Term * less_lhs_rhs = binary_relation("LESS", lhs, rhs);
-            const Term * less_rhs_lhs = binary_relation("LESS", rhs, lhs);
+            const std::string * LESS = intern("LESS");
+            const Term * less_lhs_rhs = binary_relation(LESS, lhs, rhs);
+            const Term * less_rhs_lhs = binary_relation(LESS, rhs, lhs);
             return semi_and(less_lhs_rhs, less_rhs_lhs);
         }
     }
 
     const Histogram & histogram () const { return m_histogram; }
 
+    // called by one thread of a parallel region, before any terms are built
+    void fork (size_t thread_count)
+    {
+        POMAGMA_ASSERT(m_histograms.empty(), "dag is already forked");
+        m_histograms.resize(thread_count);
+    }
+
+    // called serially, after the parallel region
+    void join ()
+    {
+        for (const Histogram & histogram : m_histograms) {
+            m_histogram.merge(histogram);
+        }
+        m_histograms.clear();
+    }
+
 private:
 
-    const Term * get (Term && key)
+    const Term * get (const Term & key)
     {
-        * m_new_term = key;
-        const Term * term = m_terms.insert(m_new_term);
-        m_histogram.add(term);
-        if (term == m_new_term) {
-            m_new_term = new Term();
+        const Term * term = m_terms.insert(key);
+        if (m_histograms.empty()) {
+            m_histogram.add(term);
+        } else {
+            const size_t thread = omp_get_thread_num();
+            POMAGMA_ASSERT(thread < m_histograms.size(),
+                "thread " << thread << " outside of forked dag");
+            m_histograms[thread].add(term);
         }
         return term;
     }
 
     Signature & m_signature;
-    Term * m_new_term;
-    UniqueSet<Term, Term::Hash, false> m_terms;
+    tbb::concurrent_unordered_set<std::string> m_names;
+    TermArena<Term> m_terms;
+    std::vector<Histogram> m_histograms;
     Histogram m_histogram;
 };
 
@@ -200,22 +231,22 @@ private:
     {
         std::string token = parse_token();
         if (m_signature.nullary_function(token)) {
-            return m_dag.nullary_function(token);
+            return m_dag.nullary_function(m_dag.intern(token));
         } else if (m_signature.injective_function(token)) {
             const Term * key = parse_term();
-            return m_dag.injective_function(token, key);
+            return m_dag.injective_function(m_dag.intern(token), key);
         } else if (m_signature.binary_function(token)) {
             const Term * lhs = parse_term();
             const Term * rhs = parse_term();
-            return m_dag.binary_function(token, lhs, rhs);
+            return m_dag.binary_function(m_dag.intern(token), lhs, rhs);
         } else if (m_signature.symmetric_function(token)) {
             const Term * lhs = parse_term();
             const Term * rhs = parse_term();
-            return m_dag.symmetric_function(token, lhs, rhs);
+            return m_dag.symmetric_function(m_dag.intern(token), lhs, rhs);
         } else if (m_signature.binary_relation(token)) {
             const Term * lhs = parse_term();
             const Term * rhs = parse_term();
-            return m_dag.binary_relation(token, lhs, rhs);
+            return m_dag.binary_relation(m_dag.intern(token), lhs, rhs);
         } else if (token == "EQUAL") {
             const Term * lhs = parse_term();
             const Term * rhs = parse_term();
@@ -224,7 +255,7 @@ private:
             return m_dag.hole();
         } else if (token == "VAR") {
             std::string name = parse_token();
-            return m_dag.variable(name);
+            return m_dag.variable(m_dag.intern(name));
         } else {
             POMAGMA_PARSER_WARN(
                 "unrecognized token '" << token << "' in: " << m_stream.str());
@@ -262,11 +293,16 @@ Corpus::Linker::Linker (
 {
 }
 
+const Corpus::Term * Corpus::Linker::link (const Term * term)
+{
+    return link(term, m_error_log);
+}
+
 inline void Corpus::Linker::define (
         const std::string & name,
         const Term * term)
 {
-    const Term * var = m_dag.variable(name);
+    const Term * var = m_dag.variable(m_dag.intern(name));
     auto pair = m_definitions.insert(std::make_pair(var, term));
     if (not pair.second) {
         POMAGMA_DEBUG("multiple definition of: " << name);
@@ -328,9 +364,11 @@ void Corpus::Linker::finish ()
                             << m_definitions.size() << " terms");
 }
 
-const Corpus::Term * Corpus::Linker::link (const Term * term)
+const Corpus::Term * Corpus::Linker::link (
+        const Term * term,
+        std::vector<std::string> & error_log)
 {
-    const std::string & name = term->name;
+    const std::string * name = term->name;
     const Term * const arg0 = term->arg0;
     const Term * const arg1 = term->arg1;
 
@@ -341,24 +379,33 @@ const Corpus::Term * Corpus::Linker::link (const Term * term)
             return term;
 
         case Term::INJECTIVE_FUNCTION:
-            return m_dag.injective_function(name, link(arg0));
+            return m_dag.injective_function(name, link(arg0, error_log));
 
         case Term::BINARY_FUNCTION:
-            return m_dag.binary_function(name, link(arg0), link(arg1));
+            return m_dag.binary_function(
+                name,
+                link(arg0, error_log),
+                link(arg1, error_log));
 
         case Term::SYMMETRIC_FUNCTION:
-            return m_dag.symmetric_function(name, link(arg0), link(arg1));
+            return m_dag.symmetric_function(
+                name,
+                link(arg0, error_log),
+                link(arg1, error_log));
 
         case Term::BINARY_RELATION:
-            return m_dag.binary_relation(name, link(arg0), link(arg1));
+            return m_dag.binary_relation(
+                name,
+                link(arg0, error_log),
+                link(arg1, error_log));
 
         case Term::VARIABLE:
             if (m_ground_terms.find(term) != m_ground_terms.end()) {
                 return m_definitions.find(term)->second;
             } else {
                 if (m_definitions.find(term) == m_definitions.end()) {
-                    POMAGMA_DEBUG("missing definition of: " << name);
-                    m_error_log.push_back("missing definition of: " + name);
+                    POMAGMA_DEBUG("missing definition of: " << * name);
+                    error_log.push_back("missing definition of: " + * name);
                 }
                 return term;
             }
@@ -378,7 +425,7 @@ const Corpus::Term * Corpus::Linker::approximate (
 const Corpus::Term * Corpus::Linker::approximate (
         const Term * term)
 {
-    const std::string & name = term->name;
+    const std::string * name = term->name;
     const Term * const arg0 = term->arg0;
     const Term * const arg1 = term->arg1;
 
@@ -443,19 +490,68 @@ Corpus::~Corpus ()
     delete & m_dag;
 }
 
+// Lines are parsed concurrently, one parser per thread. Errors are collected
+// per line and appended in line order, so the log is deterministic.
+template<class Body>
+void Corpus::parse_all (
+        const std::vector<Corpus::LineOf<std::string>> & lines,
+        std::vector<LineOf<Body>> & parsed,
+        std::vector<std::string> & error_log,
+        std::function<Body(const Term *, std::vector<std::string> &)> finish)
+{
+    const size_t line_count = lines.size();
+    parsed.resize(line_count);
+    std::vector<std::vector<std::string>> line_error_logs(line_count);
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        m_dag.fork(omp_get_num_threads());
+
+        std::vector<std::string> local_error_log;
+        Parser parser(m_signature, m_dag, local_error_log);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t i = 0; i < line_count; ++i) {
+            const auto & line = lines[i];
+            const Term * term = parser.parse(line.body);
+            parsed[i].maybe_name = line.maybe_name;
+            parsed[i].body = finish(term, local_error_log);
+            line_error_logs[i].swap(local_error_log);
+        }
+    }
+    m_dag.join();
+
+    for (const auto & line_error_log : line_error_logs) {
+        error_log.insert(
+            error_log.end(),
+            line_error_log.begin(),
+            line_error_log.end());
+    }
+}
+
 Corpus::Linker Corpus::linker (
         const std::vector<Corpus::LineOf<std::string>> & lines,
         std::vector<std::string> & error_log)
 {
-    Parser parser(m_signature, m_dag, error_log);
-    Linker linker(m_dag, error_log);
+    std::vector<LineOf<std::string>> definitions;
     for (const auto & line : lines) {
         if (line.has_name()) {
-            const std::string & name = line.maybe_name;
-            const Term * term = parser.parse(line.body);
-            linker.define(name, term);
+            definitions.push_back(line);
         }
     }
+
+    std::vector<LineOf<const Term *>> parsed;
+    parse_all<const Term *>(
+        definitions,
+        parsed,
+        error_log,
+        [](const Term * term, std::vector<std::string> &){ return term; });
+
+    Linker linker(m_dag, error_log);
+    for (const auto & line : parsed) {
+        linker.define(line.maybe_name, line.body);
+    }
     linker.finish();
     return linker;
 }
@@ -465,13 +561,14 @@ std::vector<Corpus::LineOf<const Corpus::Term *>> Corpus::parse (
         Corpus::Linker & linker,
         std::vector<std::string> & error_log)
 {
-    Parser parser(m_signature, m_dag, error_log);
     std::vector<LineOf<const Term *>> parsed;
-    for (const auto & line : lines) {
-        const Term * term = parser.parse(line.body);
-        const Term * linked = linker.link(term);
-        parsed.push_back(LineOf<const Term *>({line.maybe_name, linked}));
-    }
+    parse_all<const Term *>(
+        lines,
+        parsed,
+        error_log,
+        [&](const Term * term, std::vector<std::string> & local_error_log){
+            return linker.link(term, local_error_log);
+        });
     return parsed;
 }
 
@@ -2,8 +2,9 @@
 
 #include <pomagma/macrostructure/util.hpp>
 #include <pomagma/analyst/approximate.hpp>
-#include <pomagma/platform/hash_map.hpp>
+#include <pomagma/analyst/term_arena.hpp>
 #include <unordered_set>
+#include <functional>
 
 namespace pomagma
 {
@@ -30,24 +31,13 @@ public:
 
         struct Hash
         {
-            std::hash<std::string> hash_string;
-            std::hash<const Term *> hash_pointer;
-
-            uint64_t operator() (const Term & x) const
-            {
-                FNV_hash::HashState state;
-                state.add(x.arity);
-                state.add(hash_string(x.name));
-                state.add(hash_pointer(x.arg0));
-                state.add(hash_pointer(x.arg1));
-                state.add(x.ob);
-                return state.get();
-            }
+            uint64_t operator() (const Term & x) const { return x.hash; }
         };
 
         bool operator== (const Term & o) const
         {
-            return arity == o.arity
+            return hash == o.hash
+               and arity == o.arity
                and name == o.name
                and arg0 == o.arg0
                and arg1 == o.arg1
@@ -57,21 +47,24 @@ public:
 
         Term () {}
         Term (Ob o)
-            : arity(OB), name(), arg0(nullptr), arg1(nullptr), ob(o)
+            : arity(OB), name(nullptr), arg0(nullptr), arg1(nullptr), ob(o),
+              hash(hash_term(arity, name, arg0, arg1, ob))
         {}
         Term (
                 Arity a,
-                const std::string & n = "",
+                const std::string * n = nullptr,
                 const Term * a0 = nullptr,
                 const Term * a1 = nullptr)
-            : arity(a), name(n), arg0(a0), arg1(a1), ob(0)
+            : arity(a), name(n), arg0(a0), arg1(a1), ob(0),
+              hash(hash_term(arity, name, arg0, arg1, ob))
         {}
 
         Arity arity;
-        std::string name;
+        const std::string * name; // interned
         const Term * arg0;
         const Term * arg1;
         Ob ob;
+        uint64_t hash;
     };
 
     template<class T>
@@ -93,6 +86,9 @@ public:
         Linker (Dag & dag, std::vector<std::string> & error_log);
         void define (const std::string & name, const Term * term);
         void finish ();
+        const Term * link (
+                const Term * term,
+                std::vector<std::string> & error_log);
         const Term * approximate (const Term * term);
         static void accum_free (
                 const Term * term,
@@ -112,6 +108,16 @@ public:
         std::unordered_map<std::string, size_t> symbols;
         std::unordered_map<Ob, size_t> obs;
 
+        void merge (const Histogram & other)
+        {
+            for (const auto & pair : other.symbols) {
+                symbols[pair.first] += pair.second;
+            }
+            for (const auto & pair : other.obs) {
+                obs[pair.first] += pair.second;
+            }
+        }
+
         void add (const Term * term)
         {
             switch (term->arity) {
@@ -124,7 +130,7 @@ public:
                 case Term::BINARY_FUNCTION:
                 case Term::SYMMETRIC_FUNCTION:
                 case Term::BINARY_RELATION:
-                    ++symbols[term->name];
+                    ++symbols[* term->name];
                     break;
 
                 case Term::HOLE:
@@ -150,6 +156,14 @@ public:
 
 private:
 
+    template<class Body>
+    void parse_all (
+            const std::vector<LineOf<std::string>> & lines,
+            std::vector<LineOf<Body>> & parsed,
+            std::vector<std::string> & error_log,
+            std::function<Body(const Term *, std::vector<std::string> &)>
+                finish);
+
     Signature & m_signature;
     Dag & m_dag;
 };
@@ -27,7 +27,7 @@ Server::Server (
 
     Router router(m_structure.signature(), m_language);
     m_probs = router.measure_probs();
-    m_routes = router.find_routes();
+    m_routes = router.find_route_dag();
 }
 
 Server::~Server ()
@@ -81,7 +81,7 @@ std::unordered_map<std::string, float> Server::fit_language (
     }
 
     m_probs = router.measure_probs();
-    m_routes = router.find_routes();
+    m_routes = router.find_route_dag();
     return m_language;
 }
 
@@ -3,6 +3,7 @@
 #include "corpus.hpp"
 #include "validator.hpp"
 #include <pomagma/macrostructure/structure.hpp>
+#include <pomagma/macrostructure/router.hpp>
 
 namespace pomagma
 {
@@ -14,7 +15,7 @@ class Server
     Approximator m_approximator;
     ApproximateParser m_approximate_parser;
     std::vector<float> m_probs;
-    std::vector<std::string> m_routes;
+    RouteDag m_routes;
     SimplifyParser m_simplifier;
     Corpus m_corpus;
     Validator m_validator;
@@ -2,15 +2,17 @@
 
 #include <pomagma/macrostructure/util.hpp>
 #include <pomagma/macrostructure/structure_impl.hpp>
+#include <pomagma/macrostructure/router.hpp>
 #include <pomagma/platform/parser.hpp>
 
 namespace pomagma
 {
 
+// routes of known obs are looked up lazily, only when needed
 struct SimplifyTerm
 {
     Ob ob;
-    std::string route;
+    std::string route; // empty if ob is known
 };
 
 class SimplifyReducer : noncopyable
@@ -19,63 +21,72 @@ public:
 
     typedef SimplifyTerm Term;
 
-    SimplifyReducer (const std::vector<std::string> & routes)
+    SimplifyReducer (const RouteDag & routes)
         : m_routes(routes)
     {
     }
 
+    std::string route (const SimplifyTerm & term) const
+    {
+        return term.ob ? m_routes[term.ob] : term.route;
+    }
+
     SimplifyTerm reduce (
             const std::string & token,
             const NullaryFunction * fun)
     {
         SimplifyTerm val;
         val.ob = fun->find();
-        val.route = val.ob ? m_routes[val.ob] : token;
+        if (not val.ob) {
+            val.route = token;
+        }
         return val;
     }
 
     SimplifyTerm reduce (
             const std::string & token,
             const InjectiveFunction * fun,
-            SimplifyTerm key)
+            const SimplifyTerm & key)
     {
         SimplifyTerm val;
         val.ob = key.ob ? fun->find(key.ob) : 0;
-        val.route = val.ob ? m_routes[val.ob] : token + " " + key.route;
+        if (not val.ob) {
+            val.route = token + " " + route(key);
+        }
         return val;
     }
 
     SimplifyTerm reduce (
             const std::string & token,
             const BinaryFunction * fun,
-            SimplifyTerm lhs,
-            SimplifyTerm rhs)
+            const SimplifyTerm & lhs,
+            const SimplifyTerm & rhs)
     {
         SimplifyTerm val;
         val.ob = lhs.ob and rhs.ob ? fun->find(lhs.ob, rhs.ob) : 0;
-        val.route = val.ob
-                  ? m_routes[val.ob]
-                  : token + " " + lhs.route + " " + rhs.route;
+        if (not val.ob) {
+            val.route = token + " " + route(lhs) + " " + route(rhs);
+        }
         return val;
     }
 
     SimplifyTerm reduce (
             const std::string & token,
             const SymmetricFunction * fun,
-            SimplifyTerm lhs,
-            SimplifyTerm rhs)
+            const SimplifyTerm & lhs,
+            const SimplifyTerm & rhs)
     {
         SimplifyTerm val;
         val.ob = lhs.ob and rhs.ob ? fun->find(lhs.ob, rhs.ob) : 0;
-        val.route = val.ob
-                  ? m_routes[val.ob]
-                  : token + " " + lhs.route + " " + rhs.route;
+        if (not val.ob) {
+            val.route = token + " " + route(lhs) + " " + route(rhs);
+        }
         return val;
     }
 
 private:
 
-    const std::vector<std::string> & m_routes;
+    const RouteDag & m_routes;
 };
 
 class SimplifyParser : public Parser<SimplifyReducer>
@@ -84,7 +95,7 @@ public:
 
     SimplifyParser (
             Signature & signature,
-            const std::vector<std::string> & routes)
+            const RouteDag & routes)
         : Parser<SimplifyReducer>(signature, m_reducer),
           m_reducer(routes)
     {
@@ -92,7 +103,7 @@ public:
 
     std::string simplify (const std::string & expression)
     {
-        return parse(expression).route;
+        return m_reducer.route(parse(expression));
     }
 
 private:
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <pomagma/platform/util.hpp>
+#include <pomagma/platform/hash_map.hpp>
+#include <unordered_set>
+#include <mutex>
+#include <tbb/concurrent_unordered_set.h>
+
+namespace pomagma
+{
+
+// Terms hash and compare names by address, since names are interned,
+// and args by address, since args are hash-consed.
+inline uint64_t hash_term (
+        int arity,
+        const std::string * name,
+        const void * arg0,
+        const void * arg1,
+        uint64_t ob)
+{
+    std::hash<const void *> hash_pointer;
+    FNV_hash::HashState state;
+    state.add(arity);
+    state.add(hash_pointer(name));
+    state.add(hash_pointer(arg0));
+    state.add(hash_pointer(arg1));
+    state.add(ob);
+    return state.get();
+}
+
+namespace detail
+{
+
+template<class Value, class Hash, class Equal, bool concurrent>
+struct arena_set;
+
+template<class Value, class Hash, class Equal>
+struct arena_set<Value, Hash, Equal, true>
+{
+    typedef typename tbb::concurrent_unordered_set<Value, Hash, Equal> t;
+};
+
+template<class Value, class Hash, class Equal>
+struct arena_set<Value, Hash, Equal, false>
+{
+    typedef typename std::unordered_set<Value, Hash, Equal> t;
+};
+
+} // namespace detail
+
+/// Hash-conses terms into blocks, so that terms can be compared by address.
+/// Lookups of existing terms do not allocate.
+template<class Term, bool concurrent = true>
+class TermArena : noncopyable
+{
+    enum { BLOCK_SIZE = 4096 };
+
+    struct EqualPtr
+    {
+        bool operator() (const Term * x, const Term * y) const
+        {
+            return (* x) == (* y);
+        }
+    };
+
+    struct HashPtr
+    {
+        uint64_t operator() (const Term * term) const
+        {
+            return term->hash;
+        }
+    };
+
+public:
+
+    TermArena () : m_block_pos(BLOCK_SIZE) {}
+    ~TermArena ()
+    {
+        for (Term * block : m_blocks) {
+            delete[] block;
+        }
+    }
+
+    const Term * insert (const Term & key)
+    {
+        auto i = m_terms.find(& key);
+        if (i != m_terms.end()) {
+            return * i;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_block_pos == BLOCK_SIZE) {
+            m_blocks.push_back(new Term[BLOCK_SIZE]);
+            m_block_pos = 0;
+        }
+        Term * term = m_blocks.back() + m_block_pos;
+        * term = key;
+        auto pair = m_terms.insert(term);
+        if (pair.second) {
+            ++m_block_pos;
+        }
+        return * pair.first;
+    }
+
+    size_t size () const { return m_terms.size(); }
+
+private:
+
+    std::mutex m_mutex;
+    std::vector<Term *> m_blocks;
+    size_t m_block_pos;
+    typename detail::arena_set<
+        const Term *,
+        HashPtr,
+        EqualPtr,
+        concurrent>::t
+    m_terms;
+};
+
+} // namespace pomagma
@@ -139,7 +139,7 @@ private:
         auto arg1 = term->arg1 ? m_cache.find(term->arg1) : nullptr;
         auto ob = term->ob;
 
-        return CachedApproximator::Term({arity, name, arg0, arg1, ob});
+        return CachedApproximator::Term(arity, name, arg0, arg1, ob);
     }
 
     Approximator & m_approximator;
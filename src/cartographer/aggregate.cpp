@@ -1,6 +1,9 @@
 #include "aggregate.hpp"
 #include <pomagma/macrostructure/structure_impl.hpp>
 #include <pomagma/macrostructure/scheduler.hpp>
+#include <algorithm>
+#include <functional>
+#include <mutex>
 
 namespace pomagma
 {
@@ -8,22 +11,159 @@ namespace pomagma
 namespace detail
 {
 
-void inject_one (
-        BinaryRelation & destin_rel,
+//----------------------------------------------------------------------------
+// Translation
+//
+// Source rows are partitioned across threads and translated through
+// src_to_destin into thread-local batches, which are concatenated and sorted
+// by destination row for locality. Translation only reads the source.
+
+typedef std::pair<Ob, Ob> Pair;
+
+struct Triple
+{
+    Ob lhs;
+    Ob rhs;
+    Ob val;
+
+    bool operator< (const Triple & other) const
+    {
+        return lhs < other.lhs or (lhs == other.lhs and rhs < other.rhs);
+    }
+};
+
+inline std::vector<Ob> get_rows (const DenseSet & src_defined)
+{
+    std::vector<Ob> rows;
+    for (auto iter = src_defined.iter(); iter.ok(); iter.next()) {
+        rows.push_back(* iter);
+    }
+    return rows;
+}
+
+std::vector<Pair> translate (
         const BinaryRelation & src_rel,
         const DenseSet & src_defined,
+        const std::vector<Ob> & src_rows,
         const std::vector<Ob> & src_to_destin)
 {
-    for (auto iter = src_defined.iter(); iter.ok(); iter.next()) {
-        Ob src_lhs = * iter;
-        Ob destin_lhs = src_to_destin[src_lhs];
-        for (auto iter = src_defined.iter_insn(src_rel.get_Lx_set(src_lhs));
-            iter.ok();
-            iter.next())
+    std::vector<Pair> result;
+    const size_t row_count = src_rows.size();
+
+    std::mutex mutex;
+    #pragma omp parallel
+    {
+        std::vector<Pair> batch;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t i = 0; i < row_count; ++i) {
+            Ob src_lhs = src_rows[i];
+            Ob destin_lhs = src_to_destin[src_lhs];
+            for (auto iter = src_defined.iter_insn(src_rel.get_Lx_set(src_lhs));
+                iter.ok();
+                iter.next())
+            {
+                Ob src_rhs = * iter;
+                Ob destin_rhs = src_to_destin[src_rhs];
+                batch.push_back(Pair(destin_lhs, destin_rhs));
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        result.insert(result.end(), batch.begin(), batch.end());
+    }
+
+    // distinct source obs may translate to the same rep
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+template<class Function>
+std::vector<Triple> translate (
+        const Function & src_fun,
+        const DenseSet & src_defined,
+        const std::vector<Ob> & src_rows,
+        const std::vector<Ob> & src_to_destin)
+{
+    std::vector<Triple> result;
+    const size_t row_count = src_rows.size();
+
+    std::mutex mutex;
+    #pragma omp parallel
+    {
+        std::vector<Triple> batch;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t i = 0; i < row_count; ++i) {
+            Ob src_lhs = src_rows[i];
+            Ob destin_lhs = src_to_destin[src_lhs];
+            for (auto iter = src_defined.iter_insn(src_fun.get_Lx_set(src_lhs));
+                iter.ok();
+                iter.next())
+            {
+                Ob src_rhs = * iter;
+                if (Function::is_symmetric() and src_rhs < src_lhs) {
+                    continue;
+                }
+                Ob src_val = src_fun.find(src_lhs, src_rhs);
+                Triple triple = {
+                    destin_lhs,
+                    src_to_destin[src_rhs],
+                    src_to_destin[src_val]};
+                batch.push_back(triple);
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        result.insert(result.end(), batch.begin(), batch.end());
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+//----------------------------------------------------------------------------
+// Injection
+//
+// Each destination table is written by exactly one iteration of a parallel
+// loop over tables. Since inserts only touch their own table, conflicting
+// values are not merged in place; they are collected as equations and merged
+// serially after all tables are written.
+
+void inject_one (
+        BinaryRelation & destin_rel,
+        const std::vector<Pair> & pairs,
+        std::vector<Pair> & equations __attribute__((unused)))
+{
+    DenseSet row(destin_rel.item_dim());
+    for (size_t begin = 0, end = 0; begin < pairs.size(); begin = end) {
+        const Ob lhs = pairs[begin].first;
+        for (end = begin; end < pairs.size() and pairs[end].first == lhs;
+            ++end)
         {
-            Ob src_rhs = * iter;
-            Ob destin_rhs = src_to_destin[src_rhs];
-            destin_rel.insert(destin_lhs, destin_rhs);
+            row.insert(pairs[end].second);
+        }
+        destin_rel.insert(lhs, row);
+        for (size_t i = begin; i < end; ++i) {
+            row.remove(pairs[i].second);
+        }
+    }
+}
+
+template<class Function>
+void inject_one (
+        Function & destin_fun,
+        const std::vector<Triple> & triples,
+        std::vector<Pair> & equations)
+{
+    for (const Triple & triple : triples) {
+        if (Ob val = destin_fun.find(triple.lhs, triple.rhs)) {
+            if (val != triple.val) {
+                equations.push_back(Pair(val, triple.val));
+            }
+        } else {
+            destin_fun.insert(triple.lhs, triple.rhs, triple.val);
         }
     }
 }
@@ -58,28 +198,23 @@ void inject_one (
     }
 }
 
-template<class Function>
-void inject_one (
-        Function & destin_fun,
-        const Function & src_fun,
-        const DenseSet & src_defined,
-        const std::vector<Ob> & src_to_destin)
+template<class T>
+std::vector<std::pair<T *, const T *>> match_all (
+        const std::unordered_map<std::string, T *> & destin_map,
+        const std::unordered_map<std::string, T *> & src_map)
 {
-    for (auto iter = src_defined.iter(); iter.ok(); iter.next()) {
-        Ob src_lhs = * iter;
-        Ob destin_lhs = src_to_destin[src_lhs];
-        for (auto iter = src_defined.iter_insn(src_fun.get_Lx_set(src_lhs));
-            iter.ok();
-            iter.next())
-        {
-            Ob src_rhs = * iter;
-            if (Function::is_symmetric() and src_rhs < src_lhs) { continue; }
-            Ob src_val = src_fun.find(src_lhs, src_rhs);
-            Ob destin_rhs = src_to_destin[src_rhs];
-            Ob destin_val = src_to_destin[src_val];
-            destin_fun.insert(destin_lhs, destin_rhs, destin_val);
+    std::vector<std::pair<T *, const T *>> result;
+    for (auto pair : destin_map) {
+        auto & name = pair.first;
+        auto i = src_map.find(name);
+        if (i == src_map.end()) {
+            POMAGMA_INFO("missing " << name);
+        } else {
+            POMAGMA_INFO("aggregating " << name);
+            result.push_back(std::make_pair(pair.second, i->second));
         }
     }
+    return result;
 }
 
 template<class T>
@@ -89,24 +224,74 @@ void inject_all (
         const DenseSet & src_defined,
         const std::vector<Ob> & src_to_destin)
 {
-    // TODO parallelize, except for nullary relations
-    for (auto pair : destin_map) {
-        auto & name = pair.first;
-        auto & destin = * pair.second;
-        auto i = src_map.find(name);
-        if (i == src_map.end()) {
-            POMAGMA_INFO("missing " << name);
-        } else {
-            POMAGMA_INFO("aggregating " << name);
-            auto & src = * i->second;
-            inject_one(destin, src, src_defined, src_to_destin);
+    for (auto pair : match_all(destin_map, src_map)) {
+        inject_one(* pair.first, * pair.second, src_defined, src_to_destin);
+    }
+}
+
+template<class T, class Tuple>
+struct Batch
+{
+    T * destin;
+    std::vector<Tuple> tuples;
+    std::vector<Pair> equations;
+};
+
+template<class T, class Tuple>
+void translate_all (
+        std::vector<Batch<T, Tuple>> & batches,
+        const std::unordered_map<std::string, T *> & destin_map,
+        const std::unordered_map<std::string, T *> & src_map,
+        const DenseSet & src_defined,
+        const std::vector<Ob> & src_rows,
+        const std::vector<Ob> & src_to_destin)
+{
+    for (auto pair : match_all(destin_map, src_map)) {
+        batches.push_back(Batch<T, Tuple>());
+        Batch<T, Tuple> & batch = batches.back();
+        batch.destin = pair.first;
+        batch.tuples = translate(
+            * pair.second,
+            src_defined,
+            src_rows,
+            src_to_destin);
+    }
+}
+
+template<class T, class Tuple>
+void inject_later (
+        std::vector<Batch<T, Tuple>> & batches,
+        std::vector<std::function<void()>> & jobs)
+{
+    for (auto & batch : batches) {
+        Batch<T, Tuple> * b = & batch;
+        jobs.push_back([b](){
+            inject_one(* b->destin, b->tuples, b->equations);
+            std::vector<Tuple>().swap(b->tuples);
+        });
+    }
+}
+
+template<class T, class Tuple>
+size_t merge_all (
+        Carrier & carrier,
+        const std::vector<Batch<T, Tuple>> & batches)
+{
+    size_t merge_count = 0;
+    for (const auto & batch : batches) {
+        for (const auto & equation : batch.equations) {
+            carrier.ensure_equal(
+                carrier.find(equation.first),
+                carrier.find(equation.second));
         }
+        merge_count += batch.equations.size();
     }
+    return merge_count;
 }
 
 } // namespace detail
 
-void aggregate (
+size_t aggregate (
         Structure & destin,
         Structure & src,
         const DenseSet & src_defined,
@@ -119,31 +304,78 @@ void aggregate (
             destin.carrier().item_count() + src.carrier().item_count(),
             destin.carrier().item_dim());
 
+    Carrier & carrier = destin.carrier();
     std::vector<Ob> src_to_destin(1 + src.carrier().item_dim(), 0);
-    destin.carrier().set_merge_callback(schedule_merge);
+    carrier.set_merge_callback(schedule_merge);
     for (auto iter = src.carrier().iter(); iter.ok(); iter.next()) {
-        src_to_destin[*iter] = destin.carrier().unsafe_insert();
+        src_to_destin[*iter] = carrier.unsafe_insert();
     }
 
-#define POMAGMA_INJECT_ALL(arity)\
-    detail::inject_all(\
+    // cheap tables are injected directly, merging in this thread
+    detail::inject_all(
+        destin.signature().nullary_functions(),
+        src.signature().nullary_functions(),
+        src_defined,
+        src_to_destin);
+    detail::inject_all(
+        destin.signature().injective_functions(),
+        src.signature().injective_functions(),
+        src_defined,
+        src_to_destin);
+
+    // merges from cheap tables are already known, so rows are translated
+    // onto reps, where they can conflict with existing destination values
+    for (auto iter = src.carrier().iter(); iter.ok(); iter.next()) {
+        src_to_destin[*iter] = carrier.find(src_to_destin[*iter]);
+    }
+
+    // expensive tables are translated in parallel over rows
+    POMAGMA_INFO("translating rows");
+    const std::vector<Ob> src_rows = detail::get_rows(src_defined);
+    std::vector<detail::Batch<BinaryRelation, detail::Pair>> rel_batches;
+    std::vector<detail::Batch<BinaryFunction, detail::Triple>> fun_batches;
+    std::vector<detail::Batch<SymmetricFunction, detail::Triple>> sym_batches;
+
+#define POMAGMA_TRANSLATE_ALL(batches, arity)\
+    detail::translate_all(\
+            batches,\
             destin.signature().arity(),\
             src.signature().arity(),\
             src_defined,\
+            src_rows,\
             src_to_destin)
 
-    // TODO parallelize, except for nullary relations
-    POMAGMA_INJECT_ALL(binary_relations);
-    POMAGMA_INJECT_ALL(nullary_functions);
-    POMAGMA_INJECT_ALL(injective_functions);
-    POMAGMA_INJECT_ALL(binary_functions);
-    POMAGMA_INJECT_ALL(symmetric_functions);
+    POMAGMA_TRANSLATE_ALL(rel_batches, binary_relations);
+    POMAGMA_TRANSLATE_ALL(fun_batches, binary_functions);
+    POMAGMA_TRANSLATE_ALL(sym_batches, symmetric_functions);
 
-#undef POMAGMA_INJECT_ALL
+#undef POMAGMA_TRANSLATE_ALL
 
     if (clear_src) { src.clear(); }
 
+    // then injected in parallel over tables, deferring merges
+    POMAGMA_INFO("injecting rows");
+    {
+        std::vector<std::function<void()>> jobs;
+        detail::inject_later(rel_batches, jobs);
+        detail::inject_later(fun_batches, jobs);
+        detail::inject_later(sym_batches, jobs);
+        const size_t job_count = jobs.size();
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < job_count; ++i) {
+            jobs[i]();
+        }
+    }
+
+    size_t merge_count = 0;
+    merge_count += detail::merge_all(carrier, fun_batches);
+    merge_count += detail::merge_all(carrier, sym_batches);
+    POMAGMA_INFO("deferred " << merge_count << " equations");
+
     process_mergers(destin.signature());
+
+    return merge_count;
 }
 
 } // namespace pomagma
@@ -7,7 +7,8 @@
 namespace pomagma
 {
 
-void aggregate (
+// returns the number of equations deferred from conflicting table values
+size_t aggregate (
         Structure & destin,
         Structure & src,
         const DenseSet & src_defined,
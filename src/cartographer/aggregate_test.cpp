@@ -0,0 +1,193 @@
+#include "aggregate.hpp"
+#include <pomagma/macrostructure/structure_impl.hpp>
+#include <pomagma/macrostructure/scheduler.hpp>
+
+using namespace pomagma;
+
+static const size_t DESTIN_ITEM_DIM = 127;
+static const size_t SRC_ITEM_DIM = 63;
+static const size_t ITEM_COUNT = 40;
+
+// builds a sparse random structure whose nullary functions X = 1, Y = 2 and
+// values APP X Y, JOIN X Y are shared by all seeds, so that aggregating one
+// seed into another conflicts with existing values
+void init_structure (Structure & structure, size_t item_dim, size_t seed)
+{
+    rng_t rng(seed);
+    std::uniform_int_distribution<Ob> random_ob(3, ITEM_COUNT);
+    std::bernoulli_distribution randomly_define(0.03);
+
+    structure.init_carrier(item_dim);
+    Signature & signature = structure.signature();
+    Carrier & carrier = structure.carrier();
+    for (size_t i = 0; i < ITEM_COUNT; ++i) {
+        carrier.unsafe_insert();
+    }
+
+    auto * LESS = new BinaryRelation(carrier);
+    auto * X = new NullaryFunction(carrier);
+    auto * Y = new NullaryFunction(carrier);
+    auto * QUOTE = new InjectiveFunction(carrier);
+    auto * APP = new BinaryFunction(carrier);
+    auto * JOIN = new SymmetricFunction(carrier);
+    signature.declare("LESS", * LESS);
+    signature.declare("X", * X);
+    signature.declare("Y", * Y);
+    signature.declare("QUOTE", * QUOTE);
+    signature.declare("APP", * APP);
+    signature.declare("JOIN", * JOIN);
+
+    X->insert(1);
+    Y->insert(2);
+    APP->insert(1, 2, random_ob(rng));
+    JOIN->insert(1, 2, random_ob(rng));
+    for (Ob key = 1 + seed % 3; key + 1 <= ITEM_COUNT; key += 3) {
+        QUOTE->insert(key, key + 1);
+    }
+    for (Ob lhs = 1; lhs <= ITEM_COUNT; ++lhs)
+    for (Ob rhs = 1; rhs <= ITEM_COUNT; ++rhs) {
+        if (randomly_define(rng)) {
+            LESS->insert(lhs, rhs);
+        }
+        if (not APP->find(lhs, rhs) and randomly_define(rng)) {
+            APP->insert(lhs, rhs, random_ob(rng));
+        }
+        if (lhs <= rhs and not JOIN->find(lhs, rhs) and randomly_define(rng)) {
+            JOIN->insert(lhs, rhs, random_ob(rng));
+        }
+    }
+}
+
+// the serial aggregation, inserting each value and merging in place
+void aggregate_serially (
+        Structure & destin,
+        Structure & src,
+        const DenseSet & src_defined)
+{
+    Carrier & carrier = destin.carrier();
+    std::vector<Ob> src_to_destin(1 + src.carrier().item_dim(), 0);
+    carrier.set_merge_callback(schedule_merge);
+    for (auto iter = src.carrier().iter(); iter.ok(); iter.next()) {
+        src_to_destin[*iter] = carrier.unsafe_insert();
+    }
+
+    auto & destin_less = destin.binary_relation("LESS");
+    auto & src_less = src.binary_relation("LESS");
+    for (auto lhs = src_defined.iter(); lhs.ok(); lhs.next())
+    for (auto rhs = src_defined.iter_insn(src_less.get_Lx_set(*lhs));
+        rhs.ok();
+        rhs.next())
+    {
+        destin_less.insert(src_to_destin[*lhs], src_to_destin[*rhs]);
+    }
+
+    for (const char * name : {"X", "Y"}) {
+        Ob val = src.nullary_function(name).find();
+        destin.nullary_function(name).insert(src_to_destin[val]);
+    }
+
+    auto & destin_quote = destin.injective_function("QUOTE");
+    auto & src_quote = src.injective_function("QUOTE");
+    for (auto iter = src_defined.iter_insn(src_quote.defined());
+        iter.ok();
+        iter.next())
+    {
+        destin_quote.insert(
+            src_to_destin[*iter],
+            src_to_destin[src_quote.find(*iter)]);
+    }
+
+    auto & destin_app = destin.binary_function("APP");
+    auto & src_app = src.binary_function("APP");
+    auto & destin_join = destin.symmetric_function("JOIN");
+    auto & src_join = src.symmetric_function("JOIN");
+    for (auto lhs = src_defined.iter(); lhs.ok(); lhs.next()) {
+        for (auto rhs = src_defined.iter_insn(src_app.get_Lx_set(*lhs));
+            rhs.ok();
+            rhs.next())
+        {
+            destin_app.insert(
+                src_to_destin[*lhs],
+                src_to_destin[*rhs],
+                src_to_destin[src_app.find(*lhs, *rhs)]);
+        }
+        for (auto rhs = src_defined.iter_insn(src_join.get_Lx_set(*lhs));
+            rhs.ok();
+            rhs.next())
+        {
+            destin_join.insert(
+                src_to_destin[*lhs],
+                src_to_destin[*rhs],
+                src_to_destin[src_join.find(*lhs, *rhs)]);
+        }
+    }
+
+    process_mergers(destin.signature());
+}
+
+void assert_equal (Structure & actual, Structure & expected)
+{
+    const DenseSet & support = expected.carrier().support();
+    POMAGMA_ASSERT(actual.carrier().support() == support,
+        "aggregated structures have different supports");
+    for (const char * name : {"X", "Y"}) {
+        POMAGMA_ASSERT_EQ(
+            actual.nullary_function(name).find(),
+            expected.nullary_function(name).find());
+    }
+    for (auto i = support.iter(); i.ok(); i.next()) {
+        POMAGMA_ASSERT_EQ(
+            actual.injective_function("QUOTE").raw_find(*i),
+            expected.injective_function("QUOTE").raw_find(*i));
+        for (auto j = support.iter(); j.ok(); j.next()) {
+            POMAGMA_ASSERT_EQ(
+                actual.binary_relation("LESS").find(*i, *j),
+                expected.binary_relation("LESS").find(*i, *j));
+            POMAGMA_ASSERT_EQ(
+                actual.binary_function("APP").raw_find(*i, *j),
+                expected.binary_function("APP").raw_find(*i, *j));
+            POMAGMA_ASSERT_EQ(
+                actual.symmetric_function("JOIN").raw_find(*i, *j),
+                expected.symmetric_function("JOIN").raw_find(*i, *j));
+        }
+    }
+}
+
+void test_aggregate (size_t destin_seed, size_t src_seed)
+{
+    POMAGMA_INFO("Testing aggregate of " << src_seed
+        << " into " << destin_seed);
+
+    Structure src;
+    init_structure(src, SRC_ITEM_DIM, src_seed);
+    DenseSet src_defined(SRC_ITEM_DIM);
+    src_defined = src.carrier().support();
+    src_defined.remove(ITEM_COUNT); // rows of undefined obs are dropped
+
+    Structure expected;
+    init_structure(expected, DESTIN_ITEM_DIM, destin_seed);
+    aggregate_serially(expected, src, src_defined);
+    expected.validate();
+
+    Structure actual;
+    init_structure(actual, DESTIN_ITEM_DIM, destin_seed);
+    size_t equation_count = aggregate(actual, src, src_defined, false);
+    actual.validate();
+
+    // at least APP X Y and JOIN X Y conflict
+    POMAGMA_ASSERT_LE(2, equation_count);
+    POMAGMA_ASSERT_LT(actual.carrier().item_count(), 2 * ITEM_COUNT - 2);
+    assert_equal(actual, expected);
+}
+
+int main ()
+{
+    Log::Context log_context("Cartographer Aggregate Test");
+
+    for (size_t destin_seed = 0; destin_seed < 3; ++destin_seed)
+    for (size_t src_seed = 3; src_seed < 6; ++src_seed) {
+        test_aggregate(destin_seed, src_seed);
+    }
+
+    return 0;
+}
@@ -132,12 +132,12 @@ std::map<std::string, size_t> Server::conjecture (
     crop();
 
     std::vector<float> probs;
-    std::vector<std::string> routes;
+    RouteDag routes;
     auto language = load_language(m_language_file);
     {
         Router router(m_structure.signature(), language);
         probs = router.measure_probs();
-        routes = router.find_routes();
+        routes = router.find_route_dag();
     }
 
     std::map<std::string, size_t> counts;
@@ -58,6 +58,43 @@ OBJECT_COUNT = 1e4
 LOGIC_COST = OBJECT_COUNT / 256.0
 LOG_OBJECT_COUNT = math.log(OBJECT_COUNT)
 
+# cleanup tasks costing at least this split their outermost loop into blocks
+MIN_SPLIT_COST = 1.5
+SPLIT_BLOCK_SIZE = 64
+MIN_SPLIT_OP_COUNT = OBJECT_COUNT ** MIN_SPLIT_COST
+MAX_SPLIT_BLOCK_COUNT = 512
+
+
+class CostModel(object):
+    '''
+    Cost model of strategies, tuned to table statistics if given, as loaded
+    by statistics.load, or else uniform.
+    '''
+    def __init__(self, statistics=None):
+        if statistics is None:
+            self.relations = {}
+            self.functions = {}
+            self.object_count = OBJECT_COUNT
+            self.min_split_cost = MIN_SPLIT_COST
+        else:
+            self.relations = statistics['relations']
+            self.functions = statistics['functions']
+            self.object_count = max(2.0, float(statistics['item_count']))
+            self.min_split_cost = (
+                math.log(MIN_SPLIT_OP_COUNT) / math.log(self.object_count))
+        self.logic_cost = self.object_count / 256.0
+        self.log_object_count = math.log(self.object_count)
+        self.split_block_size = SPLIT_BLOCK_SIZE
+        while (self.object_count / self.split_block_size >
+               MAX_SPLIT_BLOCK_COUNT):
+            self.split_block_size *= 2
+
+    def relation_density(self, name, default):
+        return self.relations.get(name, default)
+
+    def function_stat(self, name, key, default):
+        return self.functions.get(name, {}).get(key, default)
+
 
 def add_costs(*args):
     return (log_sum_exp(*[LOG_OBJECT_COUNT * a for a in args])
@@ -66,8 +103,11 @@ def add_costs(*args):
 
 class Strategy(object):
 
-    def cost(self):
-        return math.log(self.op_count()) / LOG_OBJECT_COUNT
+    # an order atom read from a row event's delta set, see compile_given_row
+    delta = None
+
+    def cost(self, model):
+        return math.log(self.op_count(model)) / model.log_object_count
 
 
 class Iter(Strategy):
@@ -107,12 +147,17 @@ class Iter(Strategy):
             bound.add(var)
         self.body.validate(bound)
 
-    def op_count(self):
+    def op_count(self, model):
         test_count = len(self.tests) + len(self.lets)
-        logic_cost = LOGIC_COST * test_count
-        object_count = OBJECT_COUNT * 0.5 ** test_count
+        logic_cost = model.logic_cost * test_count
+        object_count = model.object_count
+        for test in self.tests:
+            object_count *= model.relation_density(test.name, 0.5)
+        for expr in self.lets.itervalues():
+            object_count *= model.function_stat(expr.name, 'fill', 0.5)
         let_cost = len(self.lets)
-        return logic_cost + object_count * (let_cost + self.body.op_count())
+        body_cost = self.body.op_count(model)
+        return logic_cost + object_count * (let_cost + body_cost)
 
     def optimize(self):
         parent = self
@@ -158,8 +203,9 @@ class IterInvInjective(Strategy):
         assert_not_in(self.var, bound)
         self.body.validate(set_with(bound, self.var))
 
-    def op_count(self):
-        return 4.0 + 0.5 * self.body.op_count()  # amortized
+    def op_count(self, model):
+        fanout = model.function_stat(self.fun, 'fanout', 0.5)
+        return 4.0 + fanout * self.body.op_count(model)  # amortized
 
     def optimize(self):
         self.body.optimize()
@@ -184,8 +230,10 @@ class IterInvBinary(Strategy):
         assert_not_in(self.var2, bound)
         self.body.validate(set_with(bound, self.var1, self.var2))
 
-    def op_count(self):
-        return 4.0 + 0.25 * OBJECT_COUNT * self.body.op_count()  # amortized
+    def op_count(self, model):
+        default = 0.25 * model.object_count
+        fanout = model.function_stat(self.fun, 'fanout', default)
+        return 4.0 + fanout * self.body.op_count(model)  # amortized
 
     def optimize(self):
         self.body.optimize()
@@ -222,8 +270,9 @@ class IterInvBinaryRange(Strategy):
             assert_not_in(self.var1, bound)
             self.body.validate(set_with(bound, self.var1))
 
-    def op_count(self):
-        return 4.0 + 0.5 * self.body.op_count()  # amortized
+    def op_count(self, model):
+        fanout = model.function_stat(self.fun, 'range_fanout', 0.5)
+        return 4.0 + fanout * self.body.op_count(model)  # amortized
 
     def optimize(self):
         self.body.optimize()
@@ -246,8 +295,9 @@ class Let(Strategy):
         assert_not_in(self.var, bound)
         self.body.validate(set_with(bound, self.var))
 
-    def op_count(self):
-        return 1.0 + 0.5 * self.body.op_count()
+    def op_count(self, model):
+        fill = model.function_stat(self.expr.name, 'fill', 0.5)
+        return 1.0 + fill * self.body.op_count(model)
 
     def optimize(self):
         self.body.optimize()
@@ -268,8 +318,10 @@ class Test(Strategy):
         assert_subset(self.expr.vars, bound)
         self.body.validate(bound)
 
-    def op_count(self):
-        return 1.0 + self.body.op_count()
+    def op_count(self, model):
+        # tests are assumed to pass, unless statistics say otherwise
+        density = model.relation_density(self.expr.name, 1.0)
+        return 1.0 + density * self.body.op_count(model)
 
     def optimize(self):
         self.body.optimize()
@@ -287,7 +339,7 @@ class Ensure(Strategy):
     def validate(self, bound):
         assert_subset(self.expr.vars, bound)
 
-    def op_count(self):
+    def op_count(self, model):
         fun_count = 0
         if self.expr.name == 'EQUATION':
             for arg in self.expr.args:
@@ -304,7 +356,7 @@ class Ensure(Strategy):
 
 
 @inputs(Sequent)
-def compile_full(seq):
+def compile_full(seq, statistics=None):
     results = []
     if seq.optional:
         logger('skipped optional rule {0}'.format(seq))
@@ -312,7 +364,7 @@ def compile_full(seq):
     for part in normalize(seq):
         context = set()
         bound = set()
-        ranked = rank_compiled(part, context, bound)
+        ranked = rank_compiled(part, context, bound, statistics)
         results.append(min(ranked))
     assert results, 'failed to compile {0}'.format(seq)
     logger('derived {0} rules from {1}'.format(len(results), seq))
@@ -370,7 +422,7 @@ def normalize_given(seq, atom, bound):
 
 
 @inputs(Sequent, Expression)
-def compile_given(seq, atom):
+def compile_given(seq, atom, statistics=None):
     context = set([atom])
     bound = atom.vars
     if atom.is_fun():
@@ -378,16 +430,56 @@ def compile_given(seq, atom):
     results = []
     for normal in normalize_given(seq, atom, bound):
         # print 'DEBUG normal =', normal
-        ranked = rank_compiled(normal, context, bound)
+        ranked = rank_compiled(normal, context, bound, statistics)
         results.append(min(ranked))
     assert results, 'failed to compile {0} given {1}'.format(seq, atom)
     logger('derived {0} rules from {1} | {2}'.format(len(results), atom, seq))
     return results
 
 
+def mark_delta(strategy, atom):
+    '''
+    Mark the unique strategy node that consumes atom.
+    '''
+    marked = []
+    while strategy is not None:
+        if isinstance(strategy, Iter) and atom in strategy.tests:
+            marked.append(strategy)
+        elif isinstance(strategy, Test) and strategy.expr == atom:
+            marked.append(strategy)
+        strategy = getattr(strategy, 'body', None)
+    assert len(marked) == 1, 'failed to mark {0}'.format(atom)
+    marked[0].delta = atom
+
+
+@inputs(Sequent, Expression)
+def compile_given_row(seq, atom, statistics=None):
+    '''
+    Compile a batch of order events (lhs, rhs) with fixed lhs and rhs ranging
+    over a delta set. The atom stays an antecedent, so strategies either
+    iterate rhs over the delta or test membership in the delta.
+    '''
+    assert atom.name in ['LESS', 'NLESS'], atom
+    lhs, rhs = atom.args
+    assert lhs != rhs, atom
+    context = set()
+    bound = set([lhs])
+    results = []
+    for normal in normalize_given(seq, atom, bound):
+        ranked = rank_compiled(normal, context, bound, statistics)
+        cost, strategy = min(ranked)
+        mark_delta(strategy, atom)
+        results.append((cost, strategy))
+    assert results, 'failed to compile {0} given row {1}'.format(seq, atom)
+    logger('derived {0} rules from row {1} | {2}'.format(
+        len(results), atom, seq))
+    return results
+
+
 @inputs(Sequent)
-def rank_compiled(seq, context, bound):
+def rank_compiled(seq, context, bound, statistics=None):
     assert_normal(seq)
+    model = CostModel(statistics)
     antecedents = seq.antecedents - context
     (succedent,) = list(seq.succedents)
     compiled = get_compiled(antecedents, succedent, bound)
@@ -401,7 +493,7 @@ def rank_compiled(seq, context, bound):
         s.optimize()
         # print 'DEBUG', s
         s.validate(bound)
-        ranked.append((s.cost(), s))
+        ranked.append((s.cost(model), s))
     return ranked
 
 
@@ -6,6 +6,8 @@ from pomagma.compiler.compiler import (
     get_events,
     compile_full,
     compile_given,
+    compile_given_row,
+    CostModel,
 )
 
 EQUAL = lambda x, y: Expression('EQUAL', x, y)
@@ -52,6 +54,17 @@ def _test_sequent(*args):
                 incremental_cost = add_costs(incremental_cost, cost)
             else:
                 incremental_cost = cost
+        if event.name in ['LESS', 'NLESS'] and event.args[0] != event.args[1]:
+            print 'Compiling row search given: {0}'.format(event)
+            compiles = compile_given_row(sequent, event)
+            print_compiles(compiles)
+            for _, strategy in compiles:
+                deltas = []
+                while strategy is not None:
+                    if strategy.delta is not None:
+                        deltas.append(strategy.delta)
+                    strategy = getattr(strategy, 'body', None)
+                assert deltas == [event], deltas
 
     print '# full cost =', full_cost, 'incremental cost =', incremental_cost
 
@@ -205,3 +218,53 @@ def test_compile_ap_quote():
     _test_sequent(
         [],
         [EQUAL(APP(APP(AP, QUOTE(x)), QUOTE(y)), QUOTE(APP(x, y)))])
+
+
+def test_compile_with_statistics():
+    sequent = Sequent(
+        [EQUAL(APP(f, x), y), EQUAL(COMP(f, x), z)],
+        [LESS(y, z)])
+    sparse = {'fill': 0.01, 'fanout': 50.0}
+    dense = {'fill': 0.9, 'fanout': 2.0}
+    app_dense = {
+        'item_count': 1e5,
+        'relations': {'LESS': 0.01, 'NLESS': 0.9},
+        'functions': {'APP': dense, 'COMP': sparse},
+    }
+    comp_dense = {
+        'item_count': 1e5,
+        'relations': {'LESS': 0.01, 'NLESS': 0.9},
+        'functions': {'APP': sparse, 'COMP': dense},
+    }
+    uniform = compile_full(sequent)
+    by_app = compile_full(sequent, app_dense)
+    by_comp = compile_full(sequent, comp_dense)
+    print_compiles(by_app)
+    print_compiles(by_comp)
+    costs = lambda compiles: [cost for cost, _ in compiles]
+    plans = lambda compiles: [repr(strategy) for _, strategy in compiles]
+    assert costs(by_app) != costs(uniform), costs(by_app)
+
+    # uniformly, iterating over APP or COMP first ties; statistics decide
+    assert len(by_app) == len(by_comp)
+    assert plans(by_app) != plans(by_comp), 'statistics changed no plan'
+    for _, strategy in by_app:
+        assert repr(strategy).startswith('for APP_f_x: for APP f x'), strategy
+    for _, strategy in by_comp:
+        assert repr(strategy).startswith('for COMP_f_x: for COMP f'), strategy
+
+    # statistics are not remembered between compiles
+    assert costs(compile_full(sequent)) == costs(uniform)
+
+
+def test_cost_model():
+    uniform = CostModel()
+    assert uniform.split_block_size == 64, uniform.split_block_size
+    assert uniform.min_split_cost == 1.5, uniform.min_split_cost
+    tuned = CostModel({'item_count': 1e5, 'relations': {}, 'functions': {}})
+    assert tuned.split_block_size == 256, tuned.split_block_size
+    assert tuned.min_split_cost < 1.5, tuned.min_split_cost
+    # both split at the same op count
+    tuned_op_count = tuned.object_count ** tuned.min_split_cost
+    uniform_op_count = uniform.object_count ** uniform.min_split_cost
+    assert abs(tuned_op_count / uniform_op_count - 1) < 1e-9
@@ -58,10 +58,10 @@ class Code:
 
 
 @methodof(compiler.Iter, 'cpp')
-def Iter_cpp(self, code, poll=None):
+def Iter_cpp(self, code, split=0):
     body = Code()
-    if poll:
-        body(poll)
+    if split:
+        body('if (*iter >= (block + 1) * $split) { break; }', split=split)
     body(
         '''
         Ob $var = *iter;
@@ -79,22 +79,28 @@ def Iter_cpp(self, code, poll=None):
     self.body.cpp(body)
     sets = []
     iter_ = 'carrier.iter()'
+    iter_from = 'carrier.support().iter_from({})'
     for test in self.tests:
         assert test.name in ['LESS', 'NLESS'], test.name
         lhs, rhs = test.args
         assert lhs != rhs, lhs
-        if self.var == lhs:
+        if self.delta is not None and test == self.delta:
+            assert self.var == rhs, test
+            iter_ = 'delta.iter()'
+            sets.insert(0, 'delta')
+        elif self.var == lhs:
             iter_ = '%s.iter_rhs(%s)' % (test.name, rhs)
             sets.append('%s.get_Rx_set(%s)' % (test.name, rhs))
         else:
             iter_ = '%s.iter_lhs(%s)' % (test.name, lhs)
             sets.append('%s.get_Lx_set(%s)' % (test.name, lhs))
+        iter_from = sets[0] + '.iter_from({})'
     for expr in self.lets.itervalues():
         assert self.var in expr.args,\
             '{} not in {}'.format(self.var, expr.args)
         if len(expr.args) == 1:
             iter_ = '%s.iter()' % expr.name
-            sets.append('%s.get_set()' % expr.name)
+            sets.append('%s.defined()' % expr.name)
         else:
             lhs, rhs = expr.args
             assert lhs != rhs, lhs
@@ -104,8 +110,15 @@ def Iter_cpp(self, code, poll=None):
             else:
                 iter_ = '%s.iter_lhs(%s)' % (expr.name, lhs)
                 sets.append('%s.get_Lx_set(%s)' % (expr.name, lhs))
+        iter_from = sets[-1] + '.iter_from({})'
     if len(sets) > 1:
         iter_ = '{}.iter_insn({})'.format(sets[0], ', '.join(sets[1:]))
+        iter_from = '{}.iter_insn_from({{}}, {})'.format(
+            sets[0],
+            ', '.join(sets[1:]))
+    if split:
+        # iterate only over the block, rather than filtering the carrier
+        iter_ = iter_from.format('block * {}'.format(split))
     code(
         '''
         for (auto iter = $iter; iter.ok(); iter.next()) {
@@ -119,9 +132,9 @@ def Iter_cpp(self, code, poll=None):
 
 # TODO injective function inverse need not be iterated
 @methodof(compiler.IterInvInjective, 'cpp')
-def IterInvInjective_cpp(self, code, poll=None):
+def IterInvInjective_cpp(self, code, split=0):
     body = Code()
-    self.body.cpp(body, poll=poll)
+    self.body.cpp(body, split)
     code(
         '''
         if (Ob $var __attribute__((unused)) = $fun.inverse_find($value)) {
@@ -136,10 +149,10 @@ def IterInvInjective_cpp(self, code, poll=None):
 
 
 @methodof(compiler.IterInvBinary, 'cpp')
-def IterInvBinary_cpp(self, code, poll=None):
+def IterInvBinary_cpp(self, code, split=0):
     body = Code()
-    if poll:
-        body(poll)
+    if split:
+        body('if (iter.lhs() / $split != block) { continue; }', split=split)
     if self.var1 == self.var2:
         body(
             '''
@@ -170,10 +183,10 @@ def IterInvBinary_cpp(self, code, poll=None):
 
 
 @methodof(compiler.IterInvBinaryRange, 'cpp')
-def IterInvBinaryRange_cpp(self, code, poll=None):
+def IterInvBinaryRange_cpp(self, code, split=0):
     body = Code()
-    if poll:
-        body(poll)
+    if split:
+        body('if (*iter / $split != block) { continue; }', split=split)
     body(
         '''
         Ob $var __attribute__((unused)) = *iter;
@@ -203,9 +216,9 @@ def IterInvBinaryRange_cpp(self, code, poll=None):
 
 
 @methodof(compiler.Let, 'cpp')
-def Let_cpp(self, code, poll=None):
+def Let_cpp(self, code, split=0):
     body = Code()
-    self.body.cpp(body, poll=poll)
+    self.body.cpp(body, split)
     code(
         '''
         if (Ob $var = $fun.find($args)) {
@@ -220,11 +233,13 @@ def Let_cpp(self, code, poll=None):
 
 
 @methodof(compiler.Test, 'cpp')
-def Test_cpp(self, code, poll=None):
+def Test_cpp(self, code, split=0):
     body = Code()
-    self.body.cpp(body, poll=poll)
+    self.body.cpp(body, split)
     args = [arg.name for arg in self.expr.args]
-    if self.expr.name == 'EQUAL':
+    if self.delta is not None and self.expr == self.delta:
+        expr = 'delta.contains({1})'.format(*args)
+    elif self.expr.name == 'EQUAL':
         expr = 'carrier.equal({0}, {1})'.format(*args)
     elif self.expr.name in ['LESS', 'NLESS']:
         expr = '{0}.find({1}, {2})'.format(self.expr.name, *args)
@@ -243,7 +258,7 @@ def Test_cpp(self, code, poll=None):
 
 
 @methodof(compiler.Ensure, 'cpp')
-def Ensure_cpp(self, code, poll=None):
+def Ensure_cpp(self, code, split=0):
     expr = self.expr
     assert len(expr.args) == 2, expr.args
     args = [arg if arg.args else arg.var for arg in expr.args]
@@ -289,6 +304,215 @@ def Ensure_cpp(self, code, poll=None):
             )
 
 
+# ----------------------------------------------------------------------------
+# kernels, see src/surveyor/kernels.hpp
+
+MAX_KERNEL_SLOTS = 64  # see kernels::MAX_SLOTS
+
+
+class Slots:
+    '''
+    Variable slots of a kernel, remembering which are bound by the kernel
+    itself and which must be bound by the caller.
+    '''
+    def __init__(self):
+        self.names = []
+        self.bound = set()
+
+    def __call__(self, var, bind=False):
+        name = str(var)
+        if name not in self.names:
+            self.names.append(name)
+        if bind:
+            self.bound.add(name)
+        return name
+
+    def free(self):
+        return [name for name in self.names if name not in self.bound]
+
+
+def table_type(name):
+    arity = signature.get_arity(name)
+    return 'BinaryRelation' if arity == 'Equation' else arity
+
+
+def finder_kernel(expr, var, slots, bind=False):
+    args = [slots(arg) for arg in expr.args]
+    var = slots(var, bind)
+    if len(args) == 0:
+        return 'Find0<{}, {}>'.format(expr.name, var)
+    elif len(args) == 1:
+        return 'Find1<{}, {}, {}>'.format(expr.name, var, args[0])
+    else:
+        return 'Find2<{}, {}, {}, {}, {}>'.format(
+            table_type(expr.name), expr.name, var, args[0], args[1])
+
+
+def set_kernel(expr, var, slots):
+    if len(expr.args) == 1:
+        return 'Image<{}>'.format(expr.name)
+    lhs, rhs = expr.args
+    assert lhs != rhs, lhs
+    if var == lhs:
+        return 'LhsOf<{}, {}, {}>'.format(
+            table_type(expr.name), expr.name, slots(rhs))
+    else:
+        return 'RhsOf<{}, {}, {}>'.format(
+            table_type(expr.name), expr.name, slots(lhs))
+
+
+@methodof(compiler.Iter, 'kernel')
+def Iter_kernel(self, slots, block_size=0):
+    var = slots(self.var, bind=True)
+    sets = []
+    for test in self.tests:
+        assert test.name in ['LESS', 'NLESS'], test.name
+        if self.delta is not None and test == self.delta:
+            assert self.var == test.args[1], test
+            sets.insert(0, 'Delta')
+        else:
+            sets.append(set_kernel(test, self.var, slots))
+    lets = []
+    for let_var, expr in self.lets.iteritems():
+        assert self.var in expr.args,\
+            '{} not in {}'.format(self.var, expr.args)
+        sets.append(set_kernel(expr, self.var, slots))
+        lets.append(finder_kernel(expr, let_var, slots, bind=True))
+    if not sets:
+        set_ = 'Support<carrier>'
+    elif len(sets) == 1:
+        set_ = sets[0]
+    else:
+        set_ = 'Intersect<{}>'.format(', '.join(sets))
+    return 'Iter<{}, {}, Bind<{}>, {},\n{}>'.format(
+        var, set_, ', '.join(lets), block_size, self.body.kernel(slots))
+
+
+@methodof(compiler.IterInvInjective, 'kernel')
+def IterInvInjective_kernel(self, slots, block_size=0):
+    return 'IterInvInjective<{}, {}, {},\n{}>'.format(
+        self.fun,
+        slots(self.var, bind=True),
+        slots(self.value),
+        self.body.kernel(slots, block_size))
+
+
+@methodof(compiler.IterInvBinary, 'kernel')
+def IterInvBinary_kernel(self, slots, block_size=0):
+    return 'IterInvBinary<{}, {}, {}, {}, {}, {},\n{}>'.format(
+        table_type(self.fun),
+        self.fun,
+        slots(self.value),
+        slots(self.var1, bind=True),
+        slots(self.var2, bind=True),
+        block_size,
+        self.body.kernel(slots))
+
+
+@methodof(compiler.IterInvBinaryRange, 'kernel')
+def IterInvBinaryRange_kernel(self, slots, block_size=0):
+    if self.lhs_fixed:
+        fixed, var = self.var1, self.var2
+    else:
+        fixed, var = self.var2, self.var1
+    return 'IterInvBinaryRange<{}, {}, {}, {}, {}, {}, {},\n{}>'.format(
+        table_type(self.fun),
+        self.fun,
+        slots(self.value),
+        slots(fixed),
+        slots(var, bind=True),
+        'true' if self.lhs_fixed else 'false',
+        block_size,
+        self.body.kernel(slots))
+
+
+@methodof(compiler.Let, 'kernel')
+def Let_kernel(self, slots, block_size=0):
+    finder = finder_kernel(self.expr, self.var, slots, bind=True)
+    return 'Let<{},\n{}>'.format(finder, self.body.kernel(slots, block_size))
+
+
+@methodof(compiler.Test, 'kernel')
+def Test_kernel(self, slots, block_size=0):
+    body = self.body.kernel(slots, block_size)
+    args = [slots(arg) for arg in self.expr.args]
+    if self.delta is not None and self.expr == self.delta:
+        return 'TestDelta<{},\n{}>'.format(args[1], body)
+    elif self.expr.name == 'EQUAL':
+        return 'TestEqual<carrier, {}, {},\n{}>'.format(args[0], args[1], body)
+    elif self.expr.name in ['LESS', 'NLESS']:
+        return 'TestRel<{}, {}, {},\n{}>'.format(
+            self.expr.name, args[0], args[1], body)
+    else:
+        finder = finder_kernel(self.expr, self.expr.var, slots)
+        return 'TestFind<{},\n{}>'.format(finder, body)
+
+
+@methodof(compiler.Ensure, 'kernel')
+def Ensure_kernel(self, slots, block_size=0):
+    expr = self.expr
+    assert len(expr.args) == 2, expr.args
+    lhs, rhs = [arg if arg.args else arg.var for arg in expr.args]
+    if lhs.is_var() and rhs.is_var():
+        name = 'ensure_{}'.format(expr.name.lower())
+        args = [lhs, rhs]
+    else:
+        assert self.expr.name == 'EQUAL', self.expr.name
+        if lhs.is_var():
+            return 'Insert<{}>'.format(finder_kernel(rhs, lhs, slots))
+        elif rhs.is_var():
+            return 'Insert<{}>'.format(finder_kernel(lhs, rhs, slots))
+        if rhs.name < lhs.name:
+            lhs, rhs = rhs, lhs
+        name = 'ensure_{}_{}'.format(lhs.name.lower(), rhs.name.lower())
+        args = lhs.args + rhs.args
+    return 'Ensure<decltype({0}), {0}, {1}>'.format(
+        name, ', '.join(slots(arg) for arg in args))
+
+
+def write_kernel(code, strategy, block_size=0, delta=False):
+    '''
+    Write a strategy as a kernel run in an Env bound to the local variables
+    in scope, so that it can replace strategy.cpp(code, split).
+    '''
+    slots = Slots()
+    kernel = strategy.kernel(slots, block_size)
+    assert len(slots.names) <= MAX_KERNEL_SLOTS, slots.names
+    bindings = Code('Env env;')
+    for name in slots.free():
+        bindings('env.ob[Rule::$name] = $name;', name=name)
+    if delta:
+        bindings('env.delta = & delta;')
+    if block_size:
+        bindings('env.block = block;')
+    code(
+        '''
+        {
+            using namespace kernels;
+            struct Rule
+            {
+                enum { $slots };
+                typedef
+                    $kernel
+                    Kernel;
+            };
+            $bindings
+            Rule::Kernel::run(env);
+        }
+        ''',
+        slots=', '.join(slots.names),
+        kernel=wrapindent(kernel, '            '),
+        bindings=wrapindent(bindings),
+    )
+
+
+def write_strategy(code, strategy, block_size=0, kernels=False, delta=False):
+    if kernels:
+        write_kernel(code, strategy, block_size, delta)
+    else:
+        strategy.cpp(code, block_size)
+
+
 @inputs(Code)
 def write_signature(code, functions):
 
@@ -304,7 +528,7 @@ def write_signature(code, functions):
         for name in names:
             code(
                 '''
-                $Arity $NAME (carrier, schedule_$arity);
+                $Arity $NAME (carrier, schedule_$arity<${NAME}_TABLE>);
                 ''',
                 Arity=arity,
                 arity=camel_to_underscore(arity),
@@ -389,6 +613,9 @@ def write_merge_task(code, functions):
         '''
         for (auto & thread : threads) { thread.join(); }
         carrier.unsafe_remove(dep);
+
+        // merged entries move without events, so all cleanup blocks are dirty
+        count_change<CARRIER_TABLE>();
         '''
     )
 
@@ -455,24 +682,90 @@ def write_ensurers(code, functions):
             ).newline()
 
 
+def table_index(name):
+    return '{0}_TABLE'.format(name.upper())
+
+
+def write_tables(code, functions):
+    '''
+    Tables are indexed at compile time, so that theory.hpp can count
+    changes per table without looking tables up.
+    '''
+    names = ['carrier', 'LESS', 'NLESS']
+    for arity, arity_names in functions.iteritems():
+        names += arity_names
+    code(
+        '''
+        namespace pomagma
+        {
+
+        enum
+        {
+            $tables,
+            TABLE_COUNT
+        };
+
+        } // namespace pomagma
+        ''',
+        tables=',\n    '.join(table_index(name) for name in names),
+    ).newline()
+
+
+def get_tables_read(strategy):
+    '''
+    Names of the tables a strategy may read, besides the carrier. Compound
+    ensurers read both sides, so ensured expressions count as read.
+    '''
+    exprs = []
+    names = set()
+    while strategy is not None:
+        if isinstance(strategy, compiler.Iter):
+            exprs += strategy.tests
+            exprs += strategy.lets.values()
+        elif hasattr(strategy, 'fun'):
+            names.add(strategy.fun)
+        else:
+            exprs.append(strategy.expr)
+        strategy = getattr(strategy, 'body', None)
+    for expr in exprs:
+        for symbol in expr.polish.split():
+            if signature.is_fun(symbol) or symbol in ['LESS', 'NLESS']:
+                names.add(symbol)
+    return sorted(names)
+
+
 @inputs(Code)
-def write_full_tasks(code, sequents):
+def write_full_tasks(code, sequents, kernels=False, statistics=None):
 
     full_tasks = []
     for sequent in sequents:
-        full_tasks += compiler.compile_full(sequent)
+        full_tasks += compiler.compile_full(sequent, statistics)
     full_tasks.sort(key=(lambda (cost, _): cost))
     type_count = len(full_tasks)
 
-    block_size = 64
-    split = 'if (*iter / {} != block) {{ continue; }}'.format(block_size)
-    min_split_cost = 1.5  # above which we split the outermost for loop
+    model = compiler.CostModel(statistics)
+    block_size = model.split_block_size
+    min_split_cost = model.min_split_cost
     unsplit_count = sum(1 for cost, _ in full_tasks if cost < min_split_cost)
 
     cases = Code()
+    changed_cases = Code()
     for i, (cost, strategy) in enumerate(full_tasks):
+        tables = ['carrier'] + get_tables_read(strategy)
+        changed_cases(
+            '''
+            case $index: return g_change_clocks.changed({$tables});
+            ''',
+            index=i,
+            tables=', '.join(table_index(name) for name in tables),
+        )
         case = Code()
-        strategy.cpp(case, split if cost >= min_split_cost else None)
+        split = (cost >= min_split_cost)
+        write_strategy(
+            case,
+            strategy,
+            block_size=(block_size if split else 0),
+            kernels=kernels)
         cases(
             '''
             case $index: { // cost = $cost
@@ -492,57 +785,46 @@ def write_full_tasks(code, sequents):
         const size_t g_cleanup_type_count = $type_count;
         const size_t g_cleanup_block_count =
             carrier.item_dim() / $block_size + 1;
-        const size_t g_cleanup_task_count =
-            $unsplit_count +
-            ($type_count - $unsplit_count) * g_cleanup_block_count;
-        std::atomic<unsigned long> g_cleanup_type(0);
-        std::atomic<unsigned long> g_cleanup_remaining(0);
         CleanupProfiler g_cleanup_profiler(g_cleanup_type_count);
 
-        inline unsigned long next_cleanup_type (const unsigned long & type)
+        unsigned long cleanup_changed (unsigned long type)
         {
-            unsigned long next = type < $unsplit_count * g_cleanup_block_count
-                                      ? type + g_cleanup_block_count
-                                      : type + 1;
-            return next % (g_cleanup_type_count * g_cleanup_block_count);
+            switch (type) {
+
+                $changed_cases
+
+                default: POMAGMA_ERROR("bad cleanup type " << type);
+            }
         }
 
+        CleanupScheduler g_cleanup_scheduler(
+            g_cleanup_type_count,
+            $unsplit_count,
+            g_cleanup_block_count,
+            cleanup_changed);
+
         void cleanup_tasks_push_all()
         {
-            g_cleanup_remaining.store(g_cleanup_task_count);
+            g_cleanup_scheduler.push_all();
         }
 
         bool cleanup_tasks_try_pop (CleanupTask & task)
         {
-            unsigned long remaining = 1;
-            while (not g_cleanup_remaining.compare_exchange_weak(
-                remaining, remaining - 1))
-            {
-                if (remaining == 0) {
-                    return false;
-                }
-            }
-
-            // is this absolutely correct?
-
-            unsigned long type = 0;
-            while (not g_cleanup_type.compare_exchange_weak(
-                type, next_cleanup_type(type)))
-            {
-            }
-
-            task.type = type;
-            return true;
+            return g_cleanup_scheduler.try_pop(task);
         }
 
-        void execute (const CleanupTask & task)
+        inline void execute_cleanup (
+                const unsigned long type,
+                const unsigned long block)
         {
-            const unsigned long type = task.type / g_cleanup_block_count;
-            const unsigned long block = task.type % g_cleanup_block_count;
             POMAGMA_DEBUG(
                 "executing cleanup task"
                 " type " << (1 + type) << "/" << g_cleanup_type_count <<
                 " block " << (1 + block) << "/" << g_cleanup_block_count);
+            CleanupScheduler::Block scheduler_block(
+                g_cleanup_scheduler,
+                type,
+                block);
             CleanupProfiler::Block profiler_block(type);
 
             switch (type) {
@@ -551,6 +833,21 @@ def write_full_tasks(code, sequents):
 
                 default: POMAGMA_ERROR("bad cleanup type " << type);
             }
+            flush_ensurers();
+        }
+
+        void execute (const CleanupTask & task)
+        {
+            const unsigned long type = task.type;
+            const unsigned long changed = g_cleanup_scheduler.changed(type);
+            for (unsigned long block = task.block_begin;
+                block != task.block_end;
+                ++block)
+            {
+                if (not g_cleanup_scheduler.is_clean(type, block, changed)) {
+                    execute_cleanup(type, block);
+                }
+            }
         }
         ''',
         bar=bar,
@@ -558,11 +855,12 @@ def write_full_tasks(code, sequents):
         unsplit_count=unsplit_count,
         block_size=block_size,
         cases=wrapindent(cases, '        '),
+        changed_cases=wrapindent(changed_cases, '        '),
     ).newline()
 
 
 @inputs(Code)
-def write_event_tasks(code, sequents):
+def write_event_tasks(code, sequents, kernels=False, statistics=None):
 
     code(
         '''
@@ -573,15 +871,27 @@ def write_event_tasks(code, sequents):
     ).newline()
 
     event_tasks = {}
+    row_tasks = {}
     for sequent in sequents:
         for event in compiler.get_events(sequent):
             name = '<variable>' if event.is_var() else event.name
             tasks = event_tasks.setdefault(name, [])
-            strategies = compiler.compile_given(sequent, event)
+            strategies = compiler.compile_given(sequent, event, statistics)
             strategies.sort(key=lambda (cost, _): cost)
             costs = [cost for cost, _ in strategies]
             cost = log_sum_exp(*costs)
             tasks.append((event, cost, strategies))
+            if name in ['LESS', 'NLESS']:
+                if event.args[0] != event.args[1]:
+                    strategies = compiler.compile_given_row(
+                        sequent,
+                        event,
+                        statistics)
+                    strategies.sort(key=lambda (cost, _): cost)
+                    costs = [cost for cost, _ in strategies]
+                    cost = log_sum_exp(*costs)
+                tasks = row_tasks.setdefault(name, [])
+                tasks.append((event, cost, strategies))
 
     def get_group(name):
         special = {
@@ -650,7 +960,7 @@ def write_event_tasks(code, sequents):
                 subcost = 0
                 for cost, strategy in strategies:
                     subsubbody.newline()
-                    strategy.cpp(subsubbody)
+                    write_strategy(subsubbody, strategy, kernels=kernels)
                     subcost += cost
                 if diagonal:
                     subbody(
@@ -686,6 +996,7 @@ def write_event_tasks(code, sequents):
                     subbody=wrapindent(subbody),
                 ).newline()
 
+        body('flush_ensurers();')
         code(
             '''
             void execute (const ${groupname}Task & task)
@@ -697,6 +1008,8 @@ def write_event_tasks(code, sequents):
             body=wrapindent(body),
         ).newline()
 
+    write_row_event_tasks(code, row_tasks, kernels)
+
     nontrivial_arities = [groupname for groupname, _ in group_tasks]
     for arity in signature.FUNCTION_ARITIES:
         if arity not in nontrivial_arities:
@@ -708,6 +1021,68 @@ def write_event_tasks(code, sequents):
             ).newline()
 
 
+@inputs(Code)
+def write_row_event_tasks(code, row_tasks, kernels=False):
+    '''
+    Row tasks carry a fixed lhs and a delta set of rhs. Each event is
+    compiled once per row, iterating over or testing against the delta.
+    '''
+    for eventname, groupname in [
+            ('LESS', 'PositiveOrder'),
+            ('NLESS', 'NegativeOrder')]:
+        tasks = row_tasks.get(eventname, [])
+        tasks.sort(key=lambda (event, cost, _): (cost, str(event)))
+        if not tasks:
+            code(
+                '''
+                void execute (const ${groupname}RowTask &) {}
+                ''',
+                groupname=groupname,
+            ).newline()
+            continue
+
+        body = Code()
+        body(
+            '''
+            const Ob lhs = task.lhs;
+            const DenseSet & delta = * task.rhs;
+            ''')
+        for event, cost, strategies in tasks:
+            subbody = Code()
+            subbody(
+                '''
+                const Ob $local __attribute__((unused)) = lhs;
+                ''',
+                local=event.args[0],
+            )
+            for _, strategy in strategies:
+                subbody.newline()
+                write_strategy(subbody, strategy, kernels=kernels, delta=True)
+            diagonal = (event.args[0] == event.args[1])
+            body(
+                '''
+                $cond{ // cost = $cost
+                    $subbody
+                }
+                ''',
+                cond='if (delta.contains(lhs)) ' if diagonal else '',
+                cost=cost,
+                subbody=wrapindent(subbody),
+            )
+
+        body('flush_ensurers();')
+        code(
+            '''
+            void execute (const ${groupname}RowTask & task)
+            {
+                $body
+            }
+            ''',
+            groupname=groupname,
+            body=wrapindent(body),
+        ).newline()
+
+
 def get_functions_used_in(sequents, exprs):
     functions = dict((arity, []) for arity in signature.FUNCTION_ARITIES)
     symbols = set()
@@ -727,12 +1102,19 @@ def get_functions_used_in(sequents, exprs):
 
 
 @inputs(Code)
-def write_theory(code, rules=None, facts=None):
+def write_theory(
+        code,
+        rules=None,
+        facts=None,
+        kernels=False,
+        statistics=None):
 
     sequents = set(rules) if rules else set()
     facts = set(facts) if facts else set()
     functions = get_functions_used_in(sequents, facts)
 
+    write_tables(code, functions)
+
     code(
         '''
         #include "theory.hpp"
@@ -745,8 +1127,8 @@ def write_theory(code, rules=None, facts=None):
     write_signature(code, functions)
     write_merge_task(code, functions)
     write_ensurers(code, functions)
-    write_full_tasks(code, sequents)
-    write_event_tasks(code, sequents)
+    write_full_tasks(code, sequents, kernels, statistics)
+    write_event_tasks(code, sequents, kernels, statistics)
 
     code(
         '''
@@ -3,8 +3,12 @@ from pomagma.compiler import run
 from pomagma.compiler.util import find_facts, find_rules
 
 
-def _test_compile(filename):
-    run.compile(filename, cpp_out='temp.cpp', theory_out='temp.compiled')
+def _test_compile(filename, kernels='false'):
+    run.compile(
+        filename,
+        cpp_out='temp.cpp',
+        theory_out='temp.compiled',
+        kernels=kernels)
     os.remove('temp.cpp')
     os.remove('temp.compiled')
 
@@ -14,6 +18,11 @@ def test_compile_rules():
         yield _test_compile, filename
 
 
+def test_compile_rules_with_kernels():
+    for filename in find_rules():
+        yield _test_compile, filename, 'true'
+
+
 def test_compile_facts():
     for filename in find_facts():
         yield _test_compile, filename
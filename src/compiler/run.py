@@ -127,6 +127,8 @@ def compile(*infiles, **kwargs):
         theory_out=$POMAGMA_ROOT/src/theory/<STEM>.compiled
         theory_out=FILENAME
         extensional=true
+        statistics=STRUCTURE.h5 to tune rule plans to a dumped structure
+        kernels=false, or true to write rules as template kernels
     '''
     stem = infiles[-1].split('.')[0]
     cpp_out = kwargs.get(
@@ -137,6 +139,8 @@ def compile(*infiles, **kwargs):
         os.path.join(POMAGMA_SRC, 'theory', '{0}.compiled'.format(stem)))
     parse_bool = lambda s: {'true': True, 'false': False}[s.lower()]
     extensional = parse_bool(kwargs.get('extensional', 'true'))
+    statistics_in = kwargs.get('statistics')
+    kernels = parse_bool(kwargs.get('kernels', 'false'))
 
     print '# writing', cpp_out
     argstring = ' '.join(
@@ -157,6 +161,12 @@ def compile(*infiles, **kwargs):
         for rule in rules:
             facts += derive_facts(rule)
 
+    if statistics_in:
+        from pomagma.compiler.statistics import load as load_statistics
+        statistics = load_statistics(statistics_in)
+    else:
+        statistics = None
+
     code = cpp.Code()
     code('''
         // This file was auto generated by pomagma using:
@@ -165,7 +175,7 @@ def compile(*infiles, **kwargs):
          argstring=argstring,
          ).newline()
 
-    cpp.write_theory(code, rules, facts)
+    cpp.write_theory(code, rules, facts, kernels, statistics)
 
     with open(cpp_out, 'w') as f:
         f.write(str(code))
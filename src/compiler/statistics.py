@@ -0,0 +1,102 @@
+'''
+Table statistics of a dumped structure, for tuning compiled rule plans.
+
+The result of load() is a dict of the form:
+
+    {
+        'item_count': <number of obs>,
+        'relations': {<name>: <density>},
+        'functions': {
+            <name>: {
+                'fill': <fraction of defined args>,
+                'fanout': <mean number of args per value>,
+                'range_fanout': <mean number of args per value, one arg fixed>,
+            },
+        },
+    }
+
+See compiler.CostModel for how these enter the cost model.
+'''
+
+import pomagma.util
+
+
+def count_bits(words):
+    import numpy
+    bytes_ = numpy.ascontiguousarray(words).view(numpy.uint8)
+    return int(numpy.unpackbits(bytes_).sum())
+
+
+def count_distinct(*columns):
+    import numpy
+    if not len(columns[0]):
+        return 0
+    keys = numpy.zeros(len(columns[0]), dtype=numpy.uint64)
+    for column in columns:
+        keys <<= numpy.uint64(16)
+        keys |= column.astype(numpy.uint64)
+    return len(numpy.unique(keys))
+
+
+def load_relation(node, item_count):
+    return count_bits(node.read()) / float(item_count ** 2)
+
+
+def load_injective(group, item_count):
+    import numpy
+    value = group.value.read()
+    fanout = numpy.count_nonzero(value) / float(item_count)
+    return {'fill': fanout, 'fanout': fanout, 'range_fanout': 1.0}
+
+
+def load_binary(group, item_count, symmetric=False):
+    import numpy
+    lhs_ptr = group.lhs_ptr.read()
+    rhs = group.rhs.read()
+    value = group.value.read()
+    ptr = numpy.append(lhs_ptr, len(value)).astype(numpy.int64)
+    lhs = numpy.repeat(numpy.arange(len(lhs_ptr)), numpy.diff(ptr))
+    if symmetric:
+        # only lhs <= rhs is dumped
+        off = (lhs != rhs)
+        lhs, rhs = numpy.append(lhs, rhs[off]), numpy.append(rhs, lhs[off])
+        value = numpy.append(value, value[off])
+    pair_count = len(value)
+    if not pair_count:
+        return {'fill': 0.0, 'fanout': 0.0, 'range_fanout': 0.0}
+    lhs_fanout = pair_count / float(count_distinct(value, lhs))
+    rhs_fanout = pair_count / float(count_distinct(value, rhs))
+    return {
+        'fill': pair_count / float(item_count ** 2),
+        'fanout': pair_count / float(count_distinct(value)),
+        'range_fanout': 0.5 * (lhs_fanout + rhs_fanout),
+    }
+
+
+def load(filename):
+    '''
+    Load table statistics from a structure dumped to an .h5 file.
+    '''
+    statistics = {'relations': {}, 'functions': {}}
+    with pomagma.util.h5_open(filename) as structure:
+        item_dim, item_count = pomagma.util.count_obs(structure)
+        statistics['item_count'] = item_count
+        if '/relations/binary' in structure:
+            for node in structure.iterNodes('/relations/binary'):
+                statistics['relations'][node._v_name] = load_relation(
+                    node,
+                    item_count)
+        functions = statistics['functions']
+        if '/functions/injective' in structure:
+            for group in structure.iterNodes('/functions/injective'):
+                functions[group._v_name] = load_injective(group, item_count)
+        if '/functions/binary' in structure:
+            for group in structure.iterNodes('/functions/binary'):
+                functions[group._v_name] = load_binary(group, item_count)
+        if '/functions/symmetric' in structure:
+            for group in structure.iterNodes('/functions/symmetric'):
+                functions[group._v_name] = load_binary(
+                    group,
+                    item_count,
+                    symmetric=True)
+    return statistics
@@ -0,0 +1,115 @@
+from nose import SkipTest
+from nose.tools import assert_equal, assert_almost_equal
+from pomagma.compiler.statistics import (
+    count_bits,
+    count_distinct,
+    load_relation,
+    load_injective,
+    load_binary,
+)
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+
+def requires_numpy(fun):
+    def skipped():
+        raise SkipTest('numpy is not installed')
+    return skipped if numpy is None else fun
+
+
+class Node(object):
+    def __init__(self, data):
+        self.data = numpy.array(data)
+
+    def read(self):
+        return self.data
+
+
+class Group(object):
+    def __init__(self, **columns):
+        for name, data in columns.iteritems():
+            setattr(self, name, Node(data))
+
+
+def assert_stats_equal(actual, expected):
+    assert_equal(sorted(actual.keys()), sorted(expected.keys()))
+    for key, value in expected.iteritems():
+        assert_almost_equal(actual[key], value, msg=key)
+
+
+@requires_numpy
+def test_count_bits():
+    words = numpy.array([0, 0b1011, 1 << 63], dtype=numpy.uint64)
+    assert_equal(count_bits(words), 4)
+    assert_equal(count_bits(numpy.zeros(0, dtype=numpy.uint64)), 0)
+
+
+@requires_numpy
+def test_count_distinct():
+    empty = numpy.zeros(0, dtype=numpy.uint16)
+    assert_equal(count_distinct(empty), 0)
+    lhs = numpy.array([1, 1, 2, 2], dtype=numpy.uint16)
+    rhs = numpy.array([1, 2, 1, 1], dtype=numpy.uint16)
+    assert_equal(count_distinct(lhs), 2)
+    assert_equal(count_distinct(lhs, rhs), 3)
+    assert_equal(count_distinct(rhs, lhs), 3)
+
+
+@requires_numpy
+def test_load_relation():
+    words = numpy.array([0b1011, 1 << 63], dtype=numpy.uint64)
+    assert_almost_equal(load_relation(Node(words), 4), 4 / 16.0)
+
+
+@requires_numpy
+def test_load_injective():
+    group = Group(value=numpy.array([0, 2, 0, 1], dtype=numpy.uint16))
+    assert_stats_equal(load_injective(group, 3), {
+        'fill': 2 / 3.0,
+        'fanout': 2 / 3.0,
+        'range_fanout': 1.0,
+    })
+
+
+@requires_numpy
+def test_load_binary():
+    # APP 1 1 = 3, APP 1 2 = 3, APP 2 1 = 2
+    group = Group(
+        lhs_ptr=numpy.array([0, 0, 2, 3], dtype=numpy.uint32),
+        rhs=numpy.array([1, 2, 1], dtype=numpy.uint16),
+        value=numpy.array([3, 3, 2], dtype=numpy.uint16))
+    assert_stats_equal(load_binary(group, 3), {
+        'fill': 3 / 9.0,
+        'fanout': 3 / 2.0,
+        'range_fanout': 0.5 * (3 / 2.0 + 3 / 3.0),
+    })
+
+
+@requires_numpy
+def test_load_symmetric():
+    # JOIN 1 1 = 3, JOIN 1 2 = JOIN 2 1 = 2, dumped only for lhs <= rhs
+    group = Group(
+        lhs_ptr=numpy.array([0, 0, 2, 2], dtype=numpy.uint32),
+        rhs=numpy.array([1, 2], dtype=numpy.uint16),
+        value=numpy.array([3, 2], dtype=numpy.uint16))
+    assert_stats_equal(load_binary(group, 3, symmetric=True), {
+        'fill': 3 / 9.0,
+        'fanout': 3 / 2.0,
+        'range_fanout': 1.0,
+    })
+
+
+@requires_numpy
+def test_load_empty_binary():
+    group = Group(
+        lhs_ptr=numpy.zeros(4, dtype=numpy.uint32),
+        rhs=numpy.zeros(0, dtype=numpy.uint16),
+        value=numpy.zeros(0, dtype=numpy.uint16))
+    assert_stats_equal(load_binary(group, 3), {
+        'fill': 0.0,
+        'fanout': 0.0,
+        'range_fanout': 0.0,
+    })
@@ -0,0 +1,661 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: language.proto
+
+#include "language.pb.h"
+
+#include <algorithm>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/extension_set.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/reflection_ops.h>
+#include <google/protobuf/wire_format.h>
+// @@protoc_insertion_point(includes)
+#include <google/protobuf/port_def.inc>
+
+PROTOBUF_PRAGMA_INIT_SEG
+
+namespace _pb = ::PROTOBUF_NAMESPACE_ID;
+namespace _pbi = _pb::internal;
+
+namespace pomagma_messaging {
+PROTOBUF_CONSTEXPR WeightedTerm::WeightedTerm(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_._has_bits_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}
+  , /*decltype(_impl_.name_)*/{&::_pbi::fixed_address_empty_string, ::_pbi::ConstantInitialized{}}
+  , /*decltype(_impl_.weight_)*/0
+  , /*decltype(_impl_.arity_)*/1} {}
+struct WeightedTermDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR WeightedTermDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~WeightedTermDefaultTypeInternal() {}
+  union {
+    WeightedTerm _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 WeightedTermDefaultTypeInternal _WeightedTerm_default_instance_;
+PROTOBUF_CONSTEXPR Language::Language(
+    ::_pbi::ConstantInitialized): _impl_{
+    /*decltype(_impl_.terms_)*/{}
+  , /*decltype(_impl_._cached_size_)*/{}} {}
+struct LanguageDefaultTypeInternal {
+  PROTOBUF_CONSTEXPR LanguageDefaultTypeInternal()
+      : _instance(::_pbi::ConstantInitialized{}) {}
+  ~LanguageDefaultTypeInternal() {}
+  union {
+    Language _instance;
+  };
+};
+PROTOBUF_ATTRIBUTE_NO_DESTROY PROTOBUF_CONSTINIT PROTOBUF_ATTRIBUTE_INIT_PRIORITY1 LanguageDefaultTypeInternal _Language_default_instance_;
+}  // namespace pomagma_messaging
+static ::_pb::Metadata file_level_metadata_language_2eproto[2];
+static const ::_pb::EnumDescriptor* file_level_enum_descriptors_language_2eproto[1];
+static constexpr ::_pb::ServiceDescriptor const** file_level_service_descriptors_language_2eproto = nullptr;
+
+const uint32_t TableStruct_language_2eproto::offsets[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+  PROTOBUF_FIELD_OFFSET(::pomagma_messaging::WeightedTerm, _impl_._has_bits_),
+  PROTOBUF_FIELD_OFFSET(::pomagma_messaging::WeightedTerm, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::pomagma_messaging::WeightedTerm, _impl_.name_),
+  PROTOBUF_FIELD_OFFSET(::pomagma_messaging::WeightedTerm, _impl_.arity_),
+  PROTOBUF_FIELD_OFFSET(::pomagma_messaging::WeightedTerm, _impl_.weight_),
+  0,
+  2,
+  1,
+  ~0u,  // no _has_bits_
+  PROTOBUF_FIELD_OFFSET(::pomagma_messaging::Language, _internal_metadata_),
+  ~0u,  // no _extensions_
+  ~0u,  // no _oneof_case_
+  ~0u,  // no _weak_field_map_
+  ~0u,  // no _inlined_string_donated_
+  PROTOBUF_FIELD_OFFSET(::pomagma_messaging::Language, _impl_.terms_),
+};
+static const ::_pbi::MigrationSchema schemas[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) = {
+  { 0, 9, -1, sizeof(::pomagma_messaging::WeightedTerm)},
+  { 12, -1, -1, sizeof(::pomagma_messaging::Language)},
+};
+
+static const ::_pb::Message* const file_default_instances[] = {
+  &::pomagma_messaging::_WeightedTerm_default_instance_._instance,
+  &::pomagma_messaging::_Language_default_instance_._instance,
+};
+
+const char descriptor_table_protodef_language_2eproto[] PROTOBUF_SECTION_VARIABLE(protodesc_cold) =
+  "\n\016language.proto\022\021pomagma_messaging\"\242\001\n\014"
+  "WeightedTerm\022\014\n\004name\030\001 \002(\t\0224\n\005arity\030\002 \002("
+  "\0162%.pomagma_messaging.WeightedTerm.Arity"
+  "\022\016\n\006weight\030\003 \002(\002\">\n\005Arity\022\013\n\007NULLARY\020\001\022\r"
+  "\n\tINJECTIVE\020\002\022\n\n\006BINARY\020\003\022\r\n\tSYMMETRIC\020\004"
+  "\":\n\010Language\022.\n\005terms\030\001 \003(\0132\037.pomagma_me"
+  "ssaging.WeightedTerm"
+  ;
+static ::_pbi::once_flag descriptor_table_language_2eproto_once;
+const ::_pbi::DescriptorTable descriptor_table_language_2eproto = {
+    false, false, 260, descriptor_table_protodef_language_2eproto,
+    "language.proto",
+    &descriptor_table_language_2eproto_once, nullptr, 0, 2,
+    schemas, file_default_instances, TableStruct_language_2eproto::offsets,
+    file_level_metadata_language_2eproto, file_level_enum_descriptors_language_2eproto,
+    file_level_service_descriptors_language_2eproto,
+};
+PROTOBUF_ATTRIBUTE_WEAK const ::_pbi::DescriptorTable* descriptor_table_language_2eproto_getter() {
+  return &descriptor_table_language_2eproto;
+}
+
+// Force running AddDescriptors() at dynamic initialization time.
+PROTOBUF_ATTRIBUTE_INIT_PRIORITY2 static ::_pbi::AddDescriptorsRunner dynamic_init_dummy_language_2eproto(&descriptor_table_language_2eproto);
+namespace pomagma_messaging {
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* WeightedTerm_Arity_descriptor() {
+  ::PROTOBUF_NAMESPACE_ID::internal::AssignDescriptors(&descriptor_table_language_2eproto);
+  return file_level_enum_descriptors_language_2eproto[0];
+}
+bool WeightedTerm_Arity_IsValid(int value) {
+  switch (value) {
+    case 1:
+    case 2:
+    case 3:
+    case 4:
+      return true;
+    default:
+      return false;
+  }
+}
+
+#if (__cplusplus < 201703) && (!defined(_MSC_VER) || (_MSC_VER >= 1900 && _MSC_VER < 1912))
+constexpr WeightedTerm_Arity WeightedTerm::NULLARY;
+constexpr WeightedTerm_Arity WeightedTerm::INJECTIVE;
+constexpr WeightedTerm_Arity WeightedTerm::BINARY;
+constexpr WeightedTerm_Arity WeightedTerm::SYMMETRIC;
+constexpr WeightedTerm_Arity WeightedTerm::Arity_MIN;
+constexpr WeightedTerm_Arity WeightedTerm::Arity_MAX;
+constexpr int WeightedTerm::Arity_ARRAYSIZE;
+#endif  // (__cplusplus < 201703) && (!defined(_MSC_VER) || (_MSC_VER >= 1900 && _MSC_VER < 1912))
+
+// ===================================================================
+
+class WeightedTerm::_Internal {
+ public:
+  using HasBits = decltype(std::declval<WeightedTerm>()._impl_._has_bits_);
+  static void set_has_name(HasBits* has_bits) {
+    (*has_bits)[0] |= 1u;
+  }
+  static void set_has_arity(HasBits* has_bits) {
+    (*has_bits)[0] |= 4u;
+  }
+  static void set_has_weight(HasBits* has_bits) {
+    (*has_bits)[0] |= 2u;
+  }
+  static bool MissingRequiredFields(const HasBits& has_bits) {
+    return ((has_bits[0] & 0x00000007) ^ 0x00000007) != 0;
+  }
+};
+
+WeightedTerm::WeightedTerm(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:pomagma_messaging.WeightedTerm)
+}
+WeightedTerm::WeightedTerm(const WeightedTerm& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  WeightedTerm* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){from._impl_._has_bits_}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.name_){}
+    , decltype(_impl_.weight_){}
+    , decltype(_impl_.arity_){}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  _impl_.name_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.name_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (from._internal_has_name()) {
+    _this->_impl_.name_.Set(from._internal_name(), 
+      _this->GetArenaForAllocation());
+  }
+  ::memcpy(&_impl_.weight_, &from._impl_.weight_,
+    static_cast<size_t>(reinterpret_cast<char*>(&_impl_.arity_) -
+    reinterpret_cast<char*>(&_impl_.weight_)) + sizeof(_impl_.arity_));
+  // @@protoc_insertion_point(copy_constructor:pomagma_messaging.WeightedTerm)
+}
+
+inline void WeightedTerm::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_._has_bits_){}
+    , /*decltype(_impl_._cached_size_)*/{}
+    , decltype(_impl_.name_){}
+    , decltype(_impl_.weight_){0}
+    , decltype(_impl_.arity_){1}
+  };
+  _impl_.name_.InitDefault();
+  #ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+    _impl_.name_.Set("", GetArenaForAllocation());
+  #endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+}
+
+WeightedTerm::~WeightedTerm() {
+  // @@protoc_insertion_point(destructor:pomagma_messaging.WeightedTerm)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void WeightedTerm::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.name_.Destroy();
+}
+
+void WeightedTerm::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void WeightedTerm::Clear() {
+// @@protoc_insertion_point(message_clear_start:pomagma_messaging.WeightedTerm)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000001u) {
+    _impl_.name_.ClearNonDefaultToEmpty();
+  }
+  if (cached_has_bits & 0x00000006u) {
+    _impl_.weight_ = 0;
+    _impl_.arity_ = 1;
+  }
+  _impl_._has_bits_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* WeightedTerm::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  _Internal::HasBits has_bits{};
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // required string name = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          auto str = _internal_mutable_name();
+          ptr = ::_pbi::InlineGreedyStringParser(str, ptr, ctx);
+          CHK_(ptr);
+          #ifndef NDEBUG
+          ::_pbi::VerifyUTF8(str, "pomagma_messaging.WeightedTerm.name");
+          #endif  // !NDEBUG
+        } else
+          goto handle_unusual;
+        continue;
+      // required .pomagma_messaging.WeightedTerm.Arity arity = 2;
+      case 2:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 16)) {
+          uint64_t val = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint64(&ptr);
+          CHK_(ptr);
+          if (PROTOBUF_PREDICT_TRUE(::pomagma_messaging::WeightedTerm_Arity_IsValid(val))) {
+            _internal_set_arity(static_cast<::pomagma_messaging::WeightedTerm_Arity>(val));
+          } else {
+            ::PROTOBUF_NAMESPACE_ID::internal::WriteVarint(2, val, mutable_unknown_fields());
+          }
+        } else
+          goto handle_unusual;
+        continue;
+      // required float weight = 3;
+      case 3:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 29)) {
+          _Internal::set_has_weight(&has_bits);
+          _impl_.weight_ = ::PROTOBUF_NAMESPACE_ID::internal::UnalignedLoad<float>(ptr);
+          ptr += sizeof(float);
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  _impl_._has_bits_.Or(has_bits);
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* WeightedTerm::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:pomagma_messaging.WeightedTerm)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = _impl_._has_bits_[0];
+  // required string name = 1;
+  if (cached_has_bits & 0x00000001u) {
+    ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::VerifyUTF8StringNamedField(
+      this->_internal_name().data(), static_cast<int>(this->_internal_name().length()),
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormat::SERIALIZE,
+      "pomagma_messaging.WeightedTerm.name");
+    target = stream->WriteStringMaybeAliased(
+        1, this->_internal_name(), target);
+  }
+
+  // required .pomagma_messaging.WeightedTerm.Arity arity = 2;
+  if (cached_has_bits & 0x00000004u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteEnumToArray(
+      2, this->_internal_arity(), target);
+  }
+
+  // required float weight = 3;
+  if (cached_has_bits & 0x00000002u) {
+    target = stream->EnsureSpace(target);
+    target = ::_pbi::WireFormatLite::WriteFloatToArray(3, this->_internal_weight(), target);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:pomagma_messaging.WeightedTerm)
+  return target;
+}
+
+size_t WeightedTerm::RequiredFieldsByteSizeFallback() const {
+// @@protoc_insertion_point(required_fields_byte_size_fallback_start:pomagma_messaging.WeightedTerm)
+  size_t total_size = 0;
+
+  if (_internal_has_name()) {
+    // required string name = 1;
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+        this->_internal_name());
+  }
+
+  if (_internal_has_weight()) {
+    // required float weight = 3;
+    total_size += 1 + 4;
+  }
+
+  if (_internal_has_arity()) {
+    // required .pomagma_messaging.WeightedTerm.Arity arity = 2;
+    total_size += 1 +
+      ::_pbi::WireFormatLite::EnumSize(this->_internal_arity());
+  }
+
+  return total_size;
+}
+size_t WeightedTerm::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:pomagma_messaging.WeightedTerm)
+  size_t total_size = 0;
+
+  if (((_impl_._has_bits_[0] & 0x00000007) ^ 0x00000007) == 0) {  // All required fields are present.
+    // required string name = 1;
+    total_size += 1 +
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::StringSize(
+        this->_internal_name());
+
+    // required float weight = 3;
+    total_size += 1 + 4;
+
+    // required .pomagma_messaging.WeightedTerm.Arity arity = 2;
+    total_size += 1 +
+      ::_pbi::WireFormatLite::EnumSize(this->_internal_arity());
+
+  } else {
+    total_size += RequiredFieldsByteSizeFallback();
+  }
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData WeightedTerm::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    WeightedTerm::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*WeightedTerm::GetClassData() const { return &_class_data_; }
+
+
+void WeightedTerm::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<WeightedTerm*>(&to_msg);
+  auto& from = static_cast<const WeightedTerm&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:pomagma_messaging.WeightedTerm)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  cached_has_bits = from._impl_._has_bits_[0];
+  if (cached_has_bits & 0x00000007u) {
+    if (cached_has_bits & 0x00000001u) {
+      _this->_internal_set_name(from._internal_name());
+    }
+    if (cached_has_bits & 0x00000002u) {
+      _this->_impl_.weight_ = from._impl_.weight_;
+    }
+    if (cached_has_bits & 0x00000004u) {
+      _this->_impl_.arity_ = from._impl_.arity_;
+    }
+    _this->_impl_._has_bits_[0] |= cached_has_bits;
+  }
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void WeightedTerm::CopyFrom(const WeightedTerm& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:pomagma_messaging.WeightedTerm)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool WeightedTerm::IsInitialized() const {
+  if (_Internal::MissingRequiredFields(_impl_._has_bits_)) return false;
+  return true;
+}
+
+void WeightedTerm::InternalSwap(WeightedTerm* other) {
+  using std::swap;
+  auto* lhs_arena = GetArenaForAllocation();
+  auto* rhs_arena = other->GetArenaForAllocation();
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  swap(_impl_._has_bits_[0], other->_impl_._has_bits_[0]);
+  ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr::InternalSwap(
+      &_impl_.name_, lhs_arena,
+      &other->_impl_.name_, rhs_arena
+  );
+  swap(_impl_.weight_, other->_impl_.weight_);
+  swap(_impl_.arity_, other->_impl_.arity_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata WeightedTerm::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_language_2eproto_getter, &descriptor_table_language_2eproto_once,
+      file_level_metadata_language_2eproto[0]);
+}
+
+// ===================================================================
+
+class Language::_Internal {
+ public:
+};
+
+Language::Language(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                         bool is_message_owned)
+  : ::PROTOBUF_NAMESPACE_ID::Message(arena, is_message_owned) {
+  SharedCtor(arena, is_message_owned);
+  // @@protoc_insertion_point(arena_constructor:pomagma_messaging.Language)
+}
+Language::Language(const Language& from)
+  : ::PROTOBUF_NAMESPACE_ID::Message() {
+  Language* const _this = this; (void)_this;
+  new (&_impl_) Impl_{
+      decltype(_impl_.terms_){from._impl_.terms_}
+    , /*decltype(_impl_._cached_size_)*/{}};
+
+  _internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+  // @@protoc_insertion_point(copy_constructor:pomagma_messaging.Language)
+}
+
+inline void Language::SharedCtor(
+    ::_pb::Arena* arena, bool is_message_owned) {
+  (void)arena;
+  (void)is_message_owned;
+  new (&_impl_) Impl_{
+      decltype(_impl_.terms_){arena}
+    , /*decltype(_impl_._cached_size_)*/{}
+  };
+}
+
+Language::~Language() {
+  // @@protoc_insertion_point(destructor:pomagma_messaging.Language)
+  if (auto *arena = _internal_metadata_.DeleteReturnArena<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>()) {
+  (void)arena;
+    return;
+  }
+  SharedDtor();
+}
+
+inline void Language::SharedDtor() {
+  GOOGLE_DCHECK(GetArenaForAllocation() == nullptr);
+  _impl_.terms_.~RepeatedPtrField();
+}
+
+void Language::SetCachedSize(int size) const {
+  _impl_._cached_size_.Set(size);
+}
+
+void Language::Clear() {
+// @@protoc_insertion_point(message_clear_start:pomagma_messaging.Language)
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  _impl_.terms_.Clear();
+  _internal_metadata_.Clear<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+}
+
+const char* Language::_InternalParse(const char* ptr, ::_pbi::ParseContext* ctx) {
+#define CHK_(x) if (PROTOBUF_PREDICT_FALSE(!(x))) goto failure
+  while (!ctx->Done(&ptr)) {
+    uint32_t tag;
+    ptr = ::_pbi::ReadTag(ptr, &tag);
+    switch (tag >> 3) {
+      // repeated .pomagma_messaging.WeightedTerm terms = 1;
+      case 1:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 10)) {
+          ptr -= 1;
+          do {
+            ptr += 1;
+            ptr = ctx->ParseMessage(_internal_add_terms(), ptr);
+            CHK_(ptr);
+            if (!ctx->DataAvailable(ptr)) break;
+          } while (::PROTOBUF_NAMESPACE_ID::internal::ExpectTag<10>(ptr));
+        } else
+          goto handle_unusual;
+        continue;
+      default:
+        goto handle_unusual;
+    }  // switch
+  handle_unusual:
+    if ((tag == 0) || ((tag & 7) == 4)) {
+      CHK_(ptr);
+      ctx->SetLastTag(tag);
+      goto message_done;
+    }
+    ptr = UnknownFieldParse(
+        tag,
+        _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(),
+        ptr, ctx);
+    CHK_(ptr != nullptr);
+  }  // while
+message_done:
+  return ptr;
+failure:
+  ptr = nullptr;
+  goto message_done;
+#undef CHK_
+}
+
+uint8_t* Language::_InternalSerialize(
+    uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const {
+  // @@protoc_insertion_point(serialize_to_array_start:pomagma_messaging.Language)
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  // repeated .pomagma_messaging.WeightedTerm terms = 1;
+  for (unsigned i = 0,
+      n = static_cast<unsigned>(this->_internal_terms_size()); i < n; i++) {
+    const auto& repfield = this->_internal_terms(i);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::
+        InternalWriteMessage(1, repfield, repfield.GetCachedSize(), target, stream);
+  }
+
+  if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
+    target = ::_pbi::WireFormat::InternalSerializeUnknownFieldsToArray(
+        _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance), target, stream);
+  }
+  // @@protoc_insertion_point(serialize_to_array_end:pomagma_messaging.Language)
+  return target;
+}
+
+size_t Language::ByteSizeLong() const {
+// @@protoc_insertion_point(message_byte_size_start:pomagma_messaging.Language)
+  size_t total_size = 0;
+
+  uint32_t cached_has_bits = 0;
+  // Prevent compiler warnings about cached_has_bits being unused
+  (void) cached_has_bits;
+
+  // repeated .pomagma_messaging.WeightedTerm terms = 1;
+  total_size += 1UL * this->_internal_terms_size();
+  for (const auto& msg : this->_impl_.terms_) {
+    total_size +=
+      ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::MessageSize(msg);
+  }
+
+  return MaybeComputeUnknownFieldsSize(total_size, &_impl_._cached_size_);
+}
+
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData Language::_class_data_ = {
+    ::PROTOBUF_NAMESPACE_ID::Message::CopyWithSourceCheck,
+    Language::MergeImpl
+};
+const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*Language::GetClassData() const { return &_class_data_; }
+
+
+void Language::MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg) {
+  auto* const _this = static_cast<Language*>(&to_msg);
+  auto& from = static_cast<const Language&>(from_msg);
+  // @@protoc_insertion_point(class_specific_merge_from_start:pomagma_messaging.Language)
+  GOOGLE_DCHECK_NE(&from, _this);
+  uint32_t cached_has_bits = 0;
+  (void) cached_has_bits;
+
+  _this->_impl_.terms_.MergeFrom(from._impl_.terms_);
+  _this->_internal_metadata_.MergeFrom<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(from._internal_metadata_);
+}
+
+void Language::CopyFrom(const Language& from) {
+// @@protoc_insertion_point(class_specific_copy_from_start:pomagma_messaging.Language)
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool Language::IsInitialized() const {
+  if (!::PROTOBUF_NAMESPACE_ID::internal::AllAreInitialized(_impl_.terms_))
+    return false;
+  return true;
+}
+
+void Language::InternalSwap(Language* other) {
+  using std::swap;
+  _internal_metadata_.InternalSwap(&other->_internal_metadata_);
+  _impl_.terms_.InternalSwap(&other->_impl_.terms_);
+}
+
+::PROTOBUF_NAMESPACE_ID::Metadata Language::GetMetadata() const {
+  return ::_pbi::AssignDescriptors(
+      &descriptor_table_language_2eproto_getter, &descriptor_table_language_2eproto_once,
+      file_level_metadata_language_2eproto[1]);
+}
+
+// @@protoc_insertion_point(namespace_scope)
+}  // namespace pomagma_messaging
+PROTOBUF_NAMESPACE_OPEN
+template<> PROTOBUF_NOINLINE ::pomagma_messaging::WeightedTerm*
+Arena::CreateMaybeMessage< ::pomagma_messaging::WeightedTerm >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::pomagma_messaging::WeightedTerm >(arena);
+}
+template<> PROTOBUF_NOINLINE ::pomagma_messaging::Language*
+Arena::CreateMaybeMessage< ::pomagma_messaging::Language >(Arena* arena) {
+  return Arena::CreateMessageInternal< ::pomagma_messaging::Language >(arena);
+}
+PROTOBUF_NAMESPACE_CLOSE
+
+// @@protoc_insertion_point(global_scope)
+#include <google/protobuf/port_undef.inc>
@@ -0,0 +1,686 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: language.proto
+
+#ifndef GOOGLE_PROTOBUF_INCLUDED_language_2eproto
+#define GOOGLE_PROTOBUF_INCLUDED_language_2eproto
+
+#include <limits>
+#include <string>
+
+#include <google/protobuf/port_def.inc>
+#if PROTOBUF_VERSION < 3021000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please update
+#error your headers.
+#endif
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/port_undef.inc>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/arenastring.h>
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/metadata_lite.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/repeated_field.h>  // IWYU pragma: export
+#include <google/protobuf/extension_set.h>  // IWYU pragma: export
+#include <google/protobuf/generated_enum_reflection.h>
+#include <google/protobuf/unknown_field_set.h>
+// @@protoc_insertion_point(includes)
+#include <google/protobuf/port_def.inc>
+#define PROTOBUF_INTERNAL_EXPORT_language_2eproto
+PROTOBUF_NAMESPACE_OPEN
+namespace internal {
+class AnyMetadata;
+}  // namespace internal
+PROTOBUF_NAMESPACE_CLOSE
+
+// Internal implementation detail -- do not use these members.
+struct TableStruct_language_2eproto {
+  static const uint32_t offsets[];
+};
+extern const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_language_2eproto;
+namespace pomagma_messaging {
+class Language;
+struct LanguageDefaultTypeInternal;
+extern LanguageDefaultTypeInternal _Language_default_instance_;
+class WeightedTerm;
+struct WeightedTermDefaultTypeInternal;
+extern WeightedTermDefaultTypeInternal _WeightedTerm_default_instance_;
+}  // namespace pomagma_messaging
+PROTOBUF_NAMESPACE_OPEN
+template<> ::pomagma_messaging::Language* Arena::CreateMaybeMessage<::pomagma_messaging::Language>(Arena*);
+template<> ::pomagma_messaging::WeightedTerm* Arena::CreateMaybeMessage<::pomagma_messaging::WeightedTerm>(Arena*);
+PROTOBUF_NAMESPACE_CLOSE
+namespace pomagma_messaging {
+
+enum WeightedTerm_Arity : int {
+  WeightedTerm_Arity_NULLARY = 1,
+  WeightedTerm_Arity_INJECTIVE = 2,
+  WeightedTerm_Arity_BINARY = 3,
+  WeightedTerm_Arity_SYMMETRIC = 4
+};
+bool WeightedTerm_Arity_IsValid(int value);
+constexpr WeightedTerm_Arity WeightedTerm_Arity_Arity_MIN = WeightedTerm_Arity_NULLARY;
+constexpr WeightedTerm_Arity WeightedTerm_Arity_Arity_MAX = WeightedTerm_Arity_SYMMETRIC;
+constexpr int WeightedTerm_Arity_Arity_ARRAYSIZE = WeightedTerm_Arity_Arity_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* WeightedTerm_Arity_descriptor();
+template<typename T>
+inline const std::string& WeightedTerm_Arity_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, WeightedTerm_Arity>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function WeightedTerm_Arity_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    WeightedTerm_Arity_descriptor(), enum_t_value);
+}
+inline bool WeightedTerm_Arity_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, WeightedTerm_Arity* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<WeightedTerm_Arity>(
+    WeightedTerm_Arity_descriptor(), name, value);
+}
+// ===================================================================
+
+class WeightedTerm final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:pomagma_messaging.WeightedTerm) */ {
+ public:
+  inline WeightedTerm() : WeightedTerm(nullptr) {}
+  ~WeightedTerm() override;
+  explicit PROTOBUF_CONSTEXPR WeightedTerm(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  WeightedTerm(const WeightedTerm& from);
+  WeightedTerm(WeightedTerm&& from) noexcept
+    : WeightedTerm() {
+    *this = ::std::move(from);
+  }
+
+  inline WeightedTerm& operator=(const WeightedTerm& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline WeightedTerm& operator=(WeightedTerm&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const WeightedTerm& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const WeightedTerm* internal_default_instance() {
+    return reinterpret_cast<const WeightedTerm*>(
+               &_WeightedTerm_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    0;
+
+  friend void swap(WeightedTerm& a, WeightedTerm& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(WeightedTerm* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(WeightedTerm* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  WeightedTerm* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<WeightedTerm>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const WeightedTerm& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const WeightedTerm& from) {
+    WeightedTerm::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(WeightedTerm* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "pomagma_messaging.WeightedTerm";
+  }
+  protected:
+  explicit WeightedTerm(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  typedef WeightedTerm_Arity Arity;
+  static constexpr Arity NULLARY =
+    WeightedTerm_Arity_NULLARY;
+  static constexpr Arity INJECTIVE =
+    WeightedTerm_Arity_INJECTIVE;
+  static constexpr Arity BINARY =
+    WeightedTerm_Arity_BINARY;
+  static constexpr Arity SYMMETRIC =
+    WeightedTerm_Arity_SYMMETRIC;
+  static inline bool Arity_IsValid(int value) {
+    return WeightedTerm_Arity_IsValid(value);
+  }
+  static constexpr Arity Arity_MIN =
+    WeightedTerm_Arity_Arity_MIN;
+  static constexpr Arity Arity_MAX =
+    WeightedTerm_Arity_Arity_MAX;
+  static constexpr int Arity_ARRAYSIZE =
+    WeightedTerm_Arity_Arity_ARRAYSIZE;
+  static inline const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor*
+  Arity_descriptor() {
+    return WeightedTerm_Arity_descriptor();
+  }
+  template<typename T>
+  static inline const std::string& Arity_Name(T enum_t_value) {
+    static_assert(::std::is_same<T, Arity>::value ||
+      ::std::is_integral<T>::value,
+      "Incorrect type passed to function Arity_Name.");
+    return WeightedTerm_Arity_Name(enum_t_value);
+  }
+  static inline bool Arity_Parse(::PROTOBUF_NAMESPACE_ID::ConstStringParam name,
+      Arity* value) {
+    return WeightedTerm_Arity_Parse(name, value);
+  }
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kNameFieldNumber = 1,
+    kWeightFieldNumber = 3,
+    kArityFieldNumber = 2,
+  };
+  // required string name = 1;
+  bool has_name() const;
+  private:
+  bool _internal_has_name() const;
+  public:
+  void clear_name();
+  const std::string& name() const;
+  template <typename ArgT0 = const std::string&, typename... ArgT>
+  void set_name(ArgT0&& arg0, ArgT... args);
+  std::string* mutable_name();
+  PROTOBUF_NODISCARD std::string* release_name();
+  void set_allocated_name(std::string* name);
+  private:
+  const std::string& _internal_name() const;
+  inline PROTOBUF_ALWAYS_INLINE void _internal_set_name(const std::string& value);
+  std::string* _internal_mutable_name();
+  public:
+
+  // required float weight = 3;
+  bool has_weight() const;
+  private:
+  bool _internal_has_weight() const;
+  public:
+  void clear_weight();
+  float weight() const;
+  void set_weight(float value);
+  private:
+  float _internal_weight() const;
+  void _internal_set_weight(float value);
+  public:
+
+  // required .pomagma_messaging.WeightedTerm.Arity arity = 2;
+  bool has_arity() const;
+  private:
+  bool _internal_has_arity() const;
+  public:
+  void clear_arity();
+  ::pomagma_messaging::WeightedTerm_Arity arity() const;
+  void set_arity(::pomagma_messaging::WeightedTerm_Arity value);
+  private:
+  ::pomagma_messaging::WeightedTerm_Arity _internal_arity() const;
+  void _internal_set_arity(::pomagma_messaging::WeightedTerm_Arity value);
+  public:
+
+  // @@protoc_insertion_point(class_scope:pomagma_messaging.WeightedTerm)
+ private:
+  class _Internal;
+
+  // helper for ByteSizeLong()
+  size_t RequiredFieldsByteSizeFallback() const;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::internal::HasBits<1> _has_bits_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+    ::PROTOBUF_NAMESPACE_ID::internal::ArenaStringPtr name_;
+    float weight_;
+    int arity_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_language_2eproto;
+};
+// -------------------------------------------------------------------
+
+class Language final :
+    public ::PROTOBUF_NAMESPACE_ID::Message /* @@protoc_insertion_point(class_definition:pomagma_messaging.Language) */ {
+ public:
+  inline Language() : Language(nullptr) {}
+  ~Language() override;
+  explicit PROTOBUF_CONSTEXPR Language(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  Language(const Language& from);
+  Language(Language&& from) noexcept
+    : Language() {
+    *this = ::std::move(from);
+  }
+
+  inline Language& operator=(const Language& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline Language& operator=(Language&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const Language& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const Language* internal_default_instance() {
+    return reinterpret_cast<const Language*>(
+               &_Language_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    1;
+
+  friend void swap(Language& a, Language& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(Language* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(Language* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  Language* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<Language>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::Message::CopyFrom;
+  void CopyFrom(const Language& from);
+  using ::PROTOBUF_NAMESPACE_ID::Message::MergeFrom;
+  void MergeFrom( const Language& from) {
+    Language::MergeImpl(*this, from);
+  }
+  private:
+  static void MergeImpl(::PROTOBUF_NAMESPACE_ID::Message& to_msg, const ::PROTOBUF_NAMESPACE_ID::Message& from_msg);
+  public:
+  PROTOBUF_ATTRIBUTE_REINITIALIZES void Clear() final;
+  bool IsInitialized() const final;
+
+  size_t ByteSizeLong() const final;
+  const char* _InternalParse(const char* ptr, ::PROTOBUF_NAMESPACE_ID::internal::ParseContext* ctx) final;
+  uint8_t* _InternalSerialize(
+      uint8_t* target, ::PROTOBUF_NAMESPACE_ID::io::EpsCopyOutputStream* stream) const final;
+  int GetCachedSize() const final { return _impl_._cached_size_.Get(); }
+
+  private:
+  void SharedCtor(::PROTOBUF_NAMESPACE_ID::Arena* arena, bool is_message_owned);
+  void SharedDtor();
+  void SetCachedSize(int size) const final;
+  void InternalSwap(Language* other);
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "pomagma_messaging.Language";
+  }
+  protected:
+  explicit Language(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  // accessors -------------------------------------------------------
+
+  enum : int {
+    kTermsFieldNumber = 1,
+  };
+  // repeated .pomagma_messaging.WeightedTerm terms = 1;
+  int terms_size() const;
+  private:
+  int _internal_terms_size() const;
+  public:
+  void clear_terms();
+  ::pomagma_messaging::WeightedTerm* mutable_terms(int index);
+  ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::pomagma_messaging::WeightedTerm >*
+      mutable_terms();
+  private:
+  const ::pomagma_messaging::WeightedTerm& _internal_terms(int index) const;
+  ::pomagma_messaging::WeightedTerm* _internal_add_terms();
+  public:
+  const ::pomagma_messaging::WeightedTerm& terms(int index) const;
+  ::pomagma_messaging::WeightedTerm* add_terms();
+  const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::pomagma_messaging::WeightedTerm >&
+      terms() const;
+
+  // @@protoc_insertion_point(class_scope:pomagma_messaging.Language)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+    ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::pomagma_messaging::WeightedTerm > terms_;
+    mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
+  };
+  union { Impl_ _impl_; };
+  friend struct ::TableStruct_language_2eproto;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wstrict-aliasing"
+#endif  // __GNUC__
+// WeightedTerm
+
+// required string name = 1;
+inline bool WeightedTerm::_internal_has_name() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000001u) != 0;
+  return value;
+}
+inline bool WeightedTerm::has_name() const {
+  return _internal_has_name();
+}
+inline void WeightedTerm::clear_name() {
+  _impl_.name_.ClearToEmpty();
+  _impl_._has_bits_[0] &= ~0x00000001u;
+}
+inline const std::string& WeightedTerm::name() const {
+  // @@protoc_insertion_point(field_get:pomagma_messaging.WeightedTerm.name)
+  return _internal_name();
+}
+template <typename ArgT0, typename... ArgT>
+inline PROTOBUF_ALWAYS_INLINE
+void WeightedTerm::set_name(ArgT0&& arg0, ArgT... args) {
+ _impl_._has_bits_[0] |= 0x00000001u;
+ _impl_.name_.Set(static_cast<ArgT0 &&>(arg0), args..., GetArenaForAllocation());
+  // @@protoc_insertion_point(field_set:pomagma_messaging.WeightedTerm.name)
+}
+inline std::string* WeightedTerm::mutable_name() {
+  std::string* _s = _internal_mutable_name();
+  // @@protoc_insertion_point(field_mutable:pomagma_messaging.WeightedTerm.name)
+  return _s;
+}
+inline const std::string& WeightedTerm::_internal_name() const {
+  return _impl_.name_.Get();
+}
+inline void WeightedTerm::_internal_set_name(const std::string& value) {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  _impl_.name_.Set(value, GetArenaForAllocation());
+}
+inline std::string* WeightedTerm::_internal_mutable_name() {
+  _impl_._has_bits_[0] |= 0x00000001u;
+  return _impl_.name_.Mutable(GetArenaForAllocation());
+}
+inline std::string* WeightedTerm::release_name() {
+  // @@protoc_insertion_point(field_release:pomagma_messaging.WeightedTerm.name)
+  if (!_internal_has_name()) {
+    return nullptr;
+  }
+  _impl_._has_bits_[0] &= ~0x00000001u;
+  auto* p = _impl_.name_.Release();
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.name_.IsDefault()) {
+    _impl_.name_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  return p;
+}
+inline void WeightedTerm::set_allocated_name(std::string* name) {
+  if (name != nullptr) {
+    _impl_._has_bits_[0] |= 0x00000001u;
+  } else {
+    _impl_._has_bits_[0] &= ~0x00000001u;
+  }
+  _impl_.name_.SetAllocated(name, GetArenaForAllocation());
+#ifdef PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  if (_impl_.name_.IsDefault()) {
+    _impl_.name_.Set("", GetArenaForAllocation());
+  }
+#endif // PROTOBUF_FORCE_COPY_DEFAULT_STRING
+  // @@protoc_insertion_point(field_set_allocated:pomagma_messaging.WeightedTerm.name)
+}
+
+// required .pomagma_messaging.WeightedTerm.Arity arity = 2;
+inline bool WeightedTerm::_internal_has_arity() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000004u) != 0;
+  return value;
+}
+inline bool WeightedTerm::has_arity() const {
+  return _internal_has_arity();
+}
+inline void WeightedTerm::clear_arity() {
+  _impl_.arity_ = 1;
+  _impl_._has_bits_[0] &= ~0x00000004u;
+}
+inline ::pomagma_messaging::WeightedTerm_Arity WeightedTerm::_internal_arity() const {
+  return static_cast< ::pomagma_messaging::WeightedTerm_Arity >(_impl_.arity_);
+}
+inline ::pomagma_messaging::WeightedTerm_Arity WeightedTerm::arity() const {
+  // @@protoc_insertion_point(field_get:pomagma_messaging.WeightedTerm.arity)
+  return _internal_arity();
+}
+inline void WeightedTerm::_internal_set_arity(::pomagma_messaging::WeightedTerm_Arity value) {
+  assert(::pomagma_messaging::WeightedTerm_Arity_IsValid(value));
+  _impl_._has_bits_[0] |= 0x00000004u;
+  _impl_.arity_ = value;
+}
+inline void WeightedTerm::set_arity(::pomagma_messaging::WeightedTerm_Arity value) {
+  _internal_set_arity(value);
+  // @@protoc_insertion_point(field_set:pomagma_messaging.WeightedTerm.arity)
+}
+
+// required float weight = 3;
+inline bool WeightedTerm::_internal_has_weight() const {
+  bool value = (_impl_._has_bits_[0] & 0x00000002u) != 0;
+  return value;
+}
+inline bool WeightedTerm::has_weight() const {
+  return _internal_has_weight();
+}
+inline void WeightedTerm::clear_weight() {
+  _impl_.weight_ = 0;
+  _impl_._has_bits_[0] &= ~0x00000002u;
+}
+inline float WeightedTerm::_internal_weight() const {
+  return _impl_.weight_;
+}
+inline float WeightedTerm::weight() const {
+  // @@protoc_insertion_point(field_get:pomagma_messaging.WeightedTerm.weight)
+  return _internal_weight();
+}
+inline void WeightedTerm::_internal_set_weight(float value) {
+  _impl_._has_bits_[0] |= 0x00000002u;
+  _impl_.weight_ = value;
+}
+inline void WeightedTerm::set_weight(float value) {
+  _internal_set_weight(value);
+  // @@protoc_insertion_point(field_set:pomagma_messaging.WeightedTerm.weight)
+}
+
+// -------------------------------------------------------------------
+
+// Language
+
+// repeated .pomagma_messaging.WeightedTerm terms = 1;
+inline int Language::_internal_terms_size() const {
+  return _impl_.terms_.size();
+}
+inline int Language::terms_size() const {
+  return _internal_terms_size();
+}
+inline void Language::clear_terms() {
+  _impl_.terms_.Clear();
+}
+inline ::pomagma_messaging::WeightedTerm* Language::mutable_terms(int index) {
+  // @@protoc_insertion_point(field_mutable:pomagma_messaging.Language.terms)
+  return _impl_.terms_.Mutable(index);
+}
+inline ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::pomagma_messaging::WeightedTerm >*
+Language::mutable_terms() {
+  // @@protoc_insertion_point(field_mutable_list:pomagma_messaging.Language.terms)
+  return &_impl_.terms_;
+}
+inline const ::pomagma_messaging::WeightedTerm& Language::_internal_terms(int index) const {
+  return _impl_.terms_.Get(index);
+}
+inline const ::pomagma_messaging::WeightedTerm& Language::terms(int index) const {
+  // @@protoc_insertion_point(field_get:pomagma_messaging.Language.terms)
+  return _internal_terms(index);
+}
+inline ::pomagma_messaging::WeightedTerm* Language::_internal_add_terms() {
+  return _impl_.terms_.Add();
+}
+inline ::pomagma_messaging::WeightedTerm* Language::add_terms() {
+  ::pomagma_messaging::WeightedTerm* _add = _internal_add_terms();
+  // @@protoc_insertion_point(field_add:pomagma_messaging.Language.terms)
+  return _add;
+}
+inline const ::PROTOBUF_NAMESPACE_ID::RepeatedPtrField< ::pomagma_messaging::WeightedTerm >&
+Language::terms() const {
+  // @@protoc_insertion_point(field_list:pomagma_messaging.Language.terms)
+  return _impl_.terms_;
+}
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic pop
+#endif  // __GNUC__
+// -------------------------------------------------------------------
+
+
+// @@protoc_insertion_point(namespace_scope)
+
+}  // namespace pomagma_messaging
+
+PROTOBUF_NAMESPACE_OPEN
+
+template <> struct is_proto_enum< ::pomagma_messaging::WeightedTerm_Arity> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::pomagma_messaging::WeightedTerm_Arity>() {
+  return ::pomagma_messaging::WeightedTerm_Arity_descriptor();
+}
+
+PROTOBUF_NAMESPACE_CLOSE
+
+// @@protoc_insertion_point(global_scope)
+
+#include <google/protobuf/port_undef.inc>
+#endif  // GOOGLE_PROTOBUF_INCLUDED_GOOGLE_PROTOBUF_INCLUDED_language_2eproto
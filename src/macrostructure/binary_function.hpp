@@ -48,6 +48,10 @@ public:
 
     // unsafe operations
     void unsafe_merge (const Ob dep);
+    // batched version defers merges by returning them as equations
+    void unsafe_merge (
+            const std::vector<Ob> & deps,
+            std::vector<std::pair<Ob, Ob>> & equations);
 
 private:
 
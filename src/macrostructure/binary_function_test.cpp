@@ -57,6 +57,7 @@ int main ()
 {
     Log::Context log_context("BinaryFunction Test");
     test_function<Example>(rng);
+    test_batch_merge<BinaryFunction>(rng, example_fun);
 
     return 0;
 }
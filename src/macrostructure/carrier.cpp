@@ -101,6 +101,34 @@ void Carrier::unsafe_remove (const Ob ob)
     POMAGMA_DEBUG1(m_item_count << " obs after removing " << ob);
 }
 
+// batched version for deps only, taking O(item_dim) total rather than per dep
+void Carrier::unsafe_remove (const std::vector<Ob> & deps)
+{
+    // compress all paths; this relies on the invariant m_reps[ob] <= ob
+    for (Ob ob = 1, end = item_dim(); ob <= end; ++ob) {
+        if (Ob rep = m_reps[ob]) {
+            m_reps[ob] = m_reps[rep];
+        }
+    }
+
+    for (Ob dep : deps) {
+        POMAGMA_ASSERT2(m_support.contains(dep), "double removal: " << dep);
+        POMAGMA_ASSERT2(m_reps[dep] != dep, "tried to remove rep " << dep);
+        m_support.remove(dep);
+        m_reps[dep] = 0;
+    }
+    m_item_count -= deps.size();
+    POMAGMA_DEBUG1(m_item_count << " obs after removing " << deps.size());
+
+    if (POMAGMA_DEBUG_LEVEL >= 2) {
+        for (auto iter = m_support.iter(); iter.ok(); iter.next()) {
+            Ob ob = * iter;
+            POMAGMA_ASSERT(m_support.contains(m_reps[ob]),
+                    "removed rep " << m_reps[ob] << " before dep " << ob);
+        }
+    }
+}
+
 Ob Carrier::merge (Ob dep, Ob rep) const
 {
     POMAGMA_ASSERT2(dep > rep,
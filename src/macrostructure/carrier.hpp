@@ -50,6 +50,7 @@ public:
     // unsafe operations
     Ob unsafe_insert ();
     void unsafe_remove (const Ob ob);
+    void unsafe_remove (const std::vector<Ob> & deps);
 
 private:
 
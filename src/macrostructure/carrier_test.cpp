@@ -43,6 +43,34 @@ void test_random (size_t size)
     POMAGMA_ASSERT_EQ(carrier.item_count(), 0);
 }
 
+void test_batch_remove (size_t size)
+{
+    Carrier carrier(size);
+    for (size_t i = 1; i <= size; ++i) {
+        carrier.unsafe_insert();
+    }
+
+    std::uniform_int_distribution<size_t> random_ob(1, size);
+    for (size_t i = 1; i <= size; ++i) {
+        Ob dep = carrier.find(random_ob(rng));
+        Ob rep = carrier.find(random_ob(rng));
+        if (dep > rep) {
+            carrier.merge(dep, rep);
+        }
+    }
+    carrier.validate();
+
+    std::vector<Ob> deps;
+    for (auto iter = carrier.iter(); iter.ok(); iter.next()) {
+        if (carrier.find(* iter) != * iter) {
+            deps.push_back(* iter);
+        }
+    }
+    carrier.unsafe_remove(deps);
+    carrier.validate();
+    POMAGMA_ASSERT_EQ(carrier.item_count(), carrier.rep_count());
+}
+
 int main ()
 {
     Log::Context log_context("Carrier Test");
@@ -52,5 +80,10 @@ int main ()
         test_random(size);
     }
 
+    POMAGMA_INFO("Testing batched removal");
+    for (size_t size = 2; size < 200; ++size) {
+        test_batch_remove(size);
+    }
+
     return 0;
 }
@@ -1,6 +1,7 @@
 #pragma once 
 
 #include "carrier.hpp"
+#include <algorithm>
 
 namespace pomagma
 {
@@ -70,6 +71,102 @@ void test_merge (Carrier & carrier, rng_t & rng)
     POMAGMA_ASSERT_EQ(merge_count, g_merge_count);
 }
 
+// collects deps not yet in removed, appending them to removed
+inline bool find_deps (
+        const Carrier & carrier,
+        std::vector<Ob> & removed,
+        std::vector<Ob> & deps)
+{
+    deps.clear();
+    for (auto iter = carrier.iter(); iter.ok(); iter.next()) {
+        Ob dep = * iter;
+        if (carrier.find(dep) != dep and
+            std::find(removed.begin(), removed.end(), dep) == removed.end())
+        {
+            deps.push_back(dep);
+        }
+    }
+    removed.insert(removed.end(), deps.begin(), deps.end());
+    return not deps.empty();
+}
+
+// checks that the batched unsafe_merge(deps, equations) used by the
+// scheduler agrees with one-at-a-time unsafe_merge(dep)
+template<class Function>
+void test_batch_merge (size_t size, rng_t & rng, Ob (*value) (Ob, Ob))
+{
+    POMAGMA_INFO("Checking batched unsafe_merge");
+    Carrier seq_carrier(size, merge_callback);
+    Carrier batch_carrier(size, merge_callback);
+    for (Ob i = 1; i <= size; ++i) {
+        POMAGMA_ASSERT(seq_carrier.unsafe_insert(), "insertion failed");
+        POMAGMA_ASSERT(batch_carrier.unsafe_insert(), "insertion failed");
+    }
+    Function seq_fun(seq_carrier);
+    Function batch_fun(batch_carrier);
+    for (Ob i = 1; i <= size; ++i)
+    for (Ob j = 1; j <= size; ++j) {
+        Ob k = value(i, j);
+        if ((k > 1) and (k <= size)) {
+            seq_fun.insert(i, j, k);
+            batch_fun.insert(i, j, k);
+        }
+    }
+
+    std::uniform_int_distribution<Ob> random_ob(1, size);
+    for (size_t n = 0; n < size / 4; ++n) {
+        Ob x = random_ob(rng);
+        Ob y = random_ob(rng);
+        seq_carrier.ensure_equal(seq_carrier.find(x), seq_carrier.find(y));
+        batch_carrier.ensure_equal(
+            batch_carrier.find(x),
+            batch_carrier.find(y));
+    }
+
+    // merge in rounds, as in the scheduler's process_mergers
+    std::vector<Ob> seq_removed;
+    std::vector<Ob> deps;
+    while (find_deps(seq_carrier, seq_removed, deps)) {
+        for (Ob dep : deps) {
+            seq_fun.unsafe_merge(dep);
+        }
+    }
+    seq_fun.update_values();
+    seq_carrier.unsafe_remove(seq_removed);
+    seq_fun.validate();
+
+    std::vector<Ob> batch_removed;
+    std::vector<std::pair<Ob, Ob>> equations;
+    while (find_deps(batch_carrier, batch_removed, deps)) {
+        equations.clear();
+        batch_fun.unsafe_merge(deps, equations);
+        for (const auto & equation : equations) {
+            batch_carrier.ensure_equal(
+                batch_carrier.find(equation.first),
+                batch_carrier.find(equation.second));
+        }
+    }
+    batch_fun.update_values();
+    batch_carrier.unsafe_remove(batch_removed);
+    batch_fun.validate();
+
+    POMAGMA_ASSERT(seq_carrier.support() == batch_carrier.support(),
+            "batched merge removed different obs");
+    POMAGMA_ASSERT_EQ(seq_fun.count_pairs(), batch_fun.count_pairs());
+    for (auto i = seq_carrier.iter(); i.ok(); i.next())
+    for (auto j = seq_carrier.iter(); j.ok(); j.next()) {
+        POMAGMA_ASSERT_EQ(seq_fun.find(*i, *j), batch_fun.find(*i, *j));
+    }
+}
+
+template<class Function>
+void test_batch_merge (rng_t & rng, Ob (*value) (Ob, Ob))
+{
+    for (size_t exponent = 1; exponent < 8; ++exponent) {
+        test_batch_merge<Function>((1 << exponent) - 1, rng, value);
+    }
+}
+
 template<class Example>
 void test_function (size_t size, rng_t & rng)
 {
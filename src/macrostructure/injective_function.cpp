@@ -127,7 +127,7 @@ void InjectiveFunction::unsafe_merge (Ob dep)
 
         Ob & dep_val = m_values[dep];
         Ob & rep_val = m_values[rep];
-        m_carrier.set_and_merge(rep_val, dep_val);
+        m_carrier.set_or_merge(rep_val, dep_val);
         dep_val = 0;
     }
     for (auto iter = this->iter(); iter.ok(); iter.next()) {
@@ -140,7 +140,7 @@ void InjectiveFunction::unsafe_merge (Ob dep)
 
         Ob & dep_val = m_inverse[dep];
         Ob & rep_val = m_inverse[rep];
-        m_carrier.set_and_merge(rep_val, dep_val); // XXX is this safe?
+        m_carrier.set_or_merge(rep_val, dep_val);
         dep_val = 0;
     }
     for (auto iter = inverse_iter(); iter.ok(); iter.next()) {
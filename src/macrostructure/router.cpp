@@ -4,6 +4,7 @@
 #include "injective_function.hpp"
 #include "binary_function.hpp"
 #include "symmetric_function.hpp"
+#include "snapshot.hpp"
 #include <algorithm>
 #include <tuple>
 
@@ -23,7 +24,7 @@ inline Router::TypeId Router::new_type (
 
 inline Range<Router::Iterator> Router::iter_val (Ob val) const
 {
-    size_t begin = m_value_index[val - 1];
+    size_t begin = val == 1 ? 0 : m_value_index[val - 1] + 1;
     size_t end = m_value_index[val] + 1;
     return range(m_segments.begin() + begin, m_segments.begin() + end);
 }
@@ -212,6 +213,7 @@ std::vector<float> Router::measure_probs (float reltol) const
     POMAGMA_INFO("Measuring ob probs");
     const size_t item_count = m_carrier.item_count();
     std::vector<float> probs(1 + item_count, 0);
+    std::vector<float> next_probs(1 + item_count, 0);
     const float max_increase = 1.0 + reltol;
 
     bool changed = true;
@@ -220,9 +222,8 @@ std::vector<float> Router::measure_probs (float reltol) const
 
         POMAGMA_DEBUG("accumulating route probabilities");
 
-        // The following three cannot be mixed: openmp, gcc, fork.
-        // see http://bisqwit.iki.fi/story/howto/openmp/#OpenmpAndFork
-        //# pragma omp parallel for schedule(dynamic, 1)
+        // each sweep reads only probs and writes only next_probs
+        # pragma omp parallel for schedule(dynamic, 1) reduction(||:changed)
         for (size_t i = 0; i < item_count; ++i) {
             Ob ob = 1 + i;
 
@@ -232,23 +233,114 @@ std::vector<float> Router::measure_probs (float reltol) const
             }
 
             if (prob > probs[ob] * max_increase) {
-                //#pragma omp atomic
                 changed = true;
             }
-            probs[ob] = prob; // relaxed memory order
+            next_probs[ob] = prob;
         }
+
+        std::swap(probs, next_probs);
     }
 
     return probs;
 }
 
-std::vector<std::string> Router::find_routes () const
+// Measures probs in the quotient by a snapshot's equations.
+// Only reps get nonzero probs. Segments of obs touched by the quotient are
+// rewritten in terms of reps and deduplicated, since e.g. APP x y and APP x' y
+// become a single segment when x = x'.
+std::vector<float> Router::measure_probs (
+        const Snapshot & snapshot,
+        float reltol) const
 {
-    POMAGMA_INFO("Routing all obs");
+    POMAGMA_DEBUG("Measuring ob probs in snapshot");
+    const size_t item_count = m_carrier.item_count();
+    std::vector<float> probs(1 + item_count, 0);
+    const float max_increase = 1.0 + reltol;
+
+    std::unordered_map<Ob, std::vector<Segment>> rewritten;
+    for (size_t i = 0; i < item_count; ++i) {
+        Ob ob = 1 + i;
+
+        bool affected = snapshot.merged(ob);
+        for (const Segment & segment : iter_val(ob)) {
+            if (affected) { break; }
+            switch (m_types[segment.type].arity) {
+                case NULLARY: break;
+                case UNARY: {
+                    affected = snapshot.merged(segment.arg1);
+                } break;
+                case BINARY: {
+                    affected = snapshot.merged(segment.arg1)
+                            or snapshot.merged(segment.arg2);
+                } break;
+            }
+        }
+
+        if (affected) {
+            Ob rep = snapshot.find(ob);
+            auto & segments = rewritten[rep];
+            for (const Segment & segment : iter_val(ob)) {
+                segments.push_back(Segment(
+                    segment.type,
+                    rep,
+                    segment.arg1 ? snapshot.find(segment.arg1) : 0,
+                    segment.arg2 ? snapshot.find(segment.arg2) : 0));
+            }
+        }
+    }
+    for (auto & pair : rewritten) {
+        auto & segments = pair.second;
+        auto less = [](const Segment & x, const Segment & y){
+            return std::tie(x.type, x.arg1, x.arg2)
+                 < std::tie(y.type, y.arg1, y.arg2);
+        };
+        auto equal = [](const Segment & x, const Segment & y){
+            return std::tie(x.type, x.arg1, x.arg2)
+                == std::tie(y.type, y.arg1, y.arg2);
+        };
+        std::sort(segments.begin(), segments.end(), less);
+        segments.erase(
+            std::unique(segments.begin(), segments.end(), equal),
+            segments.end());
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t i = 0; i < item_count; ++i) {
+            Ob ob = 1 + i;
+            if (snapshot.find(ob) != ob) { continue; }
+
+            float prob = 0;
+            auto r = rewritten.find(ob);
+            if (r == rewritten.end()) {
+                for (const Segment & segment : iter_val(ob)) {
+                    prob += get_prob(segment, probs);
+                }
+            } else {
+                for (const Segment & segment : r->second) {
+                    prob += get_prob(segment, probs);
+                }
+            }
+
+            if (prob > probs[ob] * max_increase) {
+                changed = true;
+            }
+            probs[ob] = prob;
+        }
+    }
+
+    return probs;
+}
 
+void Router::find_best_segments (
+        std::vector<float> & best_probs,
+        std::vector<Segment> & best_segments) const
+{
     const size_t item_count = m_carrier.item_count();
-    std::vector<float> best_probs(1 + item_count, 0);
-    std::vector<Segment> best_segments(1 + item_count);
+    best_probs.assign(1 + item_count, 0);
+    best_segments.resize(1 + item_count);
 
     bool changed = true;
     while (changed) {
@@ -278,50 +370,94 @@ std::vector<std::string> Router::find_routes () const
             }
         }
     }
+}
 
-    POMAGMA_DEBUG("scheduling route building");
-    std::vector<Ob> schedule;
-    schedule.reserve(item_count);
+RouteDag Router::find_route_dag () const
+{
+    POMAGMA_INFO("Routing all obs");
+
+    std::vector<float> best_probs;
+    std::vector<Segment> best_segments;
+    find_best_segments(best_probs, best_segments);
+
+    POMAGMA_DEBUG("building route dag");
+    std::vector<std::string> symbols;
+    for (const SegmentType & type : m_types) {
+        symbols.push_back(type.name);
+    }
+    std::vector<RouteDag::Node> nodes(1 + m_carrier.item_count());
+    for (auto & node : nodes) {
+        node.symbol = RouteDag::NONE;
+    }
     for (auto iter = m_carrier.iter(); iter.ok(); iter.next()) {
         Ob ob = * iter;
         POMAGMA_ASSERT_LT(0, best_probs[ob]);
-        schedule.push_back(ob);
+        const Segment & segment = best_segments[ob];
+        RouteDag::Node & node = nodes[ob];
+        node.symbol = segment.type;
+        node.arg1 = segment.arg1;
+        node.arg2 = segment.arg2;
     }
-    std::sort(
-        schedule.begin(),
-        schedule.end(),
-        [&](const Ob & x, const Ob & y){
-            return best_probs[x] > best_probs[y];
-        });
 
-    POMAGMA_DEBUG("building full routes");
-    std::vector<std::string> routes(1 + item_count);
-    for (Ob ob : schedule) {
+    RouteDag routes;
+    routes.init(std::move(symbols), std::move(nodes));
+    return routes;
+}
 
-        const Segment & segment = best_segments[ob];
-        const SegmentType & type = m_types[segment.type];
-        switch (type.arity) {
-            case NULLARY: {
-                routes[ob] = type.name;
-            } break;
+//----------------------------------------------------------------------------
+// RouteDag
 
-            case UNARY: {
-                const auto & arg = routes[segment.arg1];
-                POMAGMA_ASSERT(not arg.empty(), "unknown arg route");
-                routes[ob] = type.name + " " + arg;
-            } break;
+void RouteDag::init (
+        std::vector<std::string> && symbols,
+        std::vector<Node> && nodes)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_symbols = std::move(symbols);
+    m_nodes = std::move(nodes);
+    m_cache.clear();
+    m_cache_index.clear();
+}
 
-            case BINARY: {
-                const auto & lhs = routes[segment.arg1];
-                const auto & rhs = routes[segment.arg2];
-                POMAGMA_ASSERT(not lhs.empty(), "unknown lhs route");
-                POMAGMA_ASSERT(not rhs.empty(), "unknown rhs route");
-                routes[ob] = type.name + " " + lhs + " " + rhs;
-            } break;
+// routes are written in prefix order, without recursion
+void RouteDag::write (std::ostream & os, Ob ob) const
+{
+    POMAGMA_ASSERT(defined(ob), "unknown route for ob " << ob);
+    std::vector<Ob> stack(1, ob);
+    const char * sep = "";
+    while (not stack.empty()) {
+        const Node & node = m_nodes[stack.back()];
+        stack.pop_back();
+        os << sep << m_symbols[node.symbol];
+        sep = " ";
+        if (node.arg2) { stack.push_back(node.arg2); }
+        if (node.arg1) { stack.push_back(node.arg1); }
+    }
+}
+
+std::string RouteDag::operator[] (Ob ob) const
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto i = m_cache_index.find(ob);
+        if (i != m_cache_index.end()) {
+            m_cache.splice(m_cache.begin(), m_cache, i->second);
+            return i->second->second;
         }
     }
 
-    return routes;
+    std::ostringstream route;
+    write(route, ob);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_cache_size and not m_cache_index.count(ob)) {
+        m_cache.push_front(std::make_pair(ob, route.str()));
+        m_cache_index[ob] = m_cache.begin();
+        if (m_cache.size() > m_cache_size) {
+            m_cache_index.erase(m_cache.back().first);
+            m_cache.pop_back();
+        }
+    }
+    return route.str();
 }
 
 void Router::fit_language (
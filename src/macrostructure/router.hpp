@@ -4,10 +4,74 @@
 #include "structure.hpp"
 #include <pomagma/platform/sequential/dense_set.hpp>
 #include <unordered_map>
+#include <list>
+#include <mutex>
 
 namespace pomagma
 {
 
+class Snapshot;
+
+// A compact DAG of best routes, storing one node per ob.
+// Route strings are serialized on demand through a small LRU cache,
+// or streamed directly to files. Reading is thread safe.
+class RouteDag
+{
+public:
+
+    struct Node
+    {
+        uint32_t symbol;
+        Ob arg1;
+        Ob arg2;
+    };
+
+    static const uint32_t NONE = 0xFFFFFFFFU;
+    static const size_t DEFAULT_CACHE_SIZE = 1024;
+
+    RouteDag (size_t cache_size = DEFAULT_CACHE_SIZE)
+        : m_cache_size(cache_size)
+    {
+    }
+    RouteDag (RouteDag && other)
+        : m_symbols(std::move(other.m_symbols)),
+          m_nodes(std::move(other.m_nodes)),
+          m_cache_size(other.m_cache_size)
+    {
+    }
+    RouteDag & operator= (RouteDag && other)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_symbols = std::move(other.m_symbols);
+        m_nodes = std::move(other.m_nodes);
+        m_cache.clear();
+        m_cache_index.clear();
+        return * this;
+    }
+
+    void init (
+            std::vector<std::string> && symbols,
+            std::vector<Node> && nodes);
+
+    bool defined (Ob ob) const
+    {
+        return ob < m_nodes.size() and m_nodes[ob].symbol != NONE;
+    }
+    std::string operator[] (Ob ob) const;
+    void write (std::ostream & os, Ob ob) const;
+
+private:
+
+    std::vector<std::string> m_symbols;
+    std::vector<Node> m_nodes;
+
+    typedef std::list<std::pair<Ob, std::string>> Cache;
+    const size_t m_cache_size;
+    mutable std::mutex m_mutex;
+    mutable Cache m_cache; // most recently used first
+    mutable std::unordered_map<Ob, Cache::iterator> m_cache_index;
+};
+
 class Router
 {
 public:
@@ -23,7 +87,10 @@ public:
 
     DenseSet find_defined () const;
     std::vector<float> measure_probs (float reltol = 0.1) const;
-    std::vector<std::string> find_routes () const;
+    std::vector<float> measure_probs (
+            const Snapshot & snapshot,
+            float reltol = 0.1) const;
+    RouteDag find_route_dag () const;
     void fit_language (
             const std::unordered_map<std::string, size_t> & symbol_counts,
             const std::unordered_map<Ob, size_t> & ob_counts,
@@ -80,6 +147,9 @@ private:
     float get_prob (
             const Segment & segment,
             const std::vector<float> & probs) const;
+    void find_best_segments (
+            std::vector<float> & best_probs,
+            std::vector<Segment> & best_segments) const;
     void add_weight (
             float weight,
             const Segment & segment,
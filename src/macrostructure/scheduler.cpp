@@ -7,6 +7,7 @@
 #include <pomagma/platform/signature.hpp>
 #include <unordered_set>
 #include <deque>
+#include <functional>
 
 namespace pomagma
 {
@@ -37,6 +38,14 @@ public:
             return front;
         }
     }
+
+    bool pop_all (std::vector<Ob> & obs)
+    {
+        obs.assign(m_queue.begin(), m_queue.end());
+        m_queue.clear();
+        m_set.clear();
+        return not obs.empty();
+    }
 };
 
 static UniqueFifoQueue g_merge_queue;
@@ -46,48 +55,122 @@ void schedule_merge (Ob dep)
     g_merge_queue.push(dep);
 }
 
-void process_mergers (Signature & signature)
+namespace
 {
-    POMAGMA_INFO("Processing mergers");
-    Carrier & carrier = * signature.carrier();
 
-    std::vector<Ob> remove_queue;
-    while (Ob dep = g_merge_queue.pop()) {
-        POMAGMA_DEBUG("merging " << dep);
-        const Ob rep = carrier.find(dep);
-        POMAGMA_ASSERT(dep > rep, "ill-formed merge: " << dep << ", " << rep);
+typedef std::vector<std::pair<Ob, Ob>> Equations;
 
-#define POMAGMA_MERGE(arity)\
-        for (auto i : signature.arity()) { i.second->unsafe_merge(dep); }
+// runs jobs on the OpenMP thread pool, one job per iteration
+void run_parallel (const std::vector<std::function<void()>> & jobs)
+{
+    const size_t job_count = jobs.size();
 
-        // order by most-likely-to-merge
-        POMAGMA_MERGE(binary_functions);
-        POMAGMA_MERGE(symmetric_functions);
-        POMAGMA_MERGE(injective_functions);
-        POMAGMA_MERGE(nullary_functions);
-        POMAGMA_MERGE(binary_relations);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < job_count; ++i) {
+        jobs[i]();
+    }
+}
 
-#undef POMAGMA_MERGE
+template<class Function>
+void merge_later (
+        const std::unordered_map<std::string, Function *> & funs,
+        const std::vector<Ob> & deps,
+        std::vector<Equations> & equations,
+        std::vector<std::function<void()>> & jobs)
+{
+    for (auto i : funs) {
+        Function * fun = i.second;
+        equations.push_back(Equations());
+        Equations * e = & equations.back();
+        jobs.push_back([fun, &deps, e](){
+            fun->unsafe_merge(deps, * e);
+        });
+    }
+}
 
-        remove_queue.push_back(dep);
+// All deps share a closed set of reps, so tables can be rewritten
+// concurrently. Merges discovered while rewriting are deferred to the caller.
+void merge_batch (
+        Signature & signature,
+        const std::vector<Ob> & deps)
+{
+    Carrier & carrier = * signature.carrier();
+
+    // do expensive tasks in parallel
+    std::vector<std::function<void()>> jobs;
+    for (auto i : signature.binary_relations()) {
+        BinaryRelation * rel = i.second;
+        jobs.push_back([rel, &deps](){
+            for (Ob dep : deps) {
+                rel->unsafe_merge(dep);
+            }
+        });
+    }
+    std::vector<Equations> equations;
+    equations.reserve(
+        signature.binary_functions().size() +
+        signature.symmetric_functions().size());
+    merge_later(signature.binary_functions(), deps, equations, jobs);
+    merge_later(signature.symmetric_functions(), deps, equations, jobs);
+    run_parallel(jobs);
+
+    // do everything else in this thread, since these may merge
+    for (auto i : signature.injective_functions()) {
+        for (Ob dep : deps) { i.second->unsafe_merge(dep); }
+    }
+    for (auto i : signature.nullary_functions()) {
+        for (Ob dep : deps) { i.second->unsafe_merge(dep); }
+    }
+    for (const auto & batch : equations) {
+        for (const auto & equation : batch) {
+            carrier.ensure_equal(
+                carrier.find(equation.first),
+                carrier.find(equation.second));
+        }
+    }
+}
+
+} // anonymous namespace
+
+void process_mergers (Signature & signature)
+{
+    POMAGMA_INFO("Processing mergers");
+    Carrier & carrier = * signature.carrier();
+
+    std::vector<Ob> remove_queue;
+    std::vector<Ob> deps;
+    while (g_merge_queue.pop_all(deps)) {
+        POMAGMA_DEBUG("merging batch of " << deps.size() << " obs");
+        for (Ob dep : deps) {
+            const Ob rep = carrier.find(dep);
+            POMAGMA_ASSERT(dep > rep,
+                "ill-formed merge: " << dep << ", " << rep);
+        }
+        merge_batch(signature, deps);
+        remove_queue.insert(remove_queue.end(), deps.begin(), deps.end());
     }
     POMAGMA_INFO("processed " << remove_queue.size() << " mergers");
 
     POMAGMA_INFO("updating values");
+    {
+        std::vector<std::function<void()>> jobs;
+
 #define POMAGMA_UPDATE(arity)\
-    for (auto i : signature.arity()) { i.second->update_values(); }
+        for (auto i : signature.arity()) {\
+            auto * fun = i.second;\
+            jobs.push_back([fun](){ fun->update_values(); });\
+        }
 
-    POMAGMA_UPDATE(binary_functions);
-    POMAGMA_UPDATE(symmetric_functions);
-    POMAGMA_UPDATE(injective_functions);
-    POMAGMA_UPDATE(nullary_functions);
+        POMAGMA_UPDATE(binary_functions);
+        POMAGMA_UPDATE(symmetric_functions);
 
 #undef POMAGMA_UPDATE
 
-    POMAGMA_INFO("removing deprecated obs");
-    for (Ob dep : remove_queue) {
-        carrier.unsafe_remove(dep);
+        run_parallel(jobs);
     }
+
+    POMAGMA_INFO("removing deprecated obs");
+    carrier.unsafe_remove(remove_queue);
     remove_queue.clear();
 }
 
@@ -0,0 +1,237 @@
+#include "snapshot.hpp"
+#include "structure_impl.hpp"
+
+namespace pomagma
+{
+
+void RefutationCache::insert (Ob lhs, Ob rhs)
+{
+    auto pair = std::make_pair(min(lhs, rhs), max(lhs, rhs));
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pairs.insert(pair);
+    m_empty.store(false);
+}
+
+inline bool RefutationCache::contains (Ob lhs, Ob rhs) const
+{
+    auto pair = std::make_pair(min(lhs, rhs), max(lhs, rhs));
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_pairs.count(pair);
+}
+
+// the lock is taken per lookup, so inserts from other threads are not
+// blocked for the length of a whole scan
+bool RefutationCache::refutes (
+        const std::vector<Ob> & xs,
+        const std::vector<Ob> & ys) const
+{
+    if (m_empty.load()) {
+        return false;
+    }
+    for (Ob x : xs) {
+        for (Ob y : ys) {
+            if (contains(x, y)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+Snapshot::Snapshot (Structure & base, const RefutationCache * refuted)
+    : m_nless(base.signature().binary_relation("NLESS")),
+      m_refuted(refuted)
+{
+    Signature & signature = base.signature();
+    for (auto pair : signature.injective_functions()) {
+        Table forward = {INJECTIVE, pair.second, nullptr, nullptr};
+        Table inverse = {INVERSE, pair.second, nullptr, nullptr};
+        m_tables.push_back(forward);
+        m_tables.push_back(inverse);
+    }
+    for (auto pair : signature.binary_functions()) {
+        Table table = {BINARY, nullptr, pair.second, nullptr};
+        m_tables.push_back(table);
+    }
+    for (auto pair : signature.symmetric_functions()) {
+        Table table = {SYMMETRIC, nullptr, nullptr, pair.second};
+        m_tables.push_back(table);
+    }
+}
+
+inline Snapshot::Key Snapshot::make_key (uint32_t table, Ob lhs, Ob rhs) const
+{
+    if (m_tables[table].kind == SYMMETRIC and rhs < lhs) {
+        std::swap(lhs, rhs);
+    }
+    Key key = {table, lhs, rhs};
+    return key;
+}
+
+// policy: contradiction whenever NLESS x y for x ~ dep, y ~ rep or vice versa,
+// or whenever x = y is a known refutation
+bool Snapshot::contradicts (Ob dep, Ob rep) const
+{
+    if (not m_nless and not m_refuted) {
+        return false;
+    }
+
+    const std::vector<Ob> singleton_dep(1, dep);
+    const std::vector<Ob> singleton_rep(1, rep);
+    const auto & deps = m_members.count(dep) ? members(dep) : singleton_dep;
+    const auto & reps = m_members.count(rep) ? members(rep) : singleton_rep;
+    if (m_nless) {
+        // check members of the smaller class against the row of the other
+        Ob x = dep;
+        const std::vector<Ob> * ys = & reps;
+        if (deps.size() < reps.size()) {
+            x = rep;
+            ys = & deps;
+        }
+        auto row = m_nless_rows.find(x);
+        for (Ob y : * ys) {
+            if (row == m_nless_rows.end()
+                ? m_nless->find(x, y) or m_nless->find(y, x)
+                : row->second.contains(y))
+            {
+                return true;
+            }
+        }
+    }
+    return m_refuted and m_refuted->refutes(deps, reps);
+}
+
+inline void Snapshot::insert (const Key & key, Ob val)
+{
+    POMAGMA_ASSERT5(not m_values.count(key), "double insertion");
+    m_values.insert(std::make_pair(key, val));
+    m_uses[key.lhs].push_back(key);
+    if (key.rhs and key.rhs != key.lhs) {
+        m_uses[key.rhs].push_back(key);
+    }
+}
+
+// copies all base values with argument ob into the overlay;
+// values whose other argument is already merged have already been copied
+void Snapshot::touch (Ob ob)
+{
+    if (m_members.count(ob)) {
+        return;
+    }
+
+    for (uint32_t t = 0; t < m_tables.size(); ++t) {
+        const Table & table = m_tables[t];
+        switch (table.kind) {
+            case INJECTIVE: {
+                if (table.injective->defined(ob)) {
+                    insert(make_key(t, ob), table.injective->find(ob));
+                }
+            } break;
+
+            case INVERSE: {
+                if (table.injective->inverse_defined(ob)) {
+                    insert(make_key(t, ob), table.injective->inverse_find(ob));
+                }
+            } break;
+
+            case BINARY: {
+                const BinaryFunction & fun = * table.binary;
+                for (auto iter = fun.iter_lhs(ob); iter.ok(); iter.next()) {
+                    Ob rhs = * iter;
+                    if (not merged(rhs)) {
+                        insert(make_key(t, ob, rhs), fun.find(ob, rhs));
+                    }
+                }
+                for (auto iter = fun.iter_rhs(ob); iter.ok(); iter.next()) {
+                    Ob lhs = * iter;
+                    if (lhs != ob and not merged(lhs)) {
+                        insert(make_key(t, lhs, ob), fun.find(lhs, ob));
+                    }
+                }
+            } break;
+
+            case SYMMETRIC: {
+                const SymmetricFunction & fun = * table.symmetric;
+                for (auto iter = fun.iter_lhs(ob); iter.ok(); iter.next()) {
+                    Ob rhs = * iter;
+                    if (not merged(rhs)) {
+                        insert(make_key(t, ob, rhs), fun.find(ob, rhs));
+                    }
+                }
+            } break;
+        }
+    }
+
+    m_members[ob].push_back(ob);
+    if (m_nless) {
+        DenseSet row(m_nless->item_dim());
+        row += m_nless->get_Lx_set(ob);
+        row += m_nless->get_Rx_set(ob);
+        m_nless_rows.insert(std::make_pair(ob, std::move(row)));
+    }
+}
+
+void Snapshot::merge (Ob dep, Ob rep)
+{
+    POMAGMA_ASSERT_LT(rep, dep);
+    touch(dep);
+    touch(rep);
+
+    std::vector<Ob> & rep_members = m_members[rep];
+    for (Ob ob : m_members[dep]) {
+        m_reps[ob] = rep;
+        rep_members.push_back(ob);
+    }
+    m_members.erase(dep);
+    if (m_nless) {
+        auto row = m_nless_rows.find(dep);
+        m_nless_rows.find(rep)->second += row->second;
+        m_nless_rows.erase(row);
+    }
+
+    // rekey values of dep, scheduling merges on conflict
+    std::vector<Key> keys;
+    keys.swap(m_uses[dep]);
+    m_uses.erase(dep);
+    for (const Key & old_key : keys) {
+        auto i = m_values.find(old_key);
+        if (i == m_values.end()) {
+            continue; // already rekeyed
+        }
+        Ob val = i->second;
+        m_values.erase(i);
+
+        Key key = make_key(old_key.table, find(old_key.lhs), find(old_key.rhs));
+        auto j = m_values.find(key);
+        if (j == m_values.end()) {
+            insert(key, val);
+        } else if (find(j->second) != find(val)) {
+            m_pending.push_back(std::make_pair(j->second, val));
+        }
+    }
+}
+
+bool Snapshot::ensure_equal (Ob lhs, Ob rhs)
+{
+    m_pending.push_back(std::make_pair(lhs, rhs));
+    while (not m_pending.empty()) {
+        std::pair<Ob, Ob> equation = m_pending.back();
+        m_pending.pop_back();
+
+        Ob x = find(equation.first);
+        Ob y = find(equation.second);
+        if (x == y) {
+            continue;
+        }
+        Ob dep = max(x, y);
+        Ob rep = min(x, y);
+        if (contradicts(dep, rep)) {
+            m_pending.clear();
+            return false;
+        }
+        merge(dep, rep);
+    }
+    return true;
+}
+
+} // namespace pomagma
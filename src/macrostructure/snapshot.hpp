@@ -0,0 +1,126 @@
+#pragma once
+
+#include "util.hpp"
+#include "structure.hpp"
+#include <pomagma/platform/sequential/dense_set.hpp>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace pomagma
+{
+
+// A set of equations known to be inconsistent, shared among threads.
+// Snapshots consult it while closing, so any hypothesis whose closure
+// equates a refuted pair is cut off as soon as that pair is merged.
+class RefutationCache : noncopyable
+{
+public:
+
+    RefutationCache () : m_empty(true) {}
+
+    void insert (Ob lhs, Ob rhs);
+
+    // true if some x in xs and y in ys are known to be inconsistent
+    bool refutes (const std::vector<Ob> & xs, const std::vector<Ob> & ys) const;
+
+private:
+
+    bool contains (Ob lhs, Ob rhs) const;
+
+    std::atomic<bool> m_empty;
+    mutable std::mutex m_mutex;
+    std::unordered_set<std::pair<Ob, Ob>, ObPairHash> m_pairs;
+};
+
+// A copy-on-write view of a frozen Structure under assumed equations.
+// Only changed reps and function values are recorded; the base is only read,
+// so many snapshots can share one base across threads.
+class Snapshot : noncopyable
+{
+public:
+
+    Snapshot (Structure & base, const RefutationCache * refuted = nullptr);
+
+    // returns false if the equation contradicts NLESS or a known refutation
+    bool ensure_equal (Ob lhs, Ob rhs);
+
+    Ob find (Ob ob) const
+    {
+        auto i = m_reps.find(ob);
+        return i == m_reps.end() ? ob : i->second;
+    }
+    bool merged (Ob ob) const { return m_members.count(find(ob)); }
+    const std::vector<Ob> & members (Ob rep) const
+    {
+        return map_find(m_members, rep);
+    }
+    const std::unordered_map<Ob, std::vector<Ob>> & classes () const
+    {
+        return m_members;
+    }
+
+private:
+
+    enum Kind { INJECTIVE, INVERSE, BINARY, SYMMETRIC };
+
+    struct Table
+    {
+        Kind kind;
+        const InjectiveFunction * injective;
+        const BinaryFunction * binary;
+        const SymmetricFunction * symmetric;
+    };
+
+    struct Key
+    {
+        uint32_t table;
+        Ob lhs;
+        Ob rhs;
+
+        bool operator== (const Key & other) const
+        {
+            return table == other.table
+               and lhs == other.lhs
+               and rhs == other.rhs;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator() (const Key & key) const
+        {
+            ObPairHash hash;
+            return hash(std::make_pair(key.lhs, key.rhs)) ^ key.table;
+        }
+    };
+
+    Key make_key (uint32_t table, Ob lhs, Ob rhs = 0) const;
+    bool contradicts (Ob dep, Ob rep) const;
+    void touch (Ob ob);
+    void insert (const Key & key, Ob val);
+    void merge (Ob dep, Ob rep);
+
+    const BinaryRelation * m_nless;
+    const RefutationCache * m_refuted;
+    std::vector<Table> m_tables;
+
+    // overlay: only obs in nontrivial classes have entries
+    std::unordered_map<Ob, Ob> m_reps;
+    std::unordered_map<Ob, std::vector<Ob>> m_members;
+
+    // overlay: per nontrivial class, obs that are NLESS-related to a member
+    // in either direction
+    std::unordered_map<Ob, DenseSet> m_nless_rows;
+
+    // overlay: function values with at least one argument in a nontrivial
+    // class, keyed by argument reps
+    std::unordered_map<Key, Ob, KeyHash> m_values;
+    std::unordered_map<Ob, std::vector<Key>> m_uses;
+
+    std::vector<std::pair<Ob, Ob>> m_pending;
+};
+
+} // namespace pomagma
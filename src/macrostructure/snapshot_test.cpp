@@ -0,0 +1,228 @@
+#include "snapshot.hpp"
+#include "structure_impl.hpp"
+#include "scheduler.hpp"
+#include "compact.hpp"
+#include "router.hpp"
+#include <algorithm>
+
+using namespace pomagma;
+
+rng_t rng;
+
+static const size_t ITEM_DIM = 63;
+static const size_t ITEM_COUNT = 48;
+
+// builds the same sparse random structure for a given seed
+void init_structure (Structure & structure, size_t seed)
+{
+    rng_t structure_rng(seed);
+    std::uniform_int_distribution<Ob> random_ob(1, ITEM_COUNT);
+    std::bernoulli_distribution randomly_define(0.02);
+
+    structure.init_carrier(ITEM_DIM);
+    Signature & signature = structure.signature();
+    Carrier & carrier = structure.carrier();
+    for (size_t i = 0; i < ITEM_COUNT; ++i) {
+        carrier.unsafe_insert();
+    }
+
+    auto * NLESS = new BinaryRelation(carrier);
+    auto * X = new NullaryFunction(carrier);
+    auto * Y = new NullaryFunction(carrier);
+    auto * QUOTE = new InjectiveFunction(carrier);
+    auto * APP = new BinaryFunction(carrier);
+    auto * JOIN = new SymmetricFunction(carrier);
+    signature.declare("NLESS", * NLESS);
+    signature.declare("X", * X);
+    signature.declare("Y", * Y);
+    signature.declare("QUOTE", * QUOTE);
+    signature.declare("APP", * APP);
+    signature.declare("JOIN", * JOIN);
+
+    X->insert(1);
+    Y->insert(2);
+    for (Ob key = 1; key + 1 <= ITEM_COUNT; key += 3) {
+        QUOTE->insert(key, key + 1);
+    }
+    // the router assumes every ob is reached by some segment
+    for (Ob val = 3; val <= ITEM_COUNT; ++val) {
+        Ob lhs, rhs;
+        do {
+            lhs = random_ob(structure_rng);
+            rhs = random_ob(structure_rng);
+        } while (APP->find(lhs, rhs));
+        APP->insert(lhs, rhs, val);
+    }
+    for (Ob lhs = 1; lhs <= ITEM_COUNT; ++lhs)
+    for (Ob rhs = 1; rhs <= ITEM_COUNT; ++rhs) {
+        if (not APP->find(lhs, rhs) and randomly_define(structure_rng)) {
+            APP->insert(lhs, rhs, random_ob(structure_rng));
+        }
+        if (lhs <= rhs and randomly_define(structure_rng)) {
+            JOIN->insert(lhs, rhs, random_ob(structure_rng));
+        }
+    }
+}
+
+std::unordered_map<std::string, float> get_language ()
+{
+    std::unordered_map<std::string, float> language;
+    language["X"] = 0.2;
+    language["Y"] = 0.2;
+    language["QUOTE"] = 0.1;
+    language["APP"] = 0.3;
+    language["JOIN"] = 0.2;
+    return language;
+}
+
+static Carrier * g_carrier = nullptr;
+static std::vector<std::pair<Ob, Ob>> g_mergers;
+
+void record_merge (Ob dep)
+{
+    g_mergers.push_back(std::make_pair(dep, g_carrier->find(dep)));
+    schedule_merge(dep);
+}
+
+std::vector<float> sorted_nonzero (const std::vector<float> & probs)
+{
+    std::vector<float> result;
+    for (float prob : probs) {
+        if (prob > 0) {
+            result.push_back(prob);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// compares a snapshot against process_mergers + compact on a copy
+void test_merge (size_t seed, Ob lhs, Ob rhs)
+{
+    POMAGMA_INFO("Testing snapshot merge " << lhs << " = " << rhs);
+    const float reltol = 1e-6;
+    const auto language = get_language();
+
+    Structure structure;
+    init_structure(structure, seed);
+    Snapshot snapshot(structure);
+    POMAGMA_ASSERT(snapshot.ensure_equal(lhs, rhs),
+        "unexpected contradiction");
+    std::vector<float> actual_probs;
+    {
+        Router router(structure.signature(), language);
+        actual_probs = router.measure_probs(snapshot, reltol);
+    }
+
+    Structure copy;
+    init_structure(copy, seed);
+    g_carrier = & copy.carrier();
+    g_mergers.clear();
+    copy.carrier().set_merge_callback(record_merge);
+    copy.carrier().ensure_equal(lhs, rhs);
+    process_mergers(copy.signature());
+    copy.carrier().set_merge_callback(nullptr);
+
+    std::vector<Ob> reps(1 + ITEM_COUNT);
+    for (Ob ob = 1; ob <= ITEM_COUNT; ++ob) {
+        reps[ob] = ob;
+    }
+    auto find = [&](Ob ob){
+        while (reps[ob] != ob) { ob = reps[ob]; }
+        return ob;
+    };
+    for (const auto & merger : g_mergers) {
+        Ob dep = find(merger.first);
+        Ob rep = find(merger.second);
+        reps[max(dep, rep)] = min(dep, rep);
+    }
+    for (Ob ob = 1; ob <= ITEM_COUNT; ++ob) {
+        POMAGMA_ASSERT_EQ(snapshot.find(ob), find(ob));
+        bool is_rep = snapshot.find(ob) == ob;
+        POMAGMA_ASSERT_EQ(is_rep, copy.carrier().contains(ob));
+    }
+
+    compact(copy);
+    copy.validate();
+    std::vector<float> expected_probs;
+    {
+        Router router(copy.signature(), language);
+        expected_probs = router.measure_probs(reltol);
+    }
+
+    const auto actual = sorted_nonzero(actual_probs);
+    const auto expected = sorted_nonzero(expected_probs);
+    POMAGMA_ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        POMAGMA_ASSERT_LE(fabs(actual[i] - expected[i]), 1e-3 * expected[i]);
+    }
+}
+
+void test_contradicts (size_t seed)
+{
+    POMAGMA_INFO("Testing snapshot contradictions");
+    Structure structure;
+    init_structure(structure, seed);
+    BinaryRelation & NLESS = structure.binary_relation("NLESS");
+    BinaryFunction & APP = structure.binary_function("APP");
+
+    // find a congruence APP x z, APP y z with distinct values
+    Ob x = 0, y = 0, z = 0;
+    for (Ob i = 1; i <= ITEM_COUNT and not z; ++i)
+    for (Ob j = i + 1; j <= ITEM_COUNT and not z; ++j)
+    for (Ob k = 1; k <= ITEM_COUNT and not z; ++k) {
+        Ob u = APP.find(i, k);
+        Ob v = APP.find(j, k);
+        if (u and v and u != v) {
+            x = i;
+            y = j;
+            z = k;
+        }
+    }
+    POMAGMA_ASSERT(z, "no congruence found");
+    const Ob u = APP.find(x, z);
+    const Ob v = APP.find(y, z);
+
+    {
+        Snapshot snapshot(structure);
+        POMAGMA_ASSERT(snapshot.ensure_equal(x, y),
+            "unexpected contradiction");
+        POMAGMA_ASSERT_EQ(snapshot.find(u), snapshot.find(v));
+    }
+
+    RefutationCache refuted;
+    refuted.insert(u, v);
+    {
+        Snapshot snapshot(structure, & refuted);
+        POMAGMA_ASSERT(not snapshot.ensure_equal(x, y),
+            "missed refutation between merged values");
+    }
+
+    NLESS.insert(v, u);
+    {
+        Snapshot snapshot(structure);
+        POMAGMA_ASSERT(not snapshot.ensure_equal(u, v), "missed NLESS");
+    }
+    {
+        Snapshot snapshot(structure);
+        POMAGMA_ASSERT(not snapshot.ensure_equal(x, y),
+            "missed NLESS between merged values");
+    }
+}
+
+int main ()
+{
+    Log::Context log_context("Running Snapshot Test");
+
+    std::uniform_int_distribution<Ob> random_ob(1, ITEM_COUNT);
+    for (size_t seed = 0; seed < 8; ++seed) {
+        Ob lhs = random_ob(rng);
+        Ob rhs = random_ob(rng);
+        test_merge(seed, lhs, rhs);
+    }
+    for (size_t seed = 0; seed < 4; ++seed) {
+        test_contradicts(seed);
+    }
+
+    return 0;
+}
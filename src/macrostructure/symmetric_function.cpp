@@ -109,4 +109,44 @@ void SymmetricFunction::unsafe_merge (const Ob dep)
     // values must be updated in batch by update_values
 }
 
+void SymmetricFunction::unsafe_merge (
+        const std::vector<Ob> & deps,
+        std::vector<std::pair<Ob, Ob>> & equations)
+{
+    // remove all triples with a dep argument
+    std::vector<std::pair<std::pair<Ob, Ob>, Ob>> moved;
+    for (Ob dep : deps) {
+        POMAGMA_ASSERT5(support().contains(dep), "unsupported dep: " << dep);
+        POMAGMA_ASSERT4(carrier().find(dep) != dep, "self merge: " << dep);
+
+        for (auto iter = iter_lhs(dep); iter.ok(); iter.next()) {
+            Ob rhs = *iter;
+            auto dep_iter = m_values.find(make_sorted_pair(dep, rhs));
+            moved.push_back(* dep_iter);
+            m_values.erase(dep_iter);
+            m_lines.Rx(dep, rhs).zero();
+        }
+        DenseSet(item_dim(), m_lines.Lx(dep)).zero();
+    }
+
+    // reinsert them at reps
+    for (const auto & triple : moved) {
+        Ob lhs = carrier().find(triple.first.first);
+        Ob rhs = carrier().find(triple.first.second);
+        Ob dep_val = triple.second;
+        Ob & rep_val = m_values[make_sorted_pair(lhs, rhs)];
+        if (rep_val) {
+            if (rep_val != dep_val) {
+                equations.push_back(std::make_pair(rep_val, dep_val));
+            }
+        } else {
+            rep_val = dep_val;
+            m_lines.Lx(lhs, rhs).one();
+            m_lines.Rx(lhs, rhs).one();
+        }
+    }
+
+    // values must be updated in batch by update_values
+}
+
 } // namespace pomagma
@@ -54,6 +54,7 @@ int main ()
 {
     Log::Context log_context("SymmetricFunction Test");
     test_function<Example>(rng);
+    test_batch_merge<SymmetricFunction>(rng, gcd);
 
     return 0;
 }
@@ -21,9 +21,9 @@ base_bin_rel_<symmetric>::base_bin_rel_ (const Carrier & carrier)
     POMAGMA_ASSERT(m_round_item_dim <= MAX_ITEM_DIM,
             "base_bin_rel_ is too large");
 
-    bzero(m_Lx_lines, sizeof(Word) * m_data_size_words);
+    zero_blocks(m_Lx_lines, m_data_size_words);
     if (not symmetric) {
-        bzero(m_Rx_lines, sizeof(Word) * m_data_size_words);
+        zero_blocks(m_Rx_lines, m_data_size_words);
     }
 }
 
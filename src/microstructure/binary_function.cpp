@@ -11,25 +11,18 @@ BinaryFunction::BinaryFunction (
         const Carrier & carrier,
         void (*insert_callback) (const BinaryFunction *, Ob, Ob))
     : m_lines(carrier),
-      m_tile_dim((item_dim() + ITEMS_PER_TILE) / ITEMS_PER_TILE),
-      m_tiles(alloc_blocks<Tile>(m_tile_dim * m_tile_dim)),
+      m_values(item_dim()),
       m_Vlr_table(1 + item_dim()),
+      m_VLr_table(1 + item_dim()),
+      m_VRl_table(1 + item_dim()),
       m_insert_callback(insert_callback ? insert_callback : noop_callback)
 {
     POMAGMA_DEBUG("creating BinaryFunction with "
-            << (m_tile_dim * m_tile_dim) << " tiles");
-
-    std::atomic<Ob> * obs = & m_tiles[0][0];
-    size_t ob_dim = m_tile_dim * ITEMS_PER_TILE;
-    construct_blocks(obs, ob_dim * ob_dim, 0);
+            << m_values.tile_count() << " tiles");
 }
 
 BinaryFunction::~BinaryFunction ()
 {
-    std::atomic<Ob> * obs = &m_tiles[0][0];
-    size_t ob_dim = m_tile_dim * ITEMS_PER_TILE;
-    destroy_blocks(obs, ob_dim * ob_dim);
-    free_blocks(m_tiles);
 }
 
 void BinaryFunction::validate () const
@@ -41,28 +34,19 @@ void BinaryFunction::validate () const
     m_lines.validate();
 
     POMAGMA_DEBUG("validating line-tile consistency");
-    for (size_t i_ = 0; i_ < m_tile_dim; ++i_)
-    for (size_t j_ = 0; j_ < m_tile_dim; ++j_) {
-        const std::atomic<Ob> * tile = _tile(i_, j_);
-
-        for (size_t _i = 0; _i < ITEMS_PER_TILE; ++_i)
-        for (size_t _j = 0; _j < ITEMS_PER_TILE; ++_j) {
-            size_t i = i_ * ITEMS_PER_TILE + _i;
-            size_t j = j_ * ITEMS_PER_TILE + _j;
-            if (i == 0 or item_dim() < i) continue;
-            if (j == 0 or item_dim() < j) continue;
-            Ob val = _tile2value(tile, _i, _j);
-
-            if (not (support().contains(i) and support().contains(j))) {
-                POMAGMA_ASSERT(not val,
-                        "found unsupported val: " << i << ',' << j);
-            } else if (val) {
-                POMAGMA_ASSERT(defined(i, j),
-                        "found unsupported value: " << i << ',' << j);
-            } else {
-                POMAGMA_ASSERT(not defined(i, j),
-                        "found supported null value: " << i << ',' << j);
-            }
+    for (size_t i = 1; i <= item_dim(); ++i)
+    for (size_t j = 1; j <= item_dim(); ++j) {
+        Ob val = m_values(i, j).load(relaxed);
+
+        if (not (support().contains(i) and support().contains(j))) {
+            POMAGMA_ASSERT(not val,
+                    "found unsupported val: " << i << ',' << j);
+        } else if (val) {
+            POMAGMA_ASSERT(defined(i, j),
+                    "found unsupported value: " << i << ',' << j);
+        } else {
+            POMAGMA_ASSERT(not defined(i, j),
+                    "found supported null value: " << i << ',' << j);
         }
     }
 
@@ -113,7 +97,7 @@ void BinaryFunction::clear ()
 {
     memory_barrier();
     m_lines.clear();
-    zero_blocks(m_tiles, m_tile_dim * m_tile_dim);
+    m_values.clear();
     m_Vlr_table.clear();
     m_VLr_table.clear();
     m_VRl_table.clear();
@@ -2,6 +2,7 @@
 
 #include "util.hpp"
 #include "base_bin_rel.hpp"
+#include "tiles.hpp"
 #include "inverse_bin_fun.hpp"
 #include <pomagma/platform/concurrent/dense_set.hpp>
 
@@ -11,9 +12,12 @@ namespace pomagma
 // a tight binary function tiled in blocks
 class BinaryFunction : noncopyable
 {
+    // large column-major tiles serve both row and column scans best,
+    // see binary_function_profile.cpp
+    typedef TiledValues<5, COLUMN_MAJOR> Values;
+
     mutable base_bin_rel m_lines;
-    const size_t m_tile_dim;
-    Tile * const m_tiles;
+    Values m_values;
     Vlr_Table m_Vlr_table;
     VLr_Table m_VLr_table;
     VRl_Table m_VRl_table;
@@ -41,7 +45,7 @@ public:
     void clear ();
 
     // relaxed operations
-    // m_tiles is source of truth; m_lines lag
+    // m_values is source of truth; m_lines lag
     DenseSet get_Lx_set (Ob lhs) const { return m_lines.Lx_set(lhs); }
     DenseSet get_Rx_set (Ob rhs) const { return m_lines.Rx_set(rhs); }
     bool defined (Ob lhs, Ob rhs) const;
@@ -63,7 +67,6 @@ private:
     size_t item_dim () const { return support().item_dim(); }
 
     std::atomic<Ob> & value (Ob lhs, Ob rhs) const;
-    std::atomic<Ob> * _tile (size_t i_, size_t j_) const;
 };
 
 inline bool BinaryFunction::defined (Ob lhs, Ob rhs) const
@@ -73,17 +76,11 @@ inline bool BinaryFunction::defined (Ob lhs, Ob rhs) const
     return m_lines.get_Lx(lhs, rhs);
 }
 
-inline std::atomic<Ob> * BinaryFunction::_tile (size_t i_, size_t j_) const
-{
-    return m_tiles[m_tile_dim * j_ + i_];
-}
-
 inline std::atomic<Ob> & BinaryFunction::value (Ob i, Ob j) const
 {
     POMAGMA_ASSERT5(support().contains(i), "unsupported lhs: " << i);
     POMAGMA_ASSERT5(support().contains(j), "unsupported rhs: " << j);
-    std::atomic<Ob> * tile = _tile(i / ITEMS_PER_TILE, j / ITEMS_PER_TILE);
-    return _tile2value(tile, i & TILE_POS_MASK, j & TILE_POS_MASK);
+    return m_values(i, j);
 }
 
 inline DenseSet::Iterator BinaryFunction::iter_lhs (Ob lhs) const
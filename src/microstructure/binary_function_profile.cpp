@@ -0,0 +1,97 @@
+#include "tiles.hpp"
+#include <pomagma/platform/threading.hpp>
+#include <vector>
+
+using namespace pomagma;
+
+rng_t rng;
+
+// times row scans (fixed lhs) and column scans (fixed rhs) over a sparse
+// support, as in compiled rules iterating iter_lhs or iter_rhs with find
+template<class Values>
+void profile_layout (
+        const std::string & name,
+        size_t item_dim,
+        const std::vector<Ob> & support,
+        size_t iters = 4)
+{
+    Values values(item_dim);
+    for (Ob i : support) {
+        for (Ob j : support) {
+            values(i, j).store(1 + (i * j) % item_dim, relaxed);
+        }
+    }
+
+    size_t row_sum = 0;
+    Timer row_timer;
+    for (size_t iter = 0; iter < iters; ++iter) {
+        for (Ob lhs : support) {
+            for (Ob rhs : support) {
+                row_sum += values(lhs, rhs).load(relaxed);
+            }
+        }
+    }
+    double row_rate = iters * support.size() / row_timer.elapsed();
+
+    size_t col_sum = 0;
+    Timer col_timer;
+    for (size_t iter = 0; iter < iters; ++iter) {
+        for (Ob rhs : support) {
+            for (Ob lhs : support) {
+                col_sum += values(lhs, rhs).load(relaxed);
+            }
+        }
+    }
+    double col_rate = iters * support.size() / col_timer.elapsed();
+
+    POMAGMA_ASSERT_EQ(row_sum, col_sum);
+    POMAGMA_INFO(std::setw(20) << name <<
+                 std::setw(15) << (values.byte_count() >> 20) <<
+                 std::setw(15) << (row_rate / 1000) <<
+                 std::setw(15) << (col_rate / 1000));
+}
+
+void profile_layouts (size_t item_dim, rng_t & rng)
+{
+    const float density = 0.25;
+    std::bernoulli_distribution randomly_support(density);
+    std::vector<Ob> support;
+    for (Ob i = 1; i <= item_dim; ++i) {
+        if (randomly_support(rng)) {
+            support.push_back(i);
+        }
+    }
+
+    POMAGMA_INFO("item_dim = " << item_dim << ", density = " << density);
+    POMAGMA_INFO(std::setw(20) << "layout" <<
+                 std::setw(15) << "size (MB)" <<
+                 std::setw(15) << "rows (kHz)" <<
+                 std::setw(15) << "cols (kHz)");
+    profile_layout<TiledValues<2, COLUMN_MAJOR>>(
+        "4x4 column-major", item_dim, support);
+    profile_layout<TiledValues<2, Z_ORDER>>(
+        "4x4 z-order", item_dim, support);
+    profile_layout<TiledValues<3, COLUMN_MAJOR>>(
+        "8x8 column-major", item_dim, support);
+    profile_layout<TiledValues<3, Z_ORDER>>(
+        "8x8 z-order", item_dim, support);
+    profile_layout<TiledValues<4, COLUMN_MAJOR>>(
+        "16x16 column-major", item_dim, support);
+    profile_layout<TiledValues<4, Z_ORDER>>(
+        "16x16 z-order", item_dim, support);
+    profile_layout<TiledValues<5, COLUMN_MAJOR>>(
+        "32x32 column-major", item_dim, support);
+    profile_layout<TiledValues<5, Z_ORDER>>(
+        "32x32 z-order", item_dim, support);
+}
+
+int main ()
+{
+    Log::Context log_context("microstructure BinaryFunction profile");
+
+    // tables of 128MB and 512MB
+    profile_layouts(MAX_ITEM_DIM >> 3, rng);
+    profile_layouts(MAX_ITEM_DIM >> 2, rng);
+
+    return 0;
+}
@@ -9,9 +9,11 @@ static void noop_callback (Ob, Ob) {}
 
 BinaryRelation::BinaryRelation (
         const Carrier & carrier,
-        void (*insert_callback) (Ob, Ob))
+        void (*insert_callback) (Ob, Ob),
+        void (*insert_row_callback) (Ob, const DenseSet &))
     : m_lines(carrier),
-      m_insert_callback(insert_callback ? insert_callback : noop_callback)
+      m_insert_callback(insert_callback ? insert_callback : noop_callback),
+      m_insert_row_callback(insert_row_callback)
 {
     POMAGMA_DEBUG("creating BinaryRelation with "
             << round_word_dim() << " words");
@@ -112,9 +114,18 @@ void BinaryRelation::insert (Ob i, const DenseSet & js)
     DenseSet diff(item_dim());
     DenseSet dest(item_dim(), m_lines.Lx(i));
     if (dest.ensure(js, diff)) {
-        for (auto k = diff.iter(); k.ok(); k.next()) {
-            _insert_Rx(i, *k);
-            m_insert_callback(i, *k);
+        _insert_Rx(i, diff);
+        _row_callback(i, diff);
+    }
+}
+
+void BinaryRelation::_row_callback (Ob i, const DenseSet & js) const
+{
+    if (m_insert_row_callback) {
+        m_insert_row_callback(i, js);
+    } else {
+        for (auto j = js.iter(); j.ok(); j.next()) {
+            m_insert_callback(i, *j);
         }
     }
 }
@@ -147,6 +158,16 @@ void BinaryRelation::_remove_Lx (const DenseSet & is, Ob j)
     }
 }
 
+void BinaryRelation::_insert_Rx (Ob i, const DenseSet & js)
+{
+    Word mask = Word(1) << (i % BITS_PER_WORD);
+    size_t offset = i / BITS_PER_WORD;
+    std::atomic<Word> * lines = m_lines.Rx() + offset;
+    for (auto j = js.iter(); j.ok(); j.next()) {
+         lines[*j * round_word_dim()].fetch_or(mask, relaxed);
+    }
+}
+
 void BinaryRelation::_remove_Rx (Ob i, const DenseSet& js)
 {
     // slower version
@@ -180,10 +201,8 @@ void BinaryRelation::unsafe_merge (Ob i)
     _remove_Rx(i, dep);
     rep.init(m_lines.Lx(j));
     if (rep.merge(dep, diff)) {
-        for (auto k = diff.iter(); k.ok(); k.next()) {
-            _insert_Rx(j, *k);
-            m_insert_callback(j, *k);
-        }
+        _insert_Rx(j, diff);
+        _row_callback(j, diff);
     }
 
     // merge cols (_, i) into (_, j)
@@ -12,6 +12,7 @@ class BinaryRelation : noncopyable
 {
     mutable base_bin_rel m_lines;
     void (*m_insert_callback) (Ob, Ob);
+    void (*m_insert_row_callback) (Ob, const DenseSet &);
 
     mutable SharedMutex m_mutex;
     typedef SharedMutex::SharedLock SharedLock;
@@ -19,9 +20,12 @@ class BinaryRelation : noncopyable
 
 public:
 
+    // insert_row_callback receives only newly inserted pairs of a row;
+    // if null, insert_callback is called once per pair instead
     BinaryRelation (
         const Carrier & carrier,
-        void (*insert_callback) (Ob, Ob) = nullptr);
+        void (*insert_callback) (Ob, Ob) = nullptr,
+        void (*insert_row_callback) (Ob, const DenseSet &) = nullptr);
     ~BinaryRelation ();
     void validate () const;
     void validate_disjoint (const BinaryRelation & other) const;
@@ -47,7 +51,7 @@ public:
     void insert_Lx (Ob i, Ob j);
     void insert_Rx (Ob i, Ob j);
     void insert (Ob i, Ob j) { return insert_Lx(i, j); }
-    void insert (Ob i, const DenseSet & js);
+    void insert (Ob i, const DenseSet & js); // bulk, by whole words
     void insert (const DenseSet & is, Ob j);
 
     // strict operations
@@ -71,6 +75,8 @@ private:
     void _remove_Rx (Ob i, Ob j) { m_lines.Rx(i, j).zero(); }
     void _remove_Lx (const DenseSet & is, Ob i);
     void _remove_Rx (Ob i, const DenseSet & js);
+    void _insert_Rx (Ob i, const DenseSet & js);
+    void _row_callback (Ob i, const DenseSet & js) const;
 };
 
 inline DenseSet::Iterator BinaryRelation::iter_lhs (Ob lhs) const
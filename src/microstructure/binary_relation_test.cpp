@@ -12,6 +12,12 @@ void move_to (Ob i __attribute__((unused)), Ob j __attribute__((unused)))
     ++g_num_moved;
 }
 
+size_t g_num_row_pairs(0);
+void insert_row (Ob i __attribute__((unused)), const DenseSet & js)
+{
+    g_num_row_pairs += js.count_items();
+}
+
 bool test_fun1 (Ob i, Ob j) { return i and j and i % 61u <= j % 31u; }
 bool test_fun2 (Ob i, Ob j) { return i and j and i % 61u == j % 31u; }
 
@@ -76,6 +82,27 @@ void test_BinaryRelation (
     rel.validate();
     POMAGMA_ASSERT_EQ(num_pairs, rel.count_pairs());
 
+    POMAGMA_INFO("testing row insertion");
+    {
+        BinaryRelation row_rel(carrier, nullptr, insert_row);
+        DenseSet js(size);
+        g_num_row_pairs = 0;
+        for (size_t repeat = 0; repeat < 2; ++repeat) {
+            for (auto i = support.iter(); i.ok(); i.next()) {
+                js.zero();
+                for (auto j = support.iter(); j.ok(); j.next()) {
+                    if (test_fun(*i, *j)) {
+                        js.insert(*j);
+                    }
+                }
+                row_rel.insert(*i, js);
+            }
+        }
+        row_rel.validate();
+        POMAGMA_ASSERT_EQ(g_num_row_pairs, num_pairs);
+        POMAGMA_ASSERT_EQ(row_rel.count_pairs(), num_pairs);
+    }
+
     POMAGMA_INFO("testing position merging");
     for (Ob i = 1; i <= size / 3; ++i) {
         if (i % 3) continue;
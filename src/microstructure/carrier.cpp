@@ -11,7 +11,7 @@ Carrier::Carrier (
         size_t item_dim,
         void (*insert_callback) (Ob),
         void (*merge_callback) (Ob))
-    : m_support(item_dim),
+    : m_support(item_dim, DenseSet::SUMMARIZED),
       m_item_count(0),
       m_rep_count(0),
       m_reps(alloc_blocks<Rep>(1 + item_dim)),
@@ -51,10 +51,12 @@ Ob Carrier::try_insert () const
     SharedLock lock(m_mutex);
 
     while (item_count() < item_dim()) {
-        for (Ob ob = 1, end = item_dim(); ob <= end; ++ob) {
+        // the support's summary skips full lines; obs whose reps are claimed
+        // but not yet supported are skipped by the failing CAS
+        for (Ob ob = m_support.find_absent(); ob;
+            ob = m_support.find_absent(ob + 1))
+        {
             Ob zero = 0;
-            // This could be optimized using m_support iteration.
-            // See DenseSet::try_insert for example low-level code.
             bool inserted = m_reps[ob].compare_exchange_strong(
                     zero,
                     ob,
@@ -131,21 +133,6 @@ Ob Carrier::merge (Ob dep, Ob rep) const
     return rep;
 }
 
-Ob Carrier::_find (Ob ob, Ob rep) const
-{
-    Ob rep_rep = find(rep);
-    if (m_reps[ob].compare_exchange_weak(
-                rep,
-                rep_rep,
-                std::memory_order_acq_rel,
-                std::memory_order_acquire))
-    {
-        return rep_rep;
-    } else {
-        return rep < rep_rep ? rep : rep_rep;
-    }
-}
-
 void Carrier::validate () const
 {
     UniqueLock lock(m_mutex);
@@ -4,6 +4,7 @@
 #include <pomagma/platform/concurrent/dense_set.hpp>
 #include <pomagma/platform/threading.hpp>
 #include <atomic>
+#include <vector>
 
 namespace pomagma
 {
@@ -46,6 +47,12 @@ public:
 
     // relaxed operations
     Ob find (Ob ob) const;
+    // replaces each ob by its rep, locking once for the whole batch
+    void find_many (Ob * obs, size_t count) const;
+    void find_many (std::vector<Ob> & obs) const
+    {
+        find_many(obs.data(), obs.size());
+    }
     bool equal (Ob lhs, Ob rhs) const;
     Ob merge (Ob dep, Ob rep) const;
     Ob ensure_equal (Ob lhs, Ob rhs) const;
@@ -62,7 +69,7 @@ public:
 
 private:
 
-    Ob _find (Ob ob, Ob rep) const;
+    Ob _find (Ob ob) const;
 };
 
 inline void Carrier::raw_insert (Ob ob)
@@ -71,13 +78,42 @@ inline void Carrier::raw_insert (Ob ob)
     m_reps[ob].store(ob, relaxed);
 }
 
+// Finds by lock-free path halving: each step points an ob at its grandparent.
+// Reps only ever decrease, so a failed CAS means another thread has already
+// shortened the path, and any ancestor is still a valid rep.
+inline Ob Carrier::_find (Ob ob) const
+{
+    POMAGMA_ASSERT5(contains(ob), "tried to find unsupported object " << ob);
+
+    Ob rep = m_reps[ob].load(std::memory_order_acquire);
+    while (rep != ob) {
+        Ob rep_rep = m_reps[rep].load(std::memory_order_acquire);
+        if (rep_rep == rep) {
+            return rep;
+        }
+        m_reps[ob].compare_exchange_weak(
+            rep,
+            rep_rep,
+            std::memory_order_acq_rel,
+            std::memory_order_relaxed);
+        ob = rep_rep;
+        rep = m_reps[ob].load(std::memory_order_acquire);
+    }
+    return ob;
+}
+
 inline Ob Carrier::find (Ob ob) const
 {
     SharedLock lock(m_mutex);
-    POMAGMA_ASSERT5(contains(ob), "tried to find unsupported object " << ob);
+    return _find(ob);
+}
 
-    Ob rep = m_reps[ob].load(std::memory_order_relaxed);
-    return rep == ob ? ob : _find(ob, rep);
+inline void Carrier::find_many (Ob * obs, size_t count) const
+{
+    SharedLock lock(m_mutex);
+    for (size_t i = 0; i < count; ++i) {
+        obs[i] = _find(obs[i]);
+    }
 }
 
 inline bool Carrier::equal (Ob lhs, Ob rhs) const
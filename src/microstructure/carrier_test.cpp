@@ -28,6 +28,18 @@ void test_random (size_t size)
         carrier.validate();
     }
 
+    std::vector<Ob> obs;
+    for (size_t i = 1; i <= size; ++i) {
+        obs.push_back(i);
+    }
+    carrier.find_many(obs);
+    for (size_t i = 1; i <= size; ++i) {
+        Ob rep = carrier.find(i);
+        POMAGMA_ASSERT_EQ(obs[i - 1], rep);
+        POMAGMA_ASSERT_EQ(carrier.find(rep), rep);
+        POMAGMA_ASSERT_LE(rep, i);
+    }
+
     std::bernoulli_distribution randomly_remove(0.5);
     for (size_t i = 1; i <= size; ++i) {
         if (randomly_remove(rng)) {
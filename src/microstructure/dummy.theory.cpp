@@ -13,6 +13,8 @@ DEF_EXECUTE(MergeTask)
 DEF_EXECUTE(ExistsTask)
 DEF_EXECUTE(PositiveOrderTask)
 DEF_EXECUTE(NegativeOrderTask)
+DEF_EXECUTE(PositiveOrderRowTask)
+DEF_EXECUTE(NegativeOrderRowTask)
 DEF_EXECUTE(NullaryFunctionTask)
 DEF_EXECUTE(InjectiveFunctionTask)
 DEF_EXECUTE(BinaryFunctionTask)
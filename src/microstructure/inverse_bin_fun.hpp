@@ -1,10 +1,10 @@
 #pragma once
 
 #include "util.hpp"
+#include <pomagma/platform/threading.hpp>
 #include <vector>
 #include <utility>
-#include <tbb/concurrent_unordered_map.h>
-#include <tbb/concurrent_unordered_set.h>
+#include <mutex>
 
 namespace pomagma
 {
@@ -14,94 +14,496 @@ namespace detail
 
 static const size_t HASH_MULTIPLIER = 11400714819323198485ULL;
 
-template<class smallint_t>
-struct small_pair_hasher;
+//----------------------------------------------------------------------------
+// Keys
+//
+// Keys pack two obs into the halves of a uint32_t. Since obs are nonzero,
+// keys have nonzero high halves, leaving small values free for sentinels.
 
-template<>
-struct small_pair_hasher<uint16_t>
+static_assert(sizeof(Ob) == 2, "inverse keys assume 16-bit obs");
+
+static const uint32_t EMPTY_KEY = 0;
+static const uint32_t FROZEN_KEY = 1;
+
+inline uint32_t pack_key (Ob high, Ob low = 0)
+{
+    return (uint32_t(high) << 16) | low;
+}
+inline Ob key_high (uint32_t key) { return key >> 16; }
+inline Ob key_low (uint32_t key) { return key & 0xFFFF; }
+
+//----------------------------------------------------------------------------
+// Tables
+//
+// Open-addressing tables with linear probing, at most half full.
+// Slots are claimed from EMPTY_KEY by CAS, so inserts are lock-free except
+// while a table grows. Growth freezes the remaining empty slots of the old
+// table, so that racing inserts retry in the new table. Old tables may still
+// be read by concurrent iterators, so they are retired and only freed by the
+// next unsafe operation. Unsafe removal uses backward-shift deletion.
+
+struct KeyTable : noncopyable
+{
+    const size_t mask;
+    const size_t shift;
+    std::atomic<size_t> size;
+    std::atomic<uint32_t> * const keys;
+    std::atomic<void *> * const values; // null unless mapped
+
+    KeyTable (size_t capacity, bool mapped)
+        : mask(capacity - 1),
+          shift(64 - __builtin_ctzl(capacity)),
+          size(0),
+          keys(new std::atomic<uint32_t>[capacity]),
+          values(mapped ? new std::atomic<void *>[capacity] : nullptr)
+    {
+        POMAGMA_ASSERT1(capacity and not (capacity & mask),
+            "capacity is not a power of two: " << capacity);
+        for (size_t i = 0; i < capacity; ++i) {
+            keys[i].store(EMPTY_KEY, relaxed);
+        }
+        if (values) {
+            for (size_t i = 0; i < capacity; ++i) {
+                values[i].store(nullptr, relaxed);
+            }
+        }
+    }
+    ~KeyTable ()
+    {
+        delete[] keys;
+        delete[] values;
+    }
+
+    size_t capacity () const { return mask + 1; }
+    size_t home (uint32_t key) const
+    {
+        return (key * HASH_MULTIPLIER) >> shift;
+    }
+
+    // returns slot of key, or capacity() if absent
+    size_t find (uint32_t key) const
+    {
+        for (size_t i = home(key), probes = 0; probes <= mask; ++probes) {
+            uint32_t found = keys[i].load(std::memory_order_acquire);
+            if (found == key) {
+                return i;
+            }
+            if (found == EMPTY_KEY) {
+                break;
+            }
+            i = (i + 1) & mask;
+        }
+        return capacity();
+    }
+};
+
+class RetiredTables : noncopyable
+{
+    std::mutex m_mutex;
+    std::vector<KeyTable *> m_tables;
+
+public:
+
+    ~RetiredTables () { unsafe_clear(); }
+
+    void retire (KeyTable * table)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_tables.push_back(table);
+    }
+
+    void unsafe_clear ()
+    {
+        for (KeyTable * table : m_tables) {
+            delete table;
+        }
+        m_tables.clear();
+    }
+};
+
+// growth is rare, so tables share a few striped locks
+inline std::mutex & grow_mutex (const void * owner)
+{
+    static std::mutex s_mutexes[64];
+    return s_mutexes[(reinterpret_cast<uintptr_t>(owner) >> 4) % 64];
+}
+
+template<bool mapped>
+class BasicKeySet : noncopyable
+{
+protected:
+
+    enum { MIN_CAPACITY = 4 };
+
+    std::atomic<KeyTable *> m_table;
+
+    // returns table and slot of key, and whether it was newly inserted
+    KeyTable * _insert (
+            uint32_t key,
+            RetiredTables & retired,
+            size_t & slot,
+            bool & inserted)
+    {
+        POMAGMA_ASSERT5(key_high(key), "invalid key: " << key);
+        while (true) {
+            KeyTable * table = m_table.load(std::memory_order_acquire);
+            if (unlikely(not table or
+                    2 * (table->size.load(relaxed) + 1) > table->capacity()))
+            {
+                _grow(table, retired);
+                continue;
+            }
+
+            size_t i = table->home(key);
+            for (size_t probes = 0; probes <= table->mask; ++probes) {
+                uint32_t found = table->keys[i].load(std::memory_order_acquire);
+                if (found == EMPTY_KEY) {
+                    if (table->keys[i].compare_exchange_strong(
+                            found,
+                            key,
+                            std::memory_order_acq_rel,
+                            std::memory_order_acquire))
+                    {
+                        table->size.fetch_add(1, relaxed);
+                        slot = i;
+                        inserted = true;
+                        return table;
+                    }
+                }
+                if (found == key) {
+                    slot = i;
+                    inserted = false;
+                    return table;
+                }
+                if (found == FROZEN_KEY) {
+                    break;
+                }
+                i = (i + 1) & table->mask;
+            }
+
+            // the table is either frozen or overfull from racing inserts
+            _grow(table, retired);
+        }
+    }
+
+    void _grow (KeyTable * old_table, RetiredTables & retired)
+    {
+        std::unique_lock<std::mutex> lock(grow_mutex(this));
+        if (m_table.load(std::memory_order_acquire) != old_table) {
+            return; // another thread has grown the table
+        }
+
+        size_t capacity = MIN_CAPACITY;
+        if (old_table) {
+            capacity = 2 * old_table->capacity();
+            while (2 * old_table->size.load() >= capacity) {
+                capacity *= 2;
+            }
+        }
+        KeyTable * table = new KeyTable(capacity, mapped);
+
+        if (old_table) {
+            size_t size = 0;
+            for (size_t i = 0; i <= old_table->mask; ++i) {
+                uint32_t key = EMPTY_KEY;
+                if (old_table->keys[i].compare_exchange_strong(
+                        key,
+                        FROZEN_KEY,
+                        std::memory_order_acq_rel,
+                        std::memory_order_acquire))
+                {
+                    continue;
+                }
+                size_t j = table->home(key);
+                while (table->keys[j].load(relaxed) != EMPTY_KEY) {
+                    j = (j + 1) & table->mask;
+                }
+                table->keys[j].store(key, relaxed);
+                if (mapped) {
+                    // the inserting thread publishes the value just after
+                    // claiming the key
+                    void * value;
+                    while (not (value = old_table->values[i].load(
+                                    std::memory_order_acquire)))
+                    {
+                    }
+                    table->values[j].store(value, relaxed);
+                }
+                ++size;
+            }
+            table->size.store(size, relaxed);
+            retired.retire(old_table);
+        }
+
+        m_table.store(table, std::memory_order_release);
+    }
+
+    // strict: requires no concurrent access
+    void * _unsafe_remove (uint32_t key)
+    {
+        KeyTable * table = m_table.load(relaxed);
+        size_t i = table ? table->find(key) : 0;
+        POMAGMA_ASSERT1(table and i != table->capacity(),
+            "double erase: " << key_high(key) << "," << key_low(key));
+        void * value = mapped ? table->values[i].load(relaxed) : nullptr;
+
+        for (size_t j = (i + 1) & table->mask;; j = (j + 1) & table->mask) {
+            uint32_t other = table->keys[j].load(relaxed);
+            if (other == EMPTY_KEY) {
+                break;
+            }
+            // move other back unless its home lies cyclically in (i, j]
+            size_t h = table->home(other);
+            bool stays = i <= j ? (i < h and h <= j) : (i < h or h <= j);
+            if (not stays) {
+                table->keys[i].store(other, relaxed);
+                if (mapped) {
+                    table->values[i].store(table->values[j].load(relaxed));
+                }
+                i = j;
+            }
+        }
+        table->keys[i].store(EMPTY_KEY, relaxed);
+        if (mapped) {
+            table->values[i].store(nullptr, relaxed);
+        }
+        table->size.fetch_sub(1, relaxed);
+        return value;
+    }
+
+public:
+
+    BasicKeySet () : m_table(nullptr) {}
+    ~BasicKeySet () { delete m_table.load(); }
+
+    size_t size () const
+    {
+        const KeyTable * table = m_table.load(std::memory_order_acquire);
+        return table ? table->size.load(relaxed) : 0;
+    }
+    bool empty () const { return size() == 0; }
+
+    class Iterator
+    {
+        const KeyTable * m_table;
+        size_t m_slot;
+        uint32_t m_key;
+
+    public:
+
+        Iterator (const KeyTable * table) : m_table(table), m_slot(0)
+        {
+            if (m_table) {
+                m_key = m_table->keys[0].load(std::memory_order_acquire);
+                if (not key_high(m_key)) {
+                    next();
+                }
+            }
+        }
+
+        bool ok () const { return m_table; }
+        void next ()
+        {
+            POMAGMA_ASSERT_OK
+            do {
+                if (++m_slot == m_table->capacity()) {
+                    m_table = nullptr;
+                    return;
+                }
+                m_key = m_table->keys[m_slot].load(std::memory_order_acquire);
+            } while (not key_high(m_key));
+        }
+        uint32_t key () const { POMAGMA_ASSERT_OK return m_key; }
+    };
+
+    Iterator iter () const
+    {
+        return Iterator(m_table.load(std::memory_order_acquire));
+    }
+};
+
+class KeySet : public BasicKeySet<false>
 {
-    size_t operator() (const std::pair<uint16_t, uint16_t> & pair) const
+public:
+
+    bool contains (uint32_t key) const
     {
-        static_assert(sizeof(size_t) == 8, "invalid sizeof(size_t)");
-        size_t x = pair.first;
-        size_t y = pair.second;
-        return ((x << 16) | y) * HASH_MULTIPLIER;
+        const KeyTable * table = m_table.load(std::memory_order_acquire);
+        return table and table->find(key) != table->capacity();
+    }
+
+    // returns true if key was newly inserted
+    bool insert (uint32_t key, RetiredTables & retired)
+    {
+        size_t slot;
+        bool inserted;
+        _insert(key, retired, slot, inserted);
+        return inserted;
+    }
+
+    void unsafe_remove (uint32_t key) { _unsafe_remove(key); }
+    void unsafe_clear ()
+    {
+        delete m_table.load();
+        m_table.store(nullptr);
     }
 };
 
-template<>
-struct small_pair_hasher<uint32_t>
+// maps keys to KeySets, which are owned by the map
+class KeySetMap : public BasicKeySet<true>
 {
-    size_t operator() (const std::pair<uint32_t, uint32_t> & pair) const
+public:
+
+    ~KeySetMap () { unsafe_clear(); }
+
+    const KeySet * find (uint32_t key) const
+    {
+        const KeyTable * table = m_table.load(std::memory_order_acquire);
+        if (not table) {
+            return nullptr;
+        }
+        size_t slot = table->find(key);
+        return slot == table->capacity() ? nullptr : _wait(table, slot);
+    }
+    KeySet * find (uint32_t key)
+    {
+        const KeySetMap * self = this;
+        return const_cast<KeySet *>(self->find(key));
+    }
+
+    KeySet & find_or_insert (uint32_t key, RetiredTables & retired)
+    {
+        size_t slot;
+        bool inserted;
+        KeyTable * table = _insert(key, retired, slot, inserted);
+        if (inserted) {
+            KeySet * set = new KeySet();
+            table->values[slot].store(set, std::memory_order_release);
+            return * set;
+        } else {
+            return * _wait(table, slot);
+        }
+    }
+
+    void unsafe_remove (uint32_t key)
     {
-        static_assert(sizeof(size_t) == 8, "invalid sizeof(size_t)");
-        size_t x = pair.first;
-        size_t y = pair.second;
-        return ((x << 32) | y) * HASH_MULTIPLIER;
+        delete static_cast<KeySet *>(_unsafe_remove(key));
+    }
+    void unsafe_clear ()
+    {
+        if (KeyTable * table = m_table.load()) {
+            for (size_t i = 0; i <= table->mask; ++i) {
+                delete static_cast<KeySet *>(table->values[i].load());
+            }
+            delete table;
+            m_table.store(nullptr);
+        }
+    }
+
+private:
+
+    // a value is published just after its key is claimed
+    static KeySet * _wait (const KeyTable * table, size_t slot)
+    {
+        void * value;
+        while (not (value = table->values[slot].load(
+                        std::memory_order_acquire)))
+        {
+        }
+        return static_cast<KeySet *>(value);
     }
 };
 
 } // namespace detail
 
 // val -> lhs, rhs
-class Vlr_Table : noncopyable
+// symmetric tables store each unordered pair once and iterate both orders
+template<bool symmetric>
+class Vlr_Table_ : noncopyable
 {
-    typedef tbb::concurrent_unordered_set<
-            std::pair<Ob, Ob>,
-            detail::small_pair_hasher<Ob>>
-        Set;
-    typedef std::vector<Set> Data;
+    typedef std::vector<detail::KeySet> Data;
     mutable Data m_data;
+    mutable detail::RetiredTables m_retired;
+
+    static uint32_t key (Ob lhs, Ob rhs)
+    {
+        if (symmetric and rhs < lhs) {
+            std::swap(lhs, rhs);
+        }
+        return detail::pack_key(lhs, rhs);
+    }
 
 public:
 
-    Vlr_Table (size_t size) : m_data(size)
+    Vlr_Table_ (size_t size) : m_data(size)
     {
     }
 
     bool contains (Ob lhs, Ob rhs, Ob val) const
     {
-        const auto & lr_set = m_data[val];
-        return lr_set.find(std::make_pair(lhs, rhs)) != lr_set.end();
+        return m_data[val].contains(key(lhs, rhs));
     }
     void insert (Ob lhs, Ob rhs, Ob val) const
     {
-        m_data[val].insert(std::make_pair(lhs, rhs));
+        m_data[val].insert(key(lhs, rhs), m_retired);
     }
 
     void clear ()
     {
         for (auto & set : m_data) {
-            set.clear();
+            set.unsafe_clear();
         }
+        m_retired.unsafe_clear();
     }
-    Vlr_Table & unsafe_remove (Ob lhs, Ob rhs, Ob val)
+    Vlr_Table_<symmetric> & unsafe_remove (Ob lhs, Ob rhs, Ob val)
     {
-        m_data[val].unsafe_erase(std::make_pair(lhs, rhs));
+        m_data[val].unsafe_remove(key(lhs, rhs));
+        m_retired.unsafe_clear();
         return * this;
     }
-    Vlr_Table & unsafe_remove (Ob val)
+    Vlr_Table_<symmetric> & unsafe_remove (Ob val)
     {
-        m_data[val].clear();
+        m_data[val].unsafe_clear();
+        m_retired.unsafe_clear();
         return * this;
     }
 
     class Iterator
     {
-        friend class Vlr_Table;
+        friend class Vlr_Table_<symmetric>;
 
-        Set::const_iterator m_iter;
-        Set::const_iterator m_end;
+        detail::KeySet::Iterator m_iter;
+        bool m_swapped;
 
-        Iterator (const Set & set) : m_iter(set.begin()), m_end(set.end()) {}
+        Iterator (const detail::KeySet & set)
+            : m_iter(set.iter()),
+              m_swapped(false)
+        {
+        }
 
     public:
 
-        bool ok () const { return m_iter != m_end; }
-        void next () { ++m_iter; }
+        bool ok () const { return m_iter.ok(); }
+        void next ()
+        {
+            if (symmetric and not m_swapped and lhs() != rhs()) {
+                m_swapped = true;
+            } else {
+                m_swapped = false;
+                m_iter.next();
+            }
+        }
 
-        Ob lhs () const { POMAGMA_ASSERT_OK return m_iter->first; }
-        Ob rhs () const { POMAGMA_ASSERT_OK return m_iter->second; }
+        Ob lhs () const
+        {
+            uint32_t key = m_iter.key();
+            return m_swapped ? detail::key_low(key) : detail::key_high(key);
+        }
+        Ob rhs () const
+        {
+            uint32_t key = m_iter.key();
+            return m_swapped ? detail::key_high(key) : detail::key_low(key);
+        }
     };
 
     Iterator iter (Ob val) const { return Iterator(m_data[val]); }
@@ -110,9 +512,9 @@ public:
     void validate (const Fun * fun) const
     {
         for (Ob val = 1, end = m_data.size(); val < end; ++val) {
-            for (auto lhs_rhs : m_data[val]) {
-                Ob lhs = lhs_rhs.first;
-                Ob rhs = lhs_rhs.second;
+            for (auto iter = this->iter(val); iter.ok(); iter.next()) {
+                Ob lhs = iter.lhs();
+                Ob rhs = iter.rhs();
                 POMAGMA_ASSERT(fun->defined(lhs, rhs),
                     "unsupported keys: " << lhs << "," << rhs);
                 POMAGMA_ASSERT_EQ(fun->find(lhs, rhs), val);
@@ -121,52 +523,61 @@ public:
     }
 };
 
+typedef Vlr_Table_<false> Vlr_Table;
+typedef Vlr_Table_<true> Vlr_SymTable;
+
 // val, lhs -> rhs
 template<bool transpose>
 class VXx_Table : noncopyable
 {
-    typedef tbb::concurrent_unordered_set<Ob> Set;
-    typedef tbb::concurrent_unordered_map<
-            std::pair<Ob, Ob>,
-            Set,
-            detail::small_pair_hasher<Ob>>
-        Data;
+    typedef std::vector<detail::KeySetMap> Data;
     mutable Data m_data;
+    mutable detail::RetiredTables m_retired;
 
 public:
 
+    VXx_Table (size_t size) : m_data(size)
+    {
+    }
+
     bool contains (Ob lhs, Ob rhs, Ob val) const
     {
         Ob fixed = transpose ? rhs : lhs;
         Ob moving = transpose ? lhs : rhs;
-        Data::const_iterator i = m_data.find(std::make_pair(val, fixed));
-        if (i == m_data.end()) {
-            return false;
-        }
-        return i->second.find(moving) != i->second.end();
+        const detail::KeySet * set =
+            m_data[val].find(detail::pack_key(fixed));
+        return set and set->contains(detail::pack_key(moving));
     }
     void insert (Ob lhs, Ob rhs, Ob val) const
     {
         Ob fixed = transpose ? rhs : lhs;
         Ob moving = transpose ? lhs : rhs;
-        m_data[std::make_pair(val, fixed)].insert(moving);
+        m_data[val]
+            .find_or_insert(detail::pack_key(fixed), m_retired)
+            .insert(detail::pack_key(moving), m_retired);
     }
 
     void clear ()
     {
-        m_data.clear();
+        for (auto & map : m_data) {
+            map.unsafe_clear();
+        }
+        m_retired.unsafe_clear();
     }
     VXx_Table<transpose> & unsafe_remove (Ob lhs, Ob rhs, Ob val)
     {
         Ob fixed = transpose ? rhs : lhs;
         Ob moving = transpose ? lhs : rhs;
-        Data::const_iterator i = m_data.find(std::make_pair(val, fixed));
-        POMAGMA_ASSERT1(i != m_data.end(),
+        detail::KeySetMap & map = m_data[val];
+        const uint32_t fixed_key = detail::pack_key(fixed);
+        detail::KeySet * set = map.find(fixed_key);
+        POMAGMA_ASSERT1(set,
                 "double erase: " << val << "," << lhs << "," << rhs);
-        i->second.unsafe_erase(moving);
-        if (i->second.empty()) {
-            m_data.unsafe_erase(i);
+        set->unsafe_remove(detail::pack_key(moving));
+        if (set->empty()) {
+            map.unsafe_remove(fixed_key);
         }
+        m_retired.unsafe_clear();
         return * this;
     }
 
@@ -174,47 +585,45 @@ public:
     {
         friend class VXx_Table<transpose>;
 
-        Set::const_iterator m_iter;
-        Set::const_iterator m_end;
+        detail::KeySet::Iterator m_iter;
 
-        Iterator (const Data & data, Ob val, Ob fixed)
+        Iterator (const detail::KeySet * set)
+            : m_iter(set ? set->iter() : detail::KeySet::Iterator(nullptr))
         {
-            Data::const_iterator i = data.find(std::make_pair(val, fixed));
-            if (i != data.end()) {
-                m_iter = i->second.begin();
-                m_end = i->second.end();
-            } else {
-                m_iter = m_end;
-                POMAGMA_ASSERT6(not (m_iter != m_end),
-                    "default constructed iterators do not equality compare");
-            }
         }
 
     public:
 
-        bool ok () const { return m_iter != m_end; }
-        void next () { ++m_iter; }
+        bool ok () const { return m_iter.ok(); }
+        void next () { m_iter.next(); }
 
-        Ob operator * () const { POMAGMA_ASSERT_OK return *m_iter; }
+        Ob operator * () const { return detail::key_high(m_iter.key()); }
     };
 
     Iterator iter (Ob val, Ob fixed) const
     {
-        return Iterator(m_data, val, fixed);
+        return Iterator(m_data[val].find(detail::pack_key(fixed)));
     }
 
     template<class Fun>
     void validate (const Fun * fun) const
     {
-        for (const auto & val_fixed : m_data) {
-            Ob val = val_fixed.first.first;
-            Ob fixed = val_fixed.first.second;
-            for (Ob moving : val_fixed.second) {
-                Ob lhs = transpose ? moving : fixed;
-                Ob rhs = transpose ? fixed : moving;
-                POMAGMA_ASSERT(fun->defined(lhs, rhs),
-                    "unsupported keys: " << lhs << "," << rhs);
-                POMAGMA_ASSERT_EQ(fun->find(lhs, rhs), val);
+        for (Ob val = 1, end = m_data.size(); val < end; ++val) {
+            const detail::KeySetMap & map = m_data[val];
+            for (auto fixed_iter = map.iter(); fixed_iter.ok();
+                fixed_iter.next())
+            {
+                Ob fixed = detail::key_high(fixed_iter.key());
+                for (auto iter = this->iter(val, fixed); iter.ok();
+                    iter.next())
+                {
+                    Ob moving = * iter;
+                    Ob lhs = transpose ? moving : fixed;
+                    Ob rhs = transpose ? fixed : moving;
+                    POMAGMA_ASSERT(fun->defined(lhs, rhs),
+                        "unsupported keys: " << lhs << "," << rhs);
+                    POMAGMA_ASSERT_EQ(fun->find(lhs, rhs), val);
+                }
             }
         }
     }
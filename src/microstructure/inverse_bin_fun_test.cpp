@@ -0,0 +1,163 @@
+#include "inverse_bin_fun.hpp"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace pomagma;
+using namespace pomagma::detail;
+
+rng_t rng;
+
+uint32_t random_key (rng_t & rng, size_t high_dim)
+{
+    std::uniform_int_distribution<Ob> random_high(1, high_dim);
+    std::uniform_int_distribution<Ob> random_low(0, 0xFFFF);
+    return pack_key(random_high(rng), random_low(rng));
+}
+
+// each key appears twice, so that racing inserts collide
+std::vector<uint32_t> random_keys (rng_t & rng, size_t count)
+{
+    std::vector<uint32_t> keys;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t key = random_key(rng, 0xFFFF);
+        keys.push_back(key);
+        keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    return keys;
+}
+
+void check_key_set (const KeySet & set, const std::set<uint32_t> & expected)
+{
+    POMAGMA_ASSERT_EQ(set.size(), expected.size());
+    for (uint32_t key : expected) {
+        POMAGMA_ASSERT(set.contains(key), "missing key " << key);
+    }
+    std::set<uint32_t> actual;
+    for (auto iter = set.iter(); iter.ok(); iter.next()) {
+        POMAGMA_ASSERT(actual.insert(iter.key()).second,
+            "iterated twice over key " << iter.key());
+    }
+    POMAGMA_ASSERT(actual == expected, "iterated over wrong keys");
+}
+
+void test_key_set (rng_t & rng)
+{
+    POMAGMA_INFO("Testing KeySet");
+    KeySet set;
+    RetiredTables retired;
+    std::set<uint32_t> expected;
+    check_key_set(set, expected);
+
+    // each round grows the table through several capacities
+    for (size_t round = 0; round < 6; ++round) {
+        const std::vector<uint32_t> keys = random_keys(rng, 64 << round);
+        const size_t key_count = keys.size();
+        size_t new_count = 0;
+
+        #pragma omp parallel for schedule(dynamic, 16) reduction(+:new_count)
+        for (size_t i = 0; i < key_count; ++i) {
+            if (set.insert(keys[i], retired)) {
+                ++new_count;
+            }
+            POMAGMA_ASSERT(set.contains(keys[i]), "missing inserted key");
+        }
+
+        const size_t old_size = expected.size();
+        expected.insert(keys.begin(), keys.end());
+        POMAGMA_ASSERT_EQ(new_count, expected.size() - old_size);
+        check_key_set(set, expected);
+
+        std::bernoulli_distribution randomly_remove(0.5);
+        for (auto i = expected.begin(); i != expected.end();) {
+            if (randomly_remove(rng)) {
+                set.unsafe_remove(* i);
+                i = expected.erase(i);
+            } else {
+                ++i;
+            }
+        }
+        retired.unsafe_clear();
+        check_key_set(set, expected);
+    }
+
+    set.unsafe_clear();
+    expected.clear();
+    check_key_set(set, expected);
+}
+
+void test_key_set_map (rng_t & rng)
+{
+    POMAGMA_INFO("Testing KeySetMap");
+    KeySetMap map;
+    RetiredTables retired;
+    std::map<uint32_t, std::set<uint32_t>> expected;
+
+    for (size_t round = 0; round < 6; ++round) {
+        // few outer keys, so that inner sets also grow concurrently
+        std::vector<std::pair<uint32_t, uint32_t>> pairs;
+        for (uint32_t inner : random_keys(rng, 64 << round)) {
+            pairs.push_back(std::make_pair(pack_key(1 + inner % 31), inner));
+        }
+        const size_t pair_count = pairs.size();
+
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (size_t i = 0; i < pair_count; ++i) {
+            KeySet & set = map.find_or_insert(pairs[i].first, retired);
+            set.insert(pairs[i].second, retired);
+            POMAGMA_ASSERT(map.find(pairs[i].first) == & set,
+                "find disagrees with find_or_insert");
+        }
+
+        for (const auto & pair : pairs) {
+            expected[pair.first].insert(pair.second);
+        }
+        POMAGMA_ASSERT_EQ(map.size(), expected.size());
+        for (const auto & pair : expected) {
+            const KeySet * set = map.find(pair.first);
+            POMAGMA_ASSERT(set, "missing outer key " << pair.first);
+            check_key_set(* set, pair.second);
+        }
+
+        std::bernoulli_distribution randomly_remove(0.25);
+        for (auto i = expected.begin(); i != expected.end();) {
+            if (randomly_remove(rng)) {
+                map.unsafe_remove(i->first);
+                POMAGMA_ASSERT(not map.find(i->first), "failed to remove");
+                i = expected.erase(i);
+            } else {
+                KeySet & set = * map.find(i->first);
+                std::set<uint32_t> & inner = i->second;
+                for (auto j = inner.begin(); j != inner.end();) {
+                    if (randomly_remove(rng)) {
+                        set.unsafe_remove(* j);
+                        j = inner.erase(j);
+                    } else {
+                        ++j;
+                    }
+                }
+                check_key_set(set, inner);
+                ++i;
+            }
+        }
+        retired.unsafe_clear();
+        POMAGMA_ASSERT_EQ(map.size(), expected.size());
+    }
+
+    map.unsafe_clear();
+    POMAGMA_ASSERT(map.empty(), "map is not empty after clear");
+}
+
+int main ()
+{
+    Log::Context log_context("InverseBinFun Test");
+
+    for (size_t i = 0; i < 4; ++i) {
+        test_key_set(rng);
+        test_key_set_map(rng);
+    }
+
+    return 0;
+}
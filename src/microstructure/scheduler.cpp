@@ -17,7 +17,11 @@ namespace pomagma
 namespace Scheduler
 {
 
+// rows with fewer new pairs are cheaper to schedule pair by pair
+static const size_t MIN_ROW_TASK_SIZE = 8;
+
 static size_t g_worker_count = DEFAULT_THREAD_COUNT;
+static size_t g_sample_batch_size = DEFAULT_SAMPLE_BATCH_SIZE;
 
 static std::atomic<bool> g_working_flag(false);
 static std::atomic<uint_fast64_t> g_working_count(0);
@@ -38,7 +42,10 @@ public:
     }
 
     void schedule () { m_schedule_count.fetch_add(1, relaxed); }
-    void execute () { m_execute_count.fetch_add(1, relaxed); }
+    void execute (size_t count = 1)
+    {
+        m_execute_count.fetch_add(count, relaxed);
+    }
     void clear ()
     {
         m_schedule_count.store(0);
@@ -65,6 +72,12 @@ void set_thread_count (size_t worker_count)
     g_worker_count = worker_count;
 }
 
+void set_sample_batch_size (size_t batch_size)
+{
+    POMAGMA_ASSERT_LE(1, batch_size);
+    g_sample_batch_size = batch_size;
+}
+
 void reset_stats ()
 {
     g_merge_stats.clear();
@@ -120,6 +133,48 @@ public:
     }
 };
 
+// row tasks run their whole delta under one lock and one queue entry,
+// and lose only the referencing pairs on merge
+template<class PairTask>
+class TaskQueue<OrderRowTask<PairTask>>
+{
+    typedef OrderRowTask<PairTask> Task;
+    tbb::concurrent_queue<Task> m_queue;
+
+public:
+
+    void push (const Task & task)
+    {
+        m_queue.push(task);
+        g_working_condition.notify_one();
+        g_enforce_stats.schedule();
+    }
+
+    bool try_execute ()
+    {
+        SharedMutex::SharedLock lock(g_strict_mutex);
+        Task task;
+        if (m_queue.try_pop(task)) {
+            execute(task);
+            g_enforce_stats.execute();
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    void cancel_referencing (Ob ob)
+    {
+        for (size_t i = 0, I = m_queue.unsafe_size(); i != I; ++i) {
+            Task task;
+            m_queue.try_pop(task);
+            if (task.cancel_referencing(ob)) {
+                m_queue.push(task);
+            }
+        }
+    }
+};
+
 void cancel_tasks_referencing (Ob ob);
 
 template<>
@@ -166,6 +221,8 @@ static TaskQueue<MergeTask> g_merge_tasks;
 static TaskQueue<ExistsTask> g_exists_tasks;
 static TaskQueue<PositiveOrderTask> g_positive_order_tasks;
 static TaskQueue<NegativeOrderTask> g_negative_order_tasks;
+static TaskQueue<PositiveOrderRowTask> g_positive_order_row_tasks;
+static TaskQueue<NegativeOrderRowTask> g_negative_order_row_tasks;
 static TaskQueue<NullaryFunctionTask> g_nullary_function_tasks;
 static TaskQueue<InjectiveFunctionTask> g_injective_function_tasks;
 static TaskQueue<BinaryFunctionTask> g_binary_function_tasks;
@@ -181,6 +238,8 @@ inline void cancel_tasks_referencing (Ob ob)
     g_symmetric_function_tasks.cancel_referencing(ob);
     g_positive_order_tasks.cancel_referencing(ob);
     g_negative_order_tasks.cancel_referencing(ob);
+    g_positive_order_row_tasks.cancel_referencing(ob);
+    g_negative_order_row_tasks.cancel_referencing(ob);
 }
 
 inline bool enforce_tasks_try_execute (bool cleanup)
@@ -190,6 +249,8 @@ inline bool enforce_tasks_try_execute (bool cleanup)
         g_injective_function_tasks.try_execute() or
         g_binary_function_tasks.try_execute() or
         g_symmetric_function_tasks.try_execute() or
+        g_positive_order_row_tasks.try_execute() or
+        g_negative_order_row_tasks.try_execute() or
         g_positive_order_tasks.try_execute() or
         g_negative_order_tasks.try_execute())
     {
@@ -202,13 +263,21 @@ inline bool enforce_tasks_try_execute (bool cleanup)
     }
 }
 
+// samples are drawn in batches under one shared lock,
+// yielding early to any merge waiting for the unique lock
 inline bool sample_tasks_try_execute (rng_t & rng)
 {
     SampleTask task;
     if (sample_tasks_try_pop(task)) {
         SharedMutex::SharedLock lock(g_strict_mutex);
-        execute(task, rng);
-        g_sample_stats.execute();
+        size_t count = 0;
+        do {
+            execute(task, rng);
+            ++count;
+        } while (count < g_sample_batch_size
+             and not g_merge_tasks.waiting()
+             and sample_tasks_try_pop(task));
+        g_sample_stats.execute(count);
         return true;
     } else {
         return false;
@@ -324,6 +393,38 @@ void schedule (const NegativeOrderTask & task)
     Scheduler::g_negative_order_tasks.push(task);
 }
 
+void schedule (const PositiveOrderRowTask & task)
+{
+    Scheduler::g_positive_order_row_tasks.push(task);
+}
+
+void schedule (const NegativeOrderRowTask & task)
+{
+    Scheduler::g_negative_order_row_tasks.push(task);
+}
+
+template<class PairTask>
+inline void schedule_order_row (Ob lhs, const DenseSet & rhs)
+{
+    if (rhs.count_items() < Scheduler::MIN_ROW_TASK_SIZE) {
+        for (auto iter = rhs.iter(); iter.ok(); iter.next()) {
+            schedule(PairTask(lhs, * iter));
+        }
+    } else {
+        schedule(OrderRowTask<PairTask>(lhs, rhs));
+    }
+}
+
+void schedule_positive_order_row (Ob lhs, const DenseSet & rhs)
+{
+    schedule_order_row<PositiveOrderTask>(lhs, rhs);
+}
+
+void schedule_negative_order_row (Ob lhs, const DenseSet & rhs)
+{
+    schedule_order_row<NegativeOrderTask>(lhs, rhs);
+}
+
 void schedule (const NullaryFunctionTask & task)
 {
     Scheduler::g_nullary_function_tasks.push(task);
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "util.hpp"
+#include <pomagma/platform/concurrent/dense_set.hpp>
+#include <memory>
 
 // The Scheduler guarantees:
 // - never to execute a MergeTask while any other task is being executed
@@ -13,6 +15,7 @@ namespace pomagma
 {
 
 const size_t DEFAULT_THREAD_COUNT = 1;
+const size_t DEFAULT_SAMPLE_BATCH_SIZE = 16;
 
 class NullaryFunction;
 class InjectiveFunction;
@@ -60,6 +63,47 @@ struct NegativeOrderTask
     bool references (Ob dep) const { return lhs == dep or rhs == dep; }
 };
 
+// a batch of new pairs (lhs, rhs) for each rhs in a delta row,
+// which is shared among copies of the task
+template<class PairTask>
+struct OrderRowTask
+{
+    Ob lhs;
+    std::shared_ptr<const DenseSet> rhs;
+
+    OrderRowTask () {}
+    OrderRowTask (Ob l, const DenseSet & r) : lhs(l)
+    {
+        auto copy = std::make_shared<DenseSet>(r.item_dim());
+        * copy = r;
+        rhs = copy;
+    }
+
+    bool references (Ob dep) const
+    {
+        return lhs == dep or rhs->contains(dep);
+    }
+
+    // returns false if nothing remains after removing dep
+    bool cancel_referencing (Ob dep)
+    {
+        if (lhs == dep) {
+            return false;
+        }
+        if (rhs->contains(dep)) {
+            auto copy = std::make_shared<DenseSet>(rhs->item_dim());
+            * copy = * rhs;
+            copy->remove(dep);
+            rhs = copy;
+            return not rhs->empty();
+        }
+        return true;
+    }
+};
+
+typedef OrderRowTask<PositiveOrderTask> PositiveOrderRowTask;
+typedef OrderRowTask<NegativeOrderTask> NegativeOrderRowTask;
+
 struct NullaryFunctionTask
 {
     const NullaryFunction * fun;
@@ -121,12 +165,18 @@ struct AssumeTask
     bool references (Ob) = delete;
 };
 
+// a chunk of consecutive blocks of one cleanup type
 struct CleanupTask
 {
     unsigned long type;
+    unsigned long block_begin;
+    unsigned long block_end;
 
     CleanupTask () {}
-    CleanupTask (unsigned long t) : type(t) {}
+    CleanupTask (unsigned long t, unsigned long b = 0, unsigned long e = 1)
+        : type(t), block_begin(b), block_end(e)
+    {
+    }
 };
 
 struct SampleTask
@@ -139,6 +189,8 @@ void schedule (const MergeTask & task);
 void schedule (const ExistsTask & task);
 void schedule (const PositiveOrderTask & task);
 void schedule (const NegativeOrderTask & task);
+void schedule (const PositiveOrderRowTask & task);
+void schedule (const NegativeOrderRowTask & task);
 void schedule (const NullaryFunctionTask & task);
 void schedule (const InjectiveFunctionTask & task);
 void schedule (const BinaryFunctionTask & task);
@@ -147,11 +199,17 @@ void schedule (const AssumeTask & task);
 // Other tasks are run continuously, not scheduled:
 // SampleTask, CleanupTask
 
+// These schedule a row as one task, or small rows as pairs
+void schedule_positive_order_row (Ob lhs, const DenseSet & rhs);
+void schedule_negative_order_row (Ob lhs, const DenseSet & rhs);
+
 // These are defined by the user and called by the Scheduler
 void execute (const MergeTask & task);
 void execute (const ExistsTask & task);
 void execute (const PositiveOrderTask & task);
 void execute (const NegativeOrderTask & task);
+void execute (const PositiveOrderRowTask & task);
+void execute (const NegativeOrderRowTask & task);
 void execute (const NullaryFunctionTask & task);
 void execute (const InjectiveFunctionTask & task);
 void execute (const BinaryFunctionTask & task);
@@ -172,6 +230,9 @@ namespace Scheduler
 
 void set_thread_count (size_t worker_count);
 
+// each worker draws up to this many samples per acquisition of the lock
+void set_sample_batch_size (size_t batch_size);
+
 // blocking api, requires access from single thread
 void initialize (const char * theory_file = nullptr);
 void survey ();
@@ -16,14 +16,14 @@ SymmetricFunction::SymmetricFunction (
       m_tiles(pomagma::alloc_blocks<Tile>(
                   unordered_pair_count(m_tile_dim))),
       m_Vlr_table(1 + item_dim()),
+      m_VLr_table(1 + item_dim()),
       m_insert_callback(insert_callback ? insert_callback : noop_callback)
 {
     POMAGMA_DEBUG("creating SymmetricFunction with "
             << unordered_pair_count(m_tile_dim) << " tiles");
 
-    std::atomic<Ob> * obs = & m_tiles[0][0];
-    size_t tile_count = unordered_pair_count(m_tile_dim);
-    construct_blocks(obs, tile_count * ITEMS_PER_TILE * ITEMS_PER_TILE, 0);
+    // zeroing in parallel first-touches tiles across numa nodes
+    zero_blocks(m_tiles, unordered_pair_count(m_tile_dim));
 }
 
 SymmetricFunction::~SymmetricFunction ()
@@ -118,12 +118,13 @@ void SymmetricFunction::update ()
     memory_barrier();
     for (auto lhs_iter = support().iter(); lhs_iter.ok(); lhs_iter.next()) {
         Ob lhs = *lhs_iter;
-        for (auto rhs_iter = iter_lhs(lhs); rhs_iter.ok(); rhs_iter.next()) {
+        for (auto rhs_iter = iter_upper(lhs); rhs_iter.ok(); rhs_iter.next()) {
             Ob rhs = *rhs_iter;
             Ob val = find(lhs, rhs);
 
             m_Vlr_table.insert(lhs, rhs, val);
             m_VLr_table.insert(lhs, rhs, val);
+            m_VLr_table.insert(rhs, lhs, val);
         }
     }
     memory_barrier();
@@ -168,12 +169,10 @@ void SymmetricFunction::unsafe_merge (const Ob dep)
             m_lines.Rx(rep, rhs).one();
             m_Vlr_table.unsafe_remove(dep, rhs, val).insert(rep, rhs, val);
             m_VLr_table.unsafe_remove(dep, rhs, val).insert(rep, rhs, val);
-            m_Vlr_table.unsafe_remove(rhs, dep, val).insert(rhs, rep, val);
             m_VLr_table.unsafe_remove(rhs, dep, val).insert(rhs, rep, val);
         } else {
             m_Vlr_table.unsafe_remove(dep, rhs, val);
             m_VLr_table.unsafe_remove(dep, rhs, val);
-            m_Vlr_table.unsafe_remove(rhs, dep, val);
             m_VLr_table.unsafe_remove(rhs, dep, val);
         }
     }
@@ -16,7 +16,7 @@ class SymmetricFunction : noncopyable
     mutable base_sym_rel m_lines;
     const size_t m_tile_dim;
     Tile * const m_tiles;
-    Vlr_Table m_Vlr_table;
+    Vlr_SymTable m_Vlr_table;
     VLr_Table m_VLr_table;
     void (*m_insert_callback) (const SymmetricFunction *, Ob, Ob);
 
@@ -49,7 +49,8 @@ public:
     Ob find (Ob lhs, Ob rhs) const { return value(lhs, rhs).load(acquire); }
     DenseSet::Iterator iter_lhs (Ob lhs) const;
     DenseSet::Iterator iter_rhs (Ob rhs) const;
-    Vlr_Table::Iterator iter_val (Ob val) const;
+    DenseSet::Iterator iter_upper (Ob lhs) const; // rhs >= lhs
+    Vlr_SymTable::Iterator iter_val (Ob val) const;
     VLr_Table::Iterator iter_val_lhs (Ob val, Ob lhs) const;
     VLr_Table::Iterator iter_val_rhs (Ob val, Ob lhs) const;
     void insert (Ob lhs, Ob rhs, Ob val) const;
@@ -101,7 +102,14 @@ inline DenseSet::Iterator SymmetricFunction::iter_rhs (Ob rhs) const
     return DenseSet::Iterator(item_dim(), m_lines.Rx(rhs));
 }
 
-inline Vlr_Table::Iterator SymmetricFunction::iter_val (Ob val) const
+// iterating iter_upper over lhs visits each unordered pair once
+inline DenseSet::Iterator SymmetricFunction::iter_upper (Ob lhs) const
+{
+    POMAGMA_ASSERT5(support().contains(lhs), "unsupported lhs: " << lhs);
+    return DenseSet::Iterator(item_dim(), m_lines.Lx(lhs), lhs, nullptr);
+}
+
+inline Vlr_SymTable::Iterator SymmetricFunction::iter_val (Ob val) const
 {
     POMAGMA_ASSERT5(support().contains(val), "unsupported val: " << val);
     return m_Vlr_table.iter(val);
@@ -146,7 +154,6 @@ inline void SymmetricFunction::insert (Ob lhs, Ob rhs, Ob val) const
         m_lines.Lx(lhs, rhs).one();
         m_lines.Rx(lhs, rhs).one();
         m_Vlr_table.insert(lhs, rhs, val);
-        m_Vlr_table.insert(rhs, lhs, val);
         m_VLr_table.insert(lhs, rhs, val);
         m_VLr_table.insert(rhs, lhs, val);
         m_insert_callback(this, lhs, rhs);
@@ -17,14 +17,17 @@ struct Example
         const DenseSet & support = carrier.support();
 
         POMAGMA_INFO("Defining function");
+        size_t pair_count = 0;
         for (auto i = support.iter(); i.ok(); i.next())
         for (auto j = support.iter(); j.ok() and *j <= *i; j.next()) {
             Ob k = gcd(*i, *j);
             if ((k > 1) and carrier.contains(k)) {
                 fun.insert(*i, *j, k);
+                ++pair_count;
             }
         }
         fun.validate();
+        POMAGMA_ASSERT_EQ(fun.count_pairs(), pair_count);
 
         POMAGMA_INFO("Checking function values");
         for (auto i = support.iter(); i.ok(); i.next())
@@ -42,6 +45,22 @@ struct Example
         }
         fun.validate();
 
+        POMAGMA_INFO("Checking unordered pairs");
+        for (auto i = support.iter(); i.ok(); i.next())
+        for (auto j = fun.iter_upper(*i); j.ok(); j.next()) {
+            POMAGMA_ASSERT_LE(*i, *j);
+            Ob k = fun.find(*i, *j);
+            size_t orders = 0;
+            for (auto iter = fun.iter_val(k); iter.ok(); iter.next()) {
+                if ((iter.lhs() == *i and iter.rhs() == *j) or
+                    (iter.lhs() == *j and iter.rhs() == *i))
+                {
+                    ++orders;
+                }
+            }
+            POMAGMA_ASSERT_EQ(orders, *i == *j ? 1 : 2);
+        }
+
         fun.clear();
         fun.validate();
         POMAGMA_ASSERT_EQ(fun.count_pairs(), 0);
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "util.hpp"
+#include <pomagma/platform/aligned_alloc.hpp>
+
+namespace pomagma
+{
+
+// COLUMN_MAJOR places tiles column by column, so only column scans are local.
+// Z_ORDER interleaves tile coordinates, so that row scans and column scans
+// both stay within nearby tiles, at the cost of padding to a square of
+// power-of-two side.
+enum TileOrder { COLUMN_MAJOR, Z_ORDER };
+
+namespace detail
+{
+
+// spreads the low 32 bits of x to the even bit positions
+inline uint64_t spread_bits (uint64_t x)
+{
+    x &= 0xFFFFFFFFULL;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+}
+
+} // namespace detail
+
+// a square array of atomic Ob, stored in tiles of ITEMS_PER_TILE^2 values
+template<size_t log2_items_per_tile, TileOrder order>
+class TiledValues : noncopyable
+{
+public:
+
+    static const size_t LOG2_ITEMS_PER_TILE = log2_items_per_tile;
+    static const size_t ITEMS_PER_TILE = 1UL << LOG2_ITEMS_PER_TILE;
+    static const size_t TILE_POS_MASK = ITEMS_PER_TILE - 1;
+    typedef std::atomic<Ob> Tile[ITEMS_PER_TILE * ITEMS_PER_TILE];
+
+    TiledValues (size_t item_dim)
+        : m_tile_dim((item_dim + ITEMS_PER_TILE) / ITEMS_PER_TILE),
+          m_tile_count(tile_count(m_tile_dim)),
+          m_tiles(alloc_blocks<Tile>(m_tile_count))
+    {
+        // zeroing in parallel first-touches tiles across numa nodes
+        zero_blocks(m_tiles, m_tile_count);
+    }
+    ~TiledValues ()
+    {
+        std::atomic<Ob> * obs = & m_tiles[0][0];
+        destroy_blocks(obs, m_tile_count * ITEMS_PER_TILE * ITEMS_PER_TILE);
+        free_blocks(m_tiles);
+    }
+
+    size_t tile_dim () const { return m_tile_dim; }
+    size_t tile_count () const { return m_tile_count; }
+    size_t byte_count () const { return m_tile_count * sizeof(Tile); }
+
+    void clear () { zero_blocks(m_tiles, m_tile_count); }
+
+    std::atomic<Ob> & operator() (Ob i, Ob j) const
+    {
+        std::atomic<Ob> * tile =
+            m_tiles[tile_index(i >> LOG2_ITEMS_PER_TILE,
+                               j >> LOG2_ITEMS_PER_TILE)];
+        return tile[((j & TILE_POS_MASK) << LOG2_ITEMS_PER_TILE)
+                  | (i & TILE_POS_MASK)];
+    }
+
+private:
+
+    static size_t tile_count (size_t tile_dim)
+    {
+        if (order == Z_ORDER) {
+            size_t padded_dim = 1;
+            while (padded_dim < tile_dim) {
+                padded_dim *= 2;
+            }
+            tile_dim = padded_dim;
+        }
+        return tile_dim * tile_dim;
+    }
+
+    size_t tile_index (size_t i_, size_t j_) const
+    {
+        POMAGMA_ASSERT6(i_ < m_tile_dim, "out of range " << i_);
+        POMAGMA_ASSERT6(j_ < m_tile_dim, "out of range " << j_);
+        if (order == Z_ORDER) {
+            return detail::spread_bits(i_) | (detail::spread_bits(j_) << 1);
+        } else {
+            return m_tile_dim * j_ + i_;
+        }
+    }
+
+    const size_t m_tile_dim;
+    const size_t m_tile_count;
+    Tile * const m_tiles;
+};
+
+} // namespace pomagma
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "util.hpp"
+#include <vector>
+
+namespace pomagma
+{
+
+// Walker's alias method, built by Vose's algorithm.
+// Each sample costs one uniform draw and one probe into a contiguous array.
+// Tables are immutable after init, so they can be shared across threads.
+template<class Value>
+class AliasTable
+{
+    struct Entry
+    {
+        float prob;
+        Value value;
+        Value alias;
+    };
+
+public:
+
+    AliasTable () {}
+
+    // weights need not be normalized, and may be zero
+    void init (const std::vector<std::pair<Value, float>> & weights)
+    {
+        m_entries.clear();
+        const size_t size = weights.size();
+        if (size == 0) {
+            return;
+        }
+
+        float total = 0;
+        for (const auto & pair : weights) {
+            POMAGMA_ASSERT_LE(0, pair.second);
+            total += pair.second;
+        }
+        POMAGMA_ASSERT_LT(0, total);
+
+        std::vector<float> probs(size);
+        std::vector<size_t> small;
+        std::vector<size_t> large;
+        for (size_t i = 0; i < size; ++i) {
+            probs[i] = weights[i].second * size / total;
+            (probs[i] < 1 ? small : large).push_back(i);
+        }
+
+        m_entries.resize(size);
+        while (not small.empty() and not large.empty()) {
+            size_t s = small.back();
+            size_t l = large.back();
+            small.pop_back();
+            large.pop_back();
+            Entry entry = {probs[s], weights[s].first, weights[l].first};
+            m_entries[s] = entry;
+            probs[l] = (probs[l] + probs[s]) - 1;
+            (probs[l] < 1 ? small : large).push_back(l);
+        }
+
+        // leftovers are within rounding error of 1
+        for (size_t i : small) {
+            Entry entry = {1, weights[i].first, weights[i].first};
+            m_entries[i] = entry;
+        }
+        for (size_t i : large) {
+            Entry entry = {1, weights[i].first, weights[i].first};
+            m_entries[i] = entry;
+        }
+    }
+
+    bool empty () const { return m_entries.empty(); }
+    size_t size () const { return m_entries.size(); }
+
+    const Value & sample (rng_t & rng) const
+    {
+        POMAGMA_ASSERT3(not m_entries.empty(), "sampled from empty table");
+        const size_t size = m_entries.size();
+        std::uniform_real_distribution<float> random_point(0, size);
+        float r = random_point(rng);
+        size_t i = static_cast<size_t>(r);
+        if (unlikely(i >= size)) {
+            i = size - 1; // occasionally overflow due to rounding error
+        }
+        const Entry & entry = m_entries[i];
+        return r - i < entry.prob ? entry.value : entry.alias;
+    }
+
+private:
+
+    std::vector<Entry> m_entries;
+};
+
+} // namespace pomagma
@@ -0,0 +1,56 @@
+#include <pomagma/platform/util.hpp>
+#include <pomagma/platform/alias_table.hpp>
+
+using namespace pomagma;
+
+void test_alias_table (const std::vector<float> & probs)
+{
+    POMAGMA_INFO("Testing alias table of " << probs.size() << " values");
+
+    std::vector<std::pair<size_t, float>> weights;
+    float total = 0;
+    for (size_t i = 0; i < probs.size(); ++i) {
+        weights.push_back(std::make_pair(i, probs[i]));
+        total += probs[i];
+    }
+
+    AliasTable<size_t> table;
+    table.init(weights);
+    POMAGMA_ASSERT_EQ(table.size(), probs.size());
+
+    const size_t sample_count = 100000;
+    std::vector<size_t> counts(probs.size(), 0);
+    rng_t rng;
+    for (size_t i = 0; i < sample_count; ++i) {
+        size_t value = table.sample(rng);
+        POMAGMA_ASSERT_LT(value, probs.size());
+        ++counts[value];
+    }
+
+    for (size_t i = 0; i < probs.size(); ++i) {
+        float expected = probs[i] / total;
+        float actual = float(counts[i]) / sample_count;
+        if (probs[i] == 0) {
+            POMAGMA_ASSERT_EQ(counts[i], 0);
+        } else {
+            POMAGMA_ASSERT_LT(fabs(actual - expected), 0.01);
+        }
+    }
+}
+
+int main ()
+{
+    test_alias_table({1});
+    test_alias_table({1, 1});
+    test_alias_table({0.5, 0.0, 0.25, 0.25});
+    test_alias_table({1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+    test_alias_table({100, 1, 1, 1, 1});
+
+    std::vector<float> probs;
+    for (size_t i = 0; i < 100; ++i) {
+        probs.push_back(1.0 / (1 + i));
+    }
+    test_alias_table(probs);
+
+    return 0;
+}
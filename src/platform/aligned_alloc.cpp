@@ -1,19 +1,159 @@
-
 #include <pomagma/platform/aligned_alloc.hpp>
+#include <mutex>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #define POMAGMA_DEBUG1(mess)
 //#define POMAGMA_DEBUG1(mess) POMAGMA_DEBUG(message)
 
+#ifndef MPOL_INTERLEAVE
+#  define MPOL_INTERLEAVE 3
+#endif // MPOL_INTERLEAVE
+
 namespace pomagma
 {
 
-// allocates an aligned array, wraps posix_memalign
+//----------------------------------------------------------------------------
+// Mapped blocks
+//
+// Blocks of at least POMAGMA_MMAP_THRESHOLD bytes (default 16MB, 0 disables)
+// are mapped directly, aligned to huge pages and advised to use them.
+// POMAGMA_NUMA selects the page placement policy of mapped blocks:
+//   local = first touch (default), interleave = round-robin over nodes.
+
+static const size_t HUGE_PAGE_SIZE = 1UL << 21;
+static const size_t DEFAULT_MMAP_THRESHOLD = 1UL << 24;
+
+namespace
+{
+
+struct Mappings
+{
+    std::mutex mutex;
+    std::unordered_map<void *, size_t> sizes;
+};
+
+Mappings & mappings ()
+{
+    static Mappings s_mappings;
+    return s_mappings;
+}
+
+size_t mmap_threshold ()
+{
+    static const size_t threshold =
+        getenv_default("POMAGMA_MMAP_THRESHOLD", DEFAULT_MMAP_THRESHOLD);
+    return threshold;
+}
+
+bool numa_interleave ()
+{
+    static const bool interleave =
+        std::string(getenv_default("POMAGMA_NUMA", "local")) == "interleave";
+    return interleave;
+}
+
+void set_numa_policy (void * base, size_t byte_count)
+{
+#if defined(__linux__) and defined(SYS_mbind)
+    if (numa_interleave()) {
+        unsigned long nodemask = ~0UL;
+        long info = syscall(
+            SYS_mbind,
+            base,
+            byte_count,
+            MPOL_INTERLEAVE,
+            & nodemask,
+            8 * sizeof(nodemask),
+            0);
+        if (info != 0) {
+            POMAGMA_WARN("mbind failed to interleave " << byte_count << 'B');
+        }
+    }
+#endif // defined(__linux__) and defined(SYS_mbind)
+}
+
+// returns nullptr on failure
+void * map_blocks (size_t byte_count)
+{
+    const size_t size =
+        (byte_count + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    const size_t mapped_size = size + HUGE_PAGE_SIZE;
+    void * mapped = mmap(
+        nullptr,
+        mapped_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS,
+        -1,
+        0);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+
+    // trim the mapping to huge page boundaries
+    char * begin = static_cast<char *>(mapped);
+    char * end = begin + mapped_size;
+    char * base = begin + (HUGE_PAGE_SIZE - 1)
+                - (reinterpret_cast<uintptr_t>(begin + HUGE_PAGE_SIZE - 1)
+                   % HUGE_PAGE_SIZE);
+    if (base != begin) {
+        munmap(begin, base - begin);
+    }
+    if (base + size != end) {
+        munmap(base + size, end - (base + size));
+    }
+
+#ifdef MADV_HUGEPAGE
+    madvise(base, size, MADV_HUGEPAGE);
+#endif // MADV_HUGEPAGE
+    set_numa_policy(base, size);
+
+    {
+        std::unique_lock<std::mutex> lock(mappings().mutex);
+        mappings().sizes[base] = size;
+    }
+    return base;
+}
+
+// returns false if base was not mapped by map_blocks
+bool unmap_blocks (void * base)
+{
+    size_t size;
+    {
+        std::unique_lock<std::mutex> lock(mappings().mutex);
+        auto i = mappings().sizes.find(base);
+        if (i == mappings().sizes.end()) {
+            return false;
+        }
+        size = i->second;
+        mappings().sizes.erase(i);
+    }
+    munmap(base, size);
+    return true;
+}
+
+} // anonymous namespace
+
+//----------------------------------------------------------------------------
+// Interface
+
+// allocates an aligned array, wraps posix_memalign or mmap
 void * alloc_blocks (size_t block_size, size_t block_count, size_t alignment)
 {
     POMAGMA_DEBUG1("Allocating " << block_count
                    << " blocks of size " << block_size << 'B');
 
     size_t byte_count = block_size * block_count;
+    const size_t threshold = mmap_threshold();
+    if (threshold and byte_count >= threshold) {
+        if (void * base = map_blocks(byte_count)) {
+            return base;
+        }
+        POMAGMA_WARN("mmap failed to allocate " << byte_count << 'B');
+    }
+
     void * base;
     int info = posix_memalign(& base, alignment, byte_count);
 
@@ -23,12 +163,37 @@ void * alloc_blocks (size_t block_size, size_t block_count, size_t alignment)
     return base;
 }
 
-// just wraps free()
+// wraps free() or munmap()
 void free_blocks (void * base)
 {
     POMAGMA_DEBUG1("Freeing blocks");
 
+    // mapped blocks are aligned to huge pages
+    if (reinterpret_cast<uintptr_t>(base) % HUGE_PAGE_SIZE == 0 and
+        base and unmap_blocks(base))
+    {
+        return;
+    }
     free(base);
 }
 
+void zero_bytes (void * base, size_t byte_count)
+{
+    if (byte_count < HUGE_PAGE_SIZE) {
+        bzero(base, byte_count);
+        return;
+    }
+
+    char * bytes = static_cast<char *>(base);
+    const size_t chunk_count =
+        (byte_count + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE;
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < chunk_count; ++i) {
+        size_t begin = i * HUGE_PAGE_SIZE;
+        size_t end = min(begin + HUGE_PAGE_SIZE, byte_count);
+        bzero(bytes + begin, end - begin);
+    }
+}
+
 } // namespace pomagma
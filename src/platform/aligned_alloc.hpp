@@ -1,7 +1,7 @@
 #pragma once
 
-// TODO try out google's tcmalloc:
-// http://gperftools.googlecode.com/svn/trunk/doc/tcmalloc.html
+// Large blocks are mapped directly with huge pages and an optional numa
+// policy; see aligned_alloc.cpp for the environment variables that tune this.
 
 #include <pomagma/platform/util.hpp>
 #include <cstring>
@@ -27,10 +27,14 @@ inline T * alloc_blocks (size_t block_count)
   return static_cast<T *>(alloc_blocks(sizeof(T), block_count));
 }
 
+// zeroes large ranges in parallel, so that pages are first touched by the
+// threads and hence numa nodes that will later work on them
+void zero_bytes (void * base, size_t byte_count);
+
 template<class T>
 inline void zero_blocks (T * base, size_t count)
 {
-    bzero(base, count * sizeof(T));
+    zero_bytes(base, count * sizeof(T));
 }
 
 template<class T, class Init = T>
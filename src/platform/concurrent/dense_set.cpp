@@ -13,15 +13,22 @@ namespace concurrent
 
 typedef size_t Ob;
 
-DenseSet::DenseSet (size_t item_dim)
+DenseSet::DenseSet (size_t item_dim, Layout layout)
     : m_item_dim(item_dim),
       m_word_dim(items_to_words(m_item_dim)),
       m_words(pomagma::alloc_blocks<std::atomic<Word>>(m_word_dim)),
-      m_alias(false)
+      m_alias(false),
+      m_summary_dim(
+          layout == SUMMARIZED ? words_to_summary_words(m_word_dim) : 0),
+      m_summary(
+          layout == SUMMARIZED
+              ? pomagma::alloc_blocks<std::atomic<Word>>(2 * m_summary_dim)
+              : nullptr)
 {
     POMAGMA_DEBUG1("creating DenseSet with " << m_word_dim << " lines");
 
     bzero(m_words, sizeof(std::atomic<Word>) * m_word_dim);
+    _resummarize();
 }
 
 void DenseSet::operator= (const DenseSet & other)
@@ -30,14 +37,25 @@ void DenseSet::operator= (const DenseSet & other)
     POMAGMA_ASSERT1(item_dim() == other.item_dim(), "item_dim mismatch");
 
     memcpy(m_words, other.m_words, sizeof(std::atomic<Word>) * m_word_dim);
+    _resummarize();
 }
 
 //----------------------------------------------------------------------------
 // Diagnostics
 
-// not fast
+// not fast, unless summarized
 bool DenseSet::empty () const
 {
+    if (m_summary) {
+        for (size_t m = skip_lines(_nonempty(), 0, m_word_dim);
+            m < m_word_dim;
+            m = skip_lines(_nonempty(), m + 1, m_word_dim))
+        {
+            if (m_words[m].load(relaxed)) return false;
+        }
+        return true;
+    }
+
     for (size_t m = 0, M = m_word_dim; m < M; ++m) {
         if (m_words[m].load(relaxed)) return false;
     }
@@ -49,15 +67,36 @@ size_t DenseSet::count_items () const
 {
     size_t result = 0;
     for (size_t m = 0, M = m_word_dim; m < M; ++m) {
-        // WARNING only unsigned's work with >>
-        static_assert(Word(1) >> 1 == 0, "bitshifting Word fails");
-        for (Word word = m_words[m].load(relaxed); word; word >>= 1) {
-            result += word & Word(1);
+        if (m_summary) {
+            m = skip_lines(_nonempty(), m, m_word_dim);
+            if (m == M) break;
         }
+        result += __builtin_popcountl(m_words[m].load(relaxed));
     }
     return result;
 }
 
+// rebuilds summaries from scratch; not safe with concurrent updates
+void DenseSet::update_summary ()
+{
+    POMAGMA_ASSERT1(m_summary, "tried to update summary of flat dense set");
+
+    std::atomic<Word> * nonempty = m_summary;
+    std::atomic<Word> * nonfull = m_summary + m_summary_dim;
+    bzero(m_summary, sizeof(Word) * 2 * m_summary_dim);
+    const size_t line_dim = (m_word_dim + WORDS_PER_LINE - 1) / WORDS_PER_LINE;
+    for (size_t line = 0; line < line_dim; ++line) {
+        const size_t s = line >> WORD_POS_SHIFT;
+        const Word mask = Word(1) << (line & WORD_POS_MASK);
+        if (not _line_empty(line)) {
+            nonempty[s].fetch_or(mask, relaxed);
+        }
+        if (not _line_full(line)) {
+            nonfull[s].fetch_or(mask, relaxed);
+        }
+    }
+}
+
 void DenseSet::validate () const
 {
     // make sure padding bits are zero
@@ -66,10 +105,27 @@ void DenseSet::validate () const
 
     // deal with partially-filled final block
     size_t end = (m_item_dim + 1) % BITS_PER_WORD;
-    if (end == 0) return;
-    POMAGMA_ASSERT(not (m_words[m_word_dim - 1].load(relaxed) >> end),
-            "dense set's end bits are used: "
-            << m_words[m_word_dim - 1].load(relaxed));
+    if (end) {
+        POMAGMA_ASSERT(not (m_words[m_word_dim - 1].load(relaxed) >> end),
+                "dense set's end bits are used: "
+                << m_words[m_word_dim - 1].load(relaxed));
+    }
+
+    // make sure summaries are conservative
+    if (m_summary) {
+        const size_t line_dim =
+            (m_word_dim + WORDS_PER_LINE - 1) / WORDS_PER_LINE;
+        for (size_t line = 0; line < line_dim; ++line) {
+            const size_t s = line >> WORD_POS_SHIFT;
+            const Word mask = Word(1) << (line & WORD_POS_MASK);
+            POMAGMA_ASSERT(
+                _line_empty(line) or (_nonempty()[s].load() & mask),
+                "nonempty line is summarized as empty: " << line);
+            POMAGMA_ASSERT(
+                _line_full(line) or (_nonfull()[s].load() & mask),
+                "nonfull line is summarized as full: " << line);
+        }
+    }
 }
 
 
@@ -90,21 +146,42 @@ void DenseSet::insert_all ()
         size_t trim = BITS_PER_WORD - ((item_dim() + 1) % BITS_PER_WORD);
         m_words[word_dim() - 1].store(all >> trim, relaxed);
     }
+    _resummarize();
 }
 
 size_t DenseSet::try_insert_one ()
 {
-    for (size_t w = 0; w < word_dim(); ++w) {
-        Word all = ~Word(w ? 0 : 1);
-        if (unlikely(m_words[w].load(relaxed) != all)) {
-            size_t i_ = w * BITS_PER_WORD;
-            for (size_t _i = w ? 0 : 1; _i < BITS_PER_WORD; ++_i) {
-                size_t ob = i_ + _i;
-                if (ob <= item_dim() and try_insert(ob)) {
-                    return ob;
+    for (size_t i = find_absent(); i; i = find_absent(i + 1)) {
+        if (try_insert(i)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+// returns the first item at or after begin not in the set, or 0 if none
+size_t DenseSet::find_absent (size_t begin) const
+{
+    size_t i = max(begin, size_t(1));
+    while (i <= m_item_dim) {
+        size_t quot = i >> WORD_POS_SHIFT;
+        if (m_summary) {
+            size_t next = skip_lines(_nonfull(), quot, m_word_dim);
+            if (next != quot) {
+                if (next == m_word_dim) {
+                    return 0;
                 }
+                quot = next;
+                i = quot * BITS_PER_WORD;
             }
         }
+        Word absent = ~m_words[quot].load(relaxed)
+                    & (~Word(0) << (i & WORD_POS_MASK));
+        if (absent) {
+            i = quot * BITS_PER_WORD + __builtin_ctzl(absent);
+            return i <= m_item_dim ? i : 0;
+        }
+        i = (quot + 1) * BITS_PER_WORD;
     }
     return 0;
 }
@@ -115,6 +192,7 @@ size_t DenseSet::try_insert_one ()
 void DenseSet::zero ()
 {
     bzero(m_words, sizeof(Word) * m_word_dim);
+    _resummarize();
 }
 
 bool DenseSet::operator== (const DenseSet & other) const
@@ -164,6 +242,7 @@ void DenseSet::operator += (const DenseSet & other)
     for (size_t m = 0, M = m_word_dim; m < M; ++m) {
         t[m].fetch_or(s[m].load(relaxed), relaxed);
     }
+    _resummarize();
 }
 
 // inplace intersection
@@ -177,6 +256,7 @@ void DenseSet::operator *= (const DenseSet & other)
     for (size_t m = 0, M = m_word_dim; m < M; ++m) {
         t[m].fetch_and(s[m].load(relaxed), relaxed);
     }
+    _resummarize();
 }
 
 void DenseSet::set_union (const DenseSet & lhs, const DenseSet & rhs)
@@ -191,6 +271,7 @@ void DenseSet::set_union (const DenseSet & lhs, const DenseSet & rhs)
     for (size_t m = 0, M = m_word_dim; m < M; ++m) {
         u[m].store(s[m].load(relaxed) | t[m].load(relaxed), relaxed);
     }
+    _resummarize();
 }
 
 void DenseSet::set_insn (const DenseSet & lhs, const DenseSet & rhs)
@@ -205,6 +286,7 @@ void DenseSet::set_insn (const DenseSet & lhs, const DenseSet & rhs)
     for (size_t m = 0, M = m_word_dim; m < M; ++m) {
         u[m].store(s[m].load(relaxed) & t[m].load(relaxed), relaxed);
     }
+    _resummarize();
 }
 
 // this += dep; dep = 0;
@@ -219,6 +301,8 @@ void DenseSet::merge (DenseSet & dep)
         r[m].fetch_or(d[m].load(relaxed), relaxed);
         d[m].store(0, relaxed);
     }
+    _resummarize();
+    dep._resummarize();
 }
 
 // diff = dep - this; this += dep; dep = 0; return diff not empty;
@@ -241,6 +325,9 @@ bool DenseSet::merge (DenseSet & dep, DenseSet & diff)
         c[m].store(change, relaxed);
         changed |= change;
     }
+    _resummarize();
+    dep._resummarize();
+    diff._resummarize();
 
     return changed;
 }
@@ -255,15 +342,19 @@ bool DenseSet::ensure (const DenseSet & src, DenseSet & diff)
     std::atomic<Word> * restrict r = assume_aligned(m_words);
     std::atomic<Word> * restrict c = assume_aligned(diff.m_words);
 
+    // diff gets only bits set by this call, even under concurrent inserts
     Word changed = 0;
     for (size_t m = 0, M = m_word_dim; m < M; ++m) {
         Word dm = d[m].load(relaxed);
-        Word rm = r[m].load(relaxed);
-        Word change = dm & ~ rm;
-        r[m].fetch_or(dm, relaxed);
+        Word change = dm & ~ r[m].load(relaxed);
+        if (change) {
+            change = dm & ~ r[m].fetch_or(dm, relaxed);
+        }
         c[m].store(change, relaxed);
         changed |= change;
     }
+    _resummarize();
+    diff._resummarize();
 
     return changed;
 }
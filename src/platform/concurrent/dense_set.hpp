@@ -18,6 +18,48 @@ inline size_t items_to_words (size_t item_dim)
     return (item_dim + BITS_PER_WORD) / BITS_PER_WORD;
 }
 
+//----------------------------------------------------------------------------
+// Summaries
+//
+// A summary has one bit per cache line of words, so that scans can skip
+// whole lines. A summary is conservative: a clear bit guarantees that the
+// summarized property fails for the line, but a set bit guarantees nothing.
+
+static const size_t WORDS_PER_LINE = BITS_PER_CACHE_LINE / BITS_PER_WORD;
+
+inline size_t words_to_summary_words (size_t word_dim)
+{
+    const size_t line_dim = (word_dim + WORDS_PER_LINE - 1) / WORDS_PER_LINE;
+    return (line_dim + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+// returns the first word at or after quot in a marked line, or word_dim
+inline size_t skip_lines (
+        const std::atomic<Word> * summary,
+        size_t quot,
+        size_t word_dim)
+{
+    const size_t summary_dim = words_to_summary_words(word_dim);
+    const size_t line = quot / WORDS_PER_LINE;
+    size_t s = line >> WORD_POS_SHIFT;
+    if (s >= summary_dim) {
+        return word_dim;
+    }
+    Word word = summary[s].load(relaxed)
+              & (~Word(0) << (line & WORD_POS_MASK));
+    while (not word) {
+        if (++s == summary_dim) {
+            return word_dim;
+        }
+        word = summary[s].load(relaxed);
+    }
+    const size_t next_line = (s << WORD_POS_SHIFT) + __builtin_ctzl(word);
+    if (next_line == line) {
+        return quot;
+    }
+    return min(next_line * WORDS_PER_LINE, word_dim);
+}
+
 //----------------------------------------------------------------------------
 // Iteration
 
@@ -25,17 +67,26 @@ class SimpleSet
 {
     const size_t m_word_dim;
     const std::atomic<Word> * const m_words;
+    const std::atomic<Word> * const m_summary;
 
 public:
 
-    SimpleSet (size_t item_dim, const std::atomic<Word> * words)
+    SimpleSet (
+            size_t item_dim,
+            const std::atomic<Word> * words,
+            const std::atomic<Word> * summary = nullptr)
         : m_word_dim(items_to_words(item_dim)),
-          m_words(words)
+          m_words(words),
+          m_summary(summary)
     {
         POMAGMA_ASSERT4(m_words, "constructed SimpleSet with null words");
     }
 
     size_t word_dim () const { return m_word_dim; }
+    size_t skip (size_t quot) const
+    {
+        return m_summary ? skip_lines(m_summary, quot, m_word_dim) : quot;
+    }
     bool get_bit (size_t pos) const { return bool_ref::index(m_words, pos); }
     Word get_word (size_t quot) const { return m_words[quot].load(relaxed); }
 };
@@ -45,22 +96,29 @@ class Intersection2
     const size_t m_word_dim;
     const std::atomic<Word> * const m_words1;
     const std::atomic<Word> * const m_words2;
+    const std::atomic<Word> * const m_summary1;
 
 public:
 
     Intersection2 (
             size_t item_dim,
             const std::atomic<Word> * words1,
-            const std::atomic<Word> * words2)
+            const std::atomic<Word> * words2,
+            const std::atomic<Word> * summary1 = nullptr)
         : m_word_dim(items_to_words(item_dim)),
           m_words1(words1),
-          m_words2(words2)
+          m_words2(words2),
+          m_summary1(summary1)
     {
         POMAGMA_ASSERT4(m_words1, "constructed Intersection2 with null words1");
         POMAGMA_ASSERT4(m_words2, "constructed Intersection2 with null words2");
     }
 
     size_t word_dim () const { return m_word_dim; }
+    size_t skip (size_t quot) const
+    {
+        return m_summary1 ? skip_lines(m_summary1, quot, m_word_dim) : quot;
+    }
     bool get_bit (size_t pos) const
     {
         Word mask = Word(1) << (pos & WORD_POS_MASK);
@@ -78,6 +136,7 @@ class Intersection3
     const std::atomic<Word> * const m_words1;
     const std::atomic<Word> * const m_words2;
     const std::atomic<Word> * const m_words3;
+    const std::atomic<Word> * const m_summary1;
 
 public:
 
@@ -85,11 +144,13 @@ public:
             size_t item_dim,
             const std::atomic<Word> * words1,
             const std::atomic<Word> * words2,
-            const std::atomic<Word> * words3)
+            const std::atomic<Word> * words3,
+            const std::atomic<Word> * summary1 = nullptr)
         : m_word_dim(items_to_words(item_dim)),
           m_words1(words1),
           m_words2(words2),
-          m_words3(words3)
+          m_words3(words3),
+          m_summary1(summary1)
     {
         POMAGMA_ASSERT4(m_words1, "constructed Intersection3 with null words1");
         POMAGMA_ASSERT4(m_words2, "constructed Intersection3 with null words2");
@@ -97,6 +158,10 @@ public:
     }
 
     size_t word_dim () const { return m_word_dim; }
+    size_t skip (size_t quot) const
+    {
+        return m_summary1 ? skip_lines(m_summary1, quot, m_word_dim) : quot;
+    }
     bool get_bit (size_t pos) const
     {
         Word mask = Word(1) << (pos & WORD_POS_MASK);
@@ -117,6 +182,7 @@ class Intersection4
     const std::atomic<Word> * const m_words2;
     const std::atomic<Word> * const m_words3;
     const std::atomic<Word> * const m_words4;
+    const std::atomic<Word> * const m_summary1;
 
 public:
 
@@ -125,12 +191,14 @@ public:
             const std::atomic<Word> * words1,
             const std::atomic<Word> * words2,
             const std::atomic<Word> * words3,
-            const std::atomic<Word> * words4)
+            const std::atomic<Word> * words4,
+            const std::atomic<Word> * summary1 = nullptr)
         : m_word_dim(items_to_words(item_dim)),
           m_words1(words1),
           m_words2(words2),
           m_words3(words3),
-          m_words4(words4)
+          m_words4(words4),
+          m_summary1(summary1)
     {
         POMAGMA_ASSERT4(m_words1, "constructed Intersection4 with null words1");
         POMAGMA_ASSERT4(m_words2, "constructed Intersection4 with null words2");
@@ -139,6 +207,10 @@ public:
     }
 
     size_t word_dim () const { return m_word_dim; }
+    size_t skip (size_t quot) const
+    {
+        return m_summary1 ? skip_lines(m_summary1, quot, m_word_dim) : quot;
+    }
     bool get_bit (size_t pos) const
     {
         Word mask = Word(1) << (pos & WORD_POS_MASK);
@@ -174,6 +246,25 @@ protected:
                 "begin on empty pos: " << m_i);
     }
 
+    // begins at the first item >= begin
+    SetIterator (const Set & set, size_t begin)
+        : m_set(set)
+    {
+        m_quot = begin / BITS_PER_WORD;
+        if (m_quot >= m_set.word_dim()) { m_i = 0; return; }
+        m_rem = begin & WORD_POS_MASK;
+        m_word = m_set.get_word(m_quot) >> m_rem;
+        load_barrier();
+        if (m_word) {
+            for (; !(m_word & 1); ++m_rem, m_word >>= 1) {}
+            m_i = m_rem + BITS_PER_WORD * m_quot;
+        } else {
+            _next_block();
+        }
+        POMAGMA_ASSERT5(not ok() or m_set.get_bit(m_i),
+                "begin on empty pos: " << m_i);
+    }
+
 public:
 
     void next ();
@@ -188,9 +279,10 @@ private:
 template<class Set>
 void SetIterator<Set>::_next_block ()
 {
-    // traverse to next nonempty block
+    // traverse to next nonempty block, skipping summarized empty lines
     do {
-        if (++m_quot == m_set.word_dim()) { m_i = 0; return; }
+        m_quot = m_set.skip(m_quot + 1);
+        if (m_quot == m_set.word_dim()) { m_i = 0; return; }
         m_word = m_set.get_word(m_quot);
         load_barrier();
     } while (!m_word);
@@ -221,21 +313,32 @@ void SetIterator<Set>::next ()
 //----------------------------------------------------------------------------
 // Dense set - basically a bitfield
 
+// A summarized dense set additionally keeps two summaries, of lines that may
+// be nonempty and of lines that may be nonfull. Summaries are maintained by
+// insert, try_insert, remove and merge, and rebuilt by entire operations;
+// summarized sets must not be modified through bool_ref or raw_data.
+
 class DenseSet : noncopyable
 {
     const size_t m_item_dim;
     const size_t m_word_dim;
     std::atomic<Word> mutable * m_words;
     const bool m_alias;
+    const size_t m_summary_dim;
+    std::atomic<Word> * m_summary; // nonempty lines, then nonfull lines
 
 public:
 
-    DenseSet (size_t item_dim);
+    enum Layout { FLAT, SUMMARIZED };
+
+    DenseSet (size_t item_dim, Layout layout = FLAT);
     DenseSet (size_t item_dim, std::atomic<Word> * line)
         : m_item_dim(item_dim),
           m_word_dim(items_to_words(item_dim)),
           m_words(line),
-          m_alias(true)
+          m_alias(true),
+          m_summary_dim(0),
+          m_summary(nullptr)
     {
         POMAGMA_ASSERT_ALIGNED_(1, line);
     }
@@ -244,11 +347,18 @@ public:
         : m_item_dim(other.m_item_dim),
           m_word_dim(other.m_word_dim),
           m_words(other.m_words),
-          m_alias(other.m_alias)
+          m_alias(other.m_alias),
+          m_summary_dim(other.m_summary_dim),
+          m_summary(other.m_summary)
     {
         other.m_words = nullptr;
+        other.m_summary = nullptr;
+    }
+    ~DenseSet ()
+    {
+        if (not m_alias and m_words) free_blocks(m_words);
+        if (m_summary) free_blocks(m_summary);
     }
-    ~DenseSet () { if (not m_alias and m_words) free_blocks(m_words); }
     void operator= (const DenseSet & other);
     void init (std::atomic<Word> * line)
     {
@@ -276,8 +386,9 @@ public:
     }
 
     // attributes
-    bool empty () const; // not fast
+    bool empty () const; // not fast unless summarized
     size_t count_items () const; // supa-slow, try not to use
+    bool summarized () const { return m_summary; }
     size_t item_dim () const { return m_item_dim; }
     size_t word_dim () const { return m_word_dim; }
     size_t data_size_bytes () const { return sizeof(Word) * m_word_dim; }
@@ -301,6 +412,8 @@ public:
     void merge  (size_t i, size_t j);
     void insert_all ();
     size_t try_insert_one ();
+    size_t find_absent (size_t begin = 1) const; // returns 0 if full
+    void update_summary ();
 
     // entire operations (note that all are monotonic)
     void zero ();
@@ -328,10 +441,35 @@ public:
             const DenseSet & set3,
             const DenseSet & set4) const;
 
+    // these begin at the first item >= begin
+    Iterator iter_from (size_t begin) const;
+    Iterator2 iter_insn_from (size_t begin, const DenseSet & other) const;
+    Iterator3 iter_insn_from (
+            size_t begin,
+            const DenseSet & set2,
+            const DenseSet & set3) const;
+    Iterator4 iter_insn_from (
+            size_t begin,
+            const DenseSet & set2,
+            const DenseSet & set3,
+            const DenseSet & set4) const;
+
 private:
 
     bool_ref _bit (size_t i);
     bool _bit (size_t i, order_t = relaxed) const;
+
+    const std::atomic<Word> * _nonempty () const { return m_summary; }
+    const std::atomic<Word> * _nonfull () const
+    {
+        return m_summary + m_summary_dim;
+    }
+    Word _full_word (size_t quot) const;
+    bool _line_empty (size_t line) const;
+    bool _line_full (size_t line) const;
+    void _summarize_insert (size_t i);
+    void _summarize_remove (size_t i);
+    void _resummarize () { if (m_summary) update_summary(); }
 };
 
 inline bool_ref DenseSet::_bit (size_t i)
@@ -346,21 +484,113 @@ inline bool DenseSet::_bit (size_t i, order_t order) const
     return bool_ref::index(m_words, i, order);
 }
 
+inline Word DenseSet::_full_word (size_t quot) const
+{
+    Word full = ~Word(0);
+    if (quot == 0) {
+        full &= ~Word(1);
+    }
+    if (quot == m_word_dim - 1) {
+        size_t end = (m_item_dim + 1) % BITS_PER_WORD;
+        if (end) {
+            full &= (Word(1) << end) - 1;
+        }
+    }
+    return full;
+}
+
+inline bool DenseSet::_line_empty (size_t line) const
+{
+    const size_t begin = line * WORDS_PER_LINE;
+    const size_t end = min(begin + WORDS_PER_LINE, m_word_dim);
+    for (size_t quot = begin; quot < end; ++quot) {
+        if (m_words[quot].load()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool DenseSet::_line_full (size_t line) const
+{
+    const size_t begin = line * WORDS_PER_LINE;
+    const size_t end = min(begin + WORDS_PER_LINE, m_word_dim);
+    for (size_t quot = begin; quot < end; ++quot) {
+        if (m_words[quot].load() != _full_word(quot)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Clearing a summary bit races with concurrent updates that set it, so each
+// clear is followed by a recheck that restores the bit if needed.
+
+inline void DenseSet::_summarize_insert (size_t i)
+{
+    const size_t quot = i >> WORD_POS_SHIFT;
+    const size_t line = quot / WORDS_PER_LINE;
+    const size_t s = line >> WORD_POS_SHIFT;
+    const Word mask = Word(1) << (line & WORD_POS_MASK);
+    std::atomic<Word> & nonempty = m_summary[s];
+    std::atomic<Word> & nonfull = m_summary[m_summary_dim + s];
+
+    if (not (nonempty.load() & mask)) {
+        nonempty.fetch_or(mask);
+    }
+    if (m_words[quot].load() == _full_word(quot) and _line_full(line)) {
+        nonfull.fetch_and(~mask);
+        if (not _line_full(line)) {
+            nonfull.fetch_or(mask);
+        }
+    }
+}
+
+inline void DenseSet::_summarize_remove (size_t i)
+{
+    const size_t quot = i >> WORD_POS_SHIFT;
+    const size_t line = quot / WORDS_PER_LINE;
+    const size_t s = line >> WORD_POS_SHIFT;
+    const Word mask = Word(1) << (line & WORD_POS_MASK);
+    std::atomic<Word> & nonempty = m_summary[s];
+    std::atomic<Word> & nonfull = m_summary[m_summary_dim + s];
+
+    if (not (nonfull.load() & mask)) {
+        nonfull.fetch_or(mask);
+    }
+    if (not m_words[quot].load() and _line_empty(line)) {
+        nonempty.fetch_and(~mask);
+        if (not _line_empty(line)) {
+            nonempty.fetch_or(mask);
+        }
+    }
+}
+
 inline void DenseSet::insert (size_t i, order_t order)
 {
     POMAGMA_ASSERT4(not contains(i, order), "double insertion: " << i);
     _bit(i).one(order);
+    if (m_summary) {
+        _summarize_insert(i);
+    }
 }
 
 inline bool DenseSet::try_insert (size_t i)
 {
-    return not _bit(i).fetch_one(relaxed);
+    bool inserted = not _bit(i).fetch_one(relaxed);
+    if (inserted and m_summary) {
+        _summarize_insert(i);
+    }
+    return inserted;
 }
 
 inline void DenseSet::remove (size_t i, order_t order)
 {
     POMAGMA_ASSERT4(contains(i), "double removal: " << i);
     _bit(i).zero(order);
+    if (m_summary) {
+        _summarize_remove(i);
+    }
 }
 
 inline void DenseSet::merge (size_t i, size_t j __attribute__((unused)))
@@ -372,6 +602,9 @@ inline void DenseSet::merge (size_t i, size_t j __attribute__((unused)))
     POMAGMA_ASSERT4(contains(i), "merge rep not contained: " << i);
     POMAGMA_ASSERT4(contains(j), "merge dep not contained: " << j);
     _bit(i).zero();
+    if (m_summary) {
+        _summarize_remove(i);
+    }
 }
 
 //----------------------------------------------------------------------------
@@ -379,8 +612,19 @@ inline void DenseSet::merge (size_t i, size_t j __attribute__((unused)))
 
 struct DenseSet::Iterator : SetIterator<SimpleSet>
 {
-    Iterator (size_t item_dim, const std::atomic<Word> * words)
-        : SetIterator<SimpleSet>(SimpleSet(item_dim, words))
+    Iterator (
+            size_t item_dim,
+            const std::atomic<Word> * words,
+            const std::atomic<Word> * summary = nullptr)
+        : SetIterator<SimpleSet>(SimpleSet(item_dim, words, summary))
+    {
+    }
+    Iterator (
+            size_t item_dim,
+            const std::atomic<Word> * words,
+            size_t begin,
+            const std::atomic<Word> * summary)
+        : SetIterator<SimpleSet>(SimpleSet(item_dim, words, summary), begin)
     {
     }
 };
@@ -390,8 +634,21 @@ struct DenseSet::Iterator2 : SetIterator<Intersection2>
     Iterator2 (
             size_t item_dim,
             const std::atomic<Word> * words1,
-            const std::atomic<Word> * words2)
-        : SetIterator<Intersection2>(Intersection2(item_dim, words1, words2))
+            const std::atomic<Word> * words2,
+            const std::atomic<Word> * summary1 = nullptr)
+        : SetIterator<Intersection2>(
+                Intersection2(item_dim, words1, words2, summary1))
+    {
+    }
+    Iterator2 (
+            size_t item_dim,
+            const std::atomic<Word> * words1,
+            const std::atomic<Word> * words2,
+            size_t begin,
+            const std::atomic<Word> * summary1)
+        : SetIterator<Intersection2>(
+                Intersection2(item_dim, words1, words2, summary1),
+                begin)
     {
     }
 };
@@ -402,9 +659,22 @@ struct DenseSet::Iterator3 : SetIterator<Intersection3>
             size_t item_dim,
             const std::atomic<Word> * words1,
             const std::atomic<Word> * words2,
-            const std::atomic<Word> * words3)
+            const std::atomic<Word> * words3,
+            const std::atomic<Word> * summary1 = nullptr)
+        : SetIterator<Intersection3>(
+                Intersection3(item_dim, words1, words2, words3, summary1))
+    {
+    }
+    Iterator3 (
+            size_t item_dim,
+            const std::atomic<Word> * words1,
+            const std::atomic<Word> * words2,
+            const std::atomic<Word> * words3,
+            size_t begin,
+            const std::atomic<Word> * summary1)
         : SetIterator<Intersection3>(
-                Intersection3(item_dim, words1, words2, words3))
+                Intersection3(item_dim, words1, words2, words3, summary1),
+                begin)
     {
     }
 };
@@ -416,28 +686,59 @@ struct DenseSet::Iterator4 : SetIterator<Intersection4>
             const std::atomic<Word> * words1,
             const std::atomic<Word> * words2,
             const std::atomic<Word> * words3,
-            const std::atomic<Word> * words4)
+            const std::atomic<Word> * words4,
+            const std::atomic<Word> * summary1 = nullptr)
         : SetIterator<Intersection4>(
-                Intersection4(item_dim, words1, words2, words3, words4))
+                Intersection4(
+                    item_dim,
+                    words1,
+                    words2,
+                    words3,
+                    words4,
+                    summary1))
+    {
+    }
+    Iterator4 (
+            size_t item_dim,
+            const std::atomic<Word> * words1,
+            const std::atomic<Word> * words2,
+            const std::atomic<Word> * words3,
+            const std::atomic<Word> * words4,
+            size_t begin,
+            const std::atomic<Word> * summary1)
+        : SetIterator<Intersection4>(
+                Intersection4(
+                    item_dim,
+                    words1,
+                    words2,
+                    words3,
+                    words4,
+                    summary1),
+                begin)
     {
     }
 };
 
 inline DenseSet::Iterator DenseSet::iter () const
 {
-    return Iterator(m_item_dim, m_words);
+    return Iterator(m_item_dim, m_words, _nonempty());
 }
 
 inline DenseSet::Iterator2 DenseSet::iter_insn (const DenseSet & other) const
 {
-    return Iterator2(m_item_dim, m_words, other.m_words);
+    return Iterator2(m_item_dim, m_words, other.m_words, _nonempty());
 }
 
 inline DenseSet::Iterator3 DenseSet::iter_insn (
         const DenseSet & set2,
         const DenseSet & set3) const
 {
-    return Iterator3(m_item_dim, m_words, set2.m_words, set3.m_words);
+    return Iterator3(
+            m_item_dim,
+            m_words,
+            set2.m_words,
+            set3.m_words,
+            _nonempty());
 }
 
 inline DenseSet::Iterator4 DenseSet::iter_insn (
@@ -450,7 +751,50 @@ inline DenseSet::Iterator4 DenseSet::iter_insn (
             m_words,
             set2.m_words,
             set3.m_words,
-            set4.m_words);
+            set4.m_words,
+            _nonempty());
+}
+
+inline DenseSet::Iterator DenseSet::iter_from (size_t begin) const
+{
+    return Iterator(m_item_dim, m_words, begin, _nonempty());
+}
+
+inline DenseSet::Iterator2 DenseSet::iter_insn_from (
+        size_t begin,
+        const DenseSet & other) const
+{
+    return Iterator2(m_item_dim, m_words, other.m_words, begin, _nonempty());
+}
+
+inline DenseSet::Iterator3 DenseSet::iter_insn_from (
+        size_t begin,
+        const DenseSet & set2,
+        const DenseSet & set3) const
+{
+    return Iterator3(
+            m_item_dim,
+            m_words,
+            set2.m_words,
+            set3.m_words,
+            begin,
+            _nonempty());
+}
+
+inline DenseSet::Iterator4 DenseSet::iter_insn_from (
+        size_t begin,
+        const DenseSet & set2,
+        const DenseSet & set3,
+        const DenseSet & set4) const
+{
+    return Iterator4(
+            m_item_dim,
+            m_words,
+            set2.m_words,
+            set3.m_words,
+            set4.m_words,
+            begin,
+            _nonempty());
 }
 
 } // namespace concurrent
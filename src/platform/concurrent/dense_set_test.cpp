@@ -1,4 +1,5 @@
 #include <pomagma/platform/concurrent/dense_set.hpp>
+#include <algorithm>
 #include <vector>
 
 using namespace pomagma;
@@ -22,11 +23,11 @@ void test_sizes ()
     }
 }
 
-void test_basic (size_t size)
+void test_basic (size_t size, DenseSet::Layout layout)
 {
     POMAGMA_INFO("Testing DenseSet");
 
-    DenseSet set(size);
+    DenseSet set(size, layout);
     POMAGMA_ASSERT_EQ(set.count_items(), 0);
 
     POMAGMA_INFO("testing position insertion");
@@ -40,6 +41,8 @@ void test_basic (size_t size)
         set.remove(i);
     }
     POMAGMA_ASSERT_EQ(set.count_items(), 0);
+    POMAGMA_ASSERT(set.empty(), "set is not empty after removal");
+    set.validate();
 
     POMAGMA_INFO("testing iteration");
     for (Ob i = 1; i <= size / 2; ++i) {
@@ -98,10 +101,24 @@ void test_even (size_t size)
     }
 }
 
-void test_iterator (size_t size, rng_t & rng)
+// checks find_absent at every position against a brute-force scan
+void check_find_absent (const DenseSet & set, const std::vector<bool> & vect)
+{
+    const size_t size = vect.size();
+    std::vector<Ob> next_absent(size + 2, 0);
+    for (Ob i = size; i >= 1; --i) {
+        next_absent[i] = vect[i-1] ? next_absent[i + 1] : i;
+    }
+    next_absent[0] = next_absent[1];
+    for (Ob begin = 0; begin <= size + 1; ++begin) {
+        POMAGMA_ASSERT_EQ(set.find_absent(begin), next_absent[begin]);
+    }
+}
+
+void test_iterator (size_t size, rng_t & rng, DenseSet::Layout layout)
 {
     POMAGMA_INFO("Testing DenseSet::Iterator");
-    DenseSet set(size);
+    DenseSet set(size, layout);
     std::vector<bool> vect(size, false);
     size_t true_count = 0;
 
@@ -124,16 +141,82 @@ void test_iterator (size_t size, rng_t & rng)
         ++count;
     }
     POMAGMA_ASSERT_EQ(count, true_count);
+    set.validate();
+
+    for (size_t begin = 0; begin <= size + 1; begin += 1 + begin / 3) {
+        size_t expected = 0;
+        for (Ob i = std::max<size_t>(1, begin); i <= size; ++i) {
+            expected += vect[i-1];
+        }
+        size_t actual = 0;
+        for (auto i = set.iter_from(begin); i.ok(); i.next()) {
+            POMAGMA_ASSERT(*i >= begin, "item " << *i << " before " << begin);
+            POMAGMA_ASSERT(vect[*i - 1], "unexpected item " << *i);
+            ++actual;
+        }
+        POMAGMA_ASSERT_EQ(actual, expected);
+        actual = 0;
+        for (auto i = set.iter_insn_from(begin, set, set); i.ok(); i.next()) {
+            POMAGMA_ASSERT(*i >= begin, "item " << *i << " before " << begin);
+            ++actual;
+        }
+        POMAGMA_ASSERT_EQ(actual, expected);
+    }
+
+    check_find_absent(set, vect);
 }
 
-void test_operations (size_t size, rng_t & rng)
+// sets are full except for a few holes, so that find_absent must skip
+// long runs crossing word and summary boundaries
+void test_find_absent (size_t size, rng_t & rng, DenseSet::Layout layout)
+{
+    POMAGMA_INFO("Testing DenseSet::find_absent");
+    DenseSet set(size, layout);
+    std::vector<bool> vect(size, true);
+    set.insert_all();
+
+    check_find_absent(set, vect);
+
+    std::vector<Ob> holes;
+    const size_t line_items = BITS_PER_CACHE_LINE;
+    const size_t summary_items = BITS_PER_WORD * line_items;
+    for (size_t boundary : {BITS_PER_WORD, line_items, summary_items}) {
+        for (size_t b = boundary; b <= size + 1; b += boundary) {
+            holes.push_back(b - 1);
+            holes.push_back(b);
+            holes.push_back(b + 1);
+        }
+    }
+    std::uniform_int_distribution<Ob> random_ob(1, size);
+    for (size_t i = 0; i < 8; ++i) {
+        holes.push_back(random_ob(rng));
+    }
+    std::shuffle(holes.begin(), holes.end(), rng);
+
+    for (Ob hole : holes) {
+        if (1 <= hole and hole <= size and vect[hole - 1]) {
+            set.remove(hole);
+            vect[hole - 1] = false;
+            check_find_absent(set, vect);
+        }
+    }
+    for (Ob hole : holes) {
+        if (1 <= hole and hole <= size and not vect[hole - 1]) {
+            set.insert(hole);
+            vect[hole - 1] = true;
+            check_find_absent(set, vect);
+        }
+    }
+}
+
+void test_operations (size_t size, rng_t & rng, DenseSet::Layout layout)
 {
     POMAGMA_INFO("Testing DenseSet operations");
 
-    DenseSet x(size);
-    DenseSet y(size);
+    DenseSet x(size, layout);
+    DenseSet y(size, layout);
     DenseSet expected(size);
-    DenseSet actual(size);
+    DenseSet actual(size, layout);
 
     std::bernoulli_distribution randomly_insert(0.5);
     for (size_t i = 1; i <= size; ++i) {
@@ -151,6 +234,7 @@ void test_operations (size_t size, rng_t & rng)
     }
     actual.insert_all();
     POMAGMA_ASSERT(actual == expected, "insert_all is wrong");
+    actual.validate();
 
     POMAGMA_INFO("testing try_insert_one");
     expected.zero();
@@ -174,6 +258,7 @@ void test_operations (size_t size, rng_t & rng)
         Ob zero = actual.try_insert_one();
         POMAGMA_ASSERT_EQ(zero, 0);
     }
+    actual.validate();
 
     POMAGMA_INFO("testing union");
     expected.zero();
@@ -209,9 +294,9 @@ void test_operations (size_t size, rng_t & rng)
     DenseSet expected_rep(size);
     DenseSet expected_dep(size);
     DenseSet expected_diff(size);
-    DenseSet actual_rep(size);
-    DenseSet actual_dep(size);
-    DenseSet actual_diff(size);
+    DenseSet actual_rep(size, layout);
+    DenseSet actual_dep(size, layout);
+    DenseSet actual_diff(size, layout);
     expected_rep.set_union(x, y);
     for (Ob i = 1; i <= size; ++i) {
         if (y.contains(i) and not x.contains(i)) { expected_diff.insert(i); }
@@ -250,6 +335,9 @@ void test_operations (size_t size, rng_t & rng)
     actual_rep.ensure(y, actual_diff);
     POMAGMA_ASSERT(actual_rep == expected_rep, "merge rep is wrong");
     POMAGMA_ASSERT(actual_diff == expected_diff, "merge diff is wrong");
+    actual_rep.validate();
+    actual_dep.validate();
+    actual_diff.validate();
 }
 
 int main ()
@@ -258,22 +346,25 @@ int main ()
 
     test_sizes();
 
-    for (size_t i = 0; i < 4; ++i) {
-        test_basic(i + (1 << 15));
-    }
+    for (auto layout : {DenseSet::FLAT, DenseSet::SUMMARIZED}) {
+        for (size_t i = 0; i < 4; ++i) {
+            test_basic(i + (1 << 15), layout);
+        }
 
-    for (size_t size = 0; size < 100; ++size) {
-        test_even(size);
-        test_iterator(size, rng);
-        test_operations(size, rng);
-    }
+        for (size_t size = 0; size < 100; ++size) {
+            test_even(size);
+            test_iterator(size, rng, layout);
+            test_operations(size, rng, layout);
+        }
 
-    for (size_t exponent = 1; exponent <= 10; ++exponent) {
-        size_t size = (1 << exponent) - 1;
-        test_basic(size);
-        test_even(size);
-        test_iterator(size, rng);
-        test_operations(size, rng);
+        for (size_t exponent = 1; exponent <= 14; ++exponent) {
+            size_t size = (1 << exponent) - 1;
+            test_find_absent(size, rng, layout);
+            test_basic(size, layout);
+            test_even(size);
+            test_iterator(size, rng, layout);
+            test_operations(size, rng, layout);
+        }
     }
 
     return 0;
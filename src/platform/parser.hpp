@@ -8,6 +8,9 @@ namespace pomagma
 {
 
 
+// Tokens are scanned in place from the expression, and functions are resolved
+// by a single probe of the signature's SymbolTable, so parsing a term does not
+// allocate. The expression must outlive parsing.
 template<class Reducer>
 class Parser
 {
@@ -15,59 +18,71 @@ public:
 
     // Parser agrees not to touch reducer until after construction
     Parser (Signature & signature, Reducer & reducer)
-        : m_signature(signature),
-          m_reducer(reducer)
+        : m_symbols(signature.symbols()),
+          m_reducer(reducer),
+          m_expression(nullptr),
+          m_pos(nullptr),
+          m_end(nullptr)
     {
     }
 
     void begin (const std::string & expression)
     {
-        m_stream.str(expression);
-        m_stream.clear();
+        m_expression = & expression;
+        m_pos = expression.data();
+        m_end = m_pos + expression.size();
     }
 
     std::string parse_token ()
     {
-        std::string token;
-        POMAGMA_ASSERT(std::getline(m_stream, token, ' '),
-            "expression terminated prematurely: " << m_stream.str());
-        return token;
+        const char * token;
+        size_t size;
+        scan(token, size);
+        return std::string(token, size);
     }
 
     typedef typename Reducer::Term Term;
     Term parse_term ()
     {
-        std::string token = parse_token();
-        if (const auto * fun = m_signature.nullary_function(token)) {
-            return m_reducer.reduce(token, fun);
-        } else if (const auto * fun = m_signature.injective_function(token)) {
-            Term key = parse_term();
-            return m_reducer.reduce(token, fun, key);
-        } else if (const auto * fun = m_signature.binary_function(token)) {
-            Term lhs = parse_term();
-            Term rhs = parse_term();
-            return m_reducer.reduce(token, fun, lhs, rhs);
-        } else if (const auto * fun = m_signature.symmetric_function(token)) {
-            Term lhs = parse_term();
-            Term rhs = parse_term();
-            return m_reducer.reduce(token, fun, lhs, rhs);
-        // TODO
-        //} else if (const auto * rel = m_signature.binary_relation(token)) {
-        //    Term lhs = parse_term();
-        //    Term rhs = parse_term();
-        //    return m_reducer.reduce(token, rel, lhs, rhs);
-        } else {
-            POMAGMA_ERROR(
-                "unrecognized token '" << token << "' in:" << m_stream.str());
-            //return Term();
+        const char * token;
+        size_t size;
+        scan(token, size);
+        const SymbolTable::Symbol * symbol = m_symbols.find(token, size);
+        POMAGMA_ASSERT(symbol,
+            "unrecognized token '" << std::string(token, size) << "' in:"
+            << * m_expression);
+        const std::string & name = symbol->name;
+        switch (symbol->arity) {
+            case SymbolTable::NULLARY: {
+                return m_reducer.reduce(name, * symbol->nullary);
+            } break;
+
+            case SymbolTable::INJECTIVE: {
+                Term key = parse_term();
+                return m_reducer.reduce(name, * symbol->injective, key);
+            } break;
+
+            case SymbolTable::BINARY: {
+                Term lhs = parse_term();
+                Term rhs = parse_term();
+                return m_reducer.reduce(name, * symbol->binary, lhs, rhs);
+            } break;
+
+            case SymbolTable::SYMMETRIC: {
+                Term lhs = parse_term();
+                Term rhs = parse_term();
+                return m_reducer.reduce(name, * symbol->symmetric, lhs, rhs);
+            } break;
+            // TODO parse binary relations
         }
+        POMAGMA_ERROR("unknown arity");
     }
 
     void end ()
     {
-        std::string token;
-        POMAGMA_ASSERT(not std::getline(m_stream, token, ' '),
-            "unexpected token '" << token << "' in: " << m_stream.str());
+        POMAGMA_ASSERT(m_pos == m_end,
+            "unexpected token '" << std::string(m_pos, m_end) << "' in: "
+            << * m_expression);
     }
 
     Term parse (const std::string & expression)
@@ -80,9 +95,26 @@ public:
 
 private:
 
-    Signature & m_signature;
+    // tokens are separated by single spaces
+    void scan (const char * & token, size_t & size)
+    {
+        POMAGMA_ASSERT(m_pos != m_end,
+            "expression terminated prematurely: " << * m_expression);
+        token = m_pos;
+        while (m_pos != m_end and * m_pos != ' ') {
+            ++m_pos;
+        }
+        size = m_pos - token;
+        if (m_pos != m_end) {
+            ++m_pos;
+        }
+    }
+
+    const SymbolTable & m_symbols;
     Reducer & m_reducer;
-    std::istringstream m_stream;
+    const std::string * m_expression;
+    const char * m_pos;
+    const char * m_end;
 };
 
 
@@ -10,6 +10,9 @@
 #include "util.hpp"
 #include "signature.hpp"
 #include "threading.hpp"
+#include "alias_table.hpp"
+#include <memory>
+#include <thread>
 
 namespace pomagma
 {
@@ -28,36 +31,63 @@ class Sampler : noncopyable
     float m_binary_prob;
     float m_symmetric_prob;
 
+    // alias tables are built once on load and are read-only thereafter
+    AliasTable<const NullaryFunction *> m_nullary_table;
+    AliasTable<const InjectiveFunction *> m_injective_table;
+    AliasTable<const BinaryFunction *> m_binary_table;
+    AliasTable<const SymmetricFunction *> m_symmetric_table;
+
     enum Arity { NULLARY, INJECTIVE, BINARY, SYMMETRIC };
-    class BoundedSampler
+    struct BoundedSampler
     {
-        const float injective;
-        const float binary;
-        const float symmetric;
-        const float total;
-        const float compound_injective;
-        const float compound_binary;
-        const float compound_symmetric;
-        const float compound_total;
-
-    public:
-
-        BoundedSampler (); // unused
+        float total;
+        AliasTable<Arity> arity;
+        AliasTable<Arity> compound_arity;
+
         BoundedSampler (const Sampler & sampler);
         BoundedSampler (const Sampler & sampler, const BoundedSampler & prev);
-        void operator= (const BoundedSampler &) { POMAGMA_ERROR("unused"); }
-
-        Arity sample_arity (rng_t & rng) const;
-        Arity sample_compound_arity (rng_t & rng) const;
-    } __attribute__((aligned(64)));
-    mutable std::vector<BoundedSampler> m_bounded_samplers;
-    mutable SharedMutex m_bounded_samplers_mutex;
-    const BoundedSampler & bounded_sampler (size_t max_depth) const;
+    };
 
-    mutable std::atomic<uint_fast64_t> m_sample_count;
-    mutable std::atomic<uint_fast64_t> m_reject_count;
-    mutable std::atomic<uint_fast64_t> m_arity_sample_count;
-    mutable std::atomic<uint_fast64_t> m_compound_arity_sample_count;
+    // bounded samplers converge with depth; deeper samplers are truncated
+    enum { MAX_BOUNDED_DEPTH = 256 };
+    std::vector<BoundedSampler> m_bounded_samplers;
+    const BoundedSampler & bounded_sampler (size_t max_depth) const
+    {
+        POMAGMA_ASSERT3(not m_bounded_samplers.empty(), "sampler not loaded");
+        return m_bounded_samplers[
+            std::min(max_depth, m_bounded_samplers.size() - 1)];
+    }
+
+    // each thread counts in its own padded block;
+    // counts are only aggregated when logging stats
+    struct Stats
+    {
+        std::atomic<uint_fast64_t> sample_count;
+        std::atomic<uint_fast64_t> reject_count;
+        std::atomic<uint_fast64_t> arity_sample_count;
+        std::atomic<uint_fast64_t> compound_arity_sample_count;
+
+        Stats ()
+            : sample_count(0),
+              reject_count(0),
+              arity_sample_count(0),
+              compound_arity_sample_count(0)
+        {
+        }
+
+        // only the owning thread writes, so no atomic increment is needed
+        static void increment (std::atomic<uint_fast64_t> & count)
+        {
+            count.store(count.load(relaxed) + 1, relaxed);
+        }
+
+        char padding[64]; // avoid false sharing among heap-allocated stats
+    };
+    const uint64_t m_id;
+    mutable std::mutex m_stats_mutex;
+    mutable std::unordered_map<std::thread::id, std::unique_ptr<Stats>>
+        m_stats;
+    Stats & local_stats () const;
 
 public:
 
@@ -81,6 +111,8 @@ private:
     void set_prob (const BinaryFunction * fun, float prob);
     void set_prob (const SymmetricFunction * fun, float prob);
 
+    void build_tables ();
+
     template<class Function>
     bool try_set_prob_ (
             const std::unordered_map<std::string, Function *> & funs,
@@ -9,12 +9,11 @@ namespace pomagma
 //----------------------------------------------------------------------------
 // Construction
 
+static std::atomic<uint64_t> g_sampler_count(0);
+
 Sampler::Sampler (Signature & signature)
     : m_signature(signature),
-      m_sample_count(0),
-      m_reject_count(0),
-      m_arity_sample_count(0),
-      m_compound_arity_sample_count(0)
+      m_id(++g_sampler_count)
 {
 }
 
@@ -39,11 +38,44 @@ void Sampler::validate () const
 
 void Sampler::log_stats () const
 {
-    const Sampler & sampler = * this;
-    POMAGMA_PRINT(sampler.m_sample_count.load());
-    POMAGMA_PRINT(sampler.m_reject_count.load());
-    POMAGMA_PRINT(sampler.m_arity_sample_count.load());
-    POMAGMA_PRINT(sampler.m_compound_arity_sample_count.load());
+    uint_fast64_t sample_count = 0;
+    uint_fast64_t reject_count = 0;
+    uint_fast64_t arity_sample_count = 0;
+    uint_fast64_t compound_arity_sample_count = 0;
+    {
+        std::unique_lock<std::mutex> lock(m_stats_mutex);
+        for (const auto & pair : m_stats) {
+            const Stats & stats = * pair.second;
+            sample_count += stats.sample_count.load(relaxed);
+            reject_count += stats.reject_count.load(relaxed);
+            arity_sample_count += stats.arity_sample_count.load(relaxed);
+            compound_arity_sample_count +=
+                stats.compound_arity_sample_count.load(relaxed);
+        }
+    }
+    POMAGMA_PRINT(sample_count);
+    POMAGMA_PRINT(reject_count);
+    POMAGMA_PRINT(arity_sample_count);
+    POMAGMA_PRINT(compound_arity_sample_count);
+}
+
+inline Sampler::Stats & Sampler::local_stats () const
+{
+    // each thread caches the stats of the sampler it last used
+    static thread_local uint64_t t_sampler_id = 0;
+    static thread_local Stats * t_stats = nullptr;
+    if (likely(t_sampler_id == m_id)) {
+        return * t_stats;
+    }
+
+    std::unique_lock<std::mutex> lock(m_stats_mutex);
+    auto & stats = m_stats[std::this_thread::get_id()];
+    if (not stats) {
+        stats.reset(new Stats());
+    }
+    t_sampler_id = m_id;
+    t_stats = stats.get();
+    return * t_stats;
 }
 
 template<class T>
@@ -56,26 +88,6 @@ inline float sum (const std::unordered_map<T, float> & map)
     return result;
 }
 
-template<class Key>
-inline Key sample (
-        const std::unordered_map<Key, float> & probs,
-        float total,
-        rng_t & rng)
-{
-    std::uniform_real_distribution<float> random_point(0, total);
-    while (true) {
-        float r = random_point(rng);
-        for (const auto & pair : probs) {
-            Key key = pair.first;
-            float prob = pair.second;
-            if ((r -= prob) < 0) {
-                return key;
-            }
-        }
-        // occasionally fall through due to rounding error
-    }
-}
-
 inline void Sampler::set_prob (const NullaryFunction * fun, float prob)
 {
     m_nullary_probs[fun] = prob;
@@ -123,7 +135,42 @@ void Sampler::set_prob (const std::string & name, float prob)
         try_set_prob_(m_signature.binary_functions(), name, prob) or
         try_set_prob_(m_signature.symmetric_functions(), name, prob);
     POMAGMA_ASSERT(found, "failed to set prob of function: " << name);
+}
+
+template<class Function>
+inline void build_table (
+        AliasTable<const Function *> & table,
+        const std::unordered_map<const Function *, float> & probs)
+{
+    std::vector<std::pair<const Function *, float>> weights(
+        probs.begin(),
+        probs.end());
+    table.init(weights);
+}
+
+void Sampler::build_tables ()
+{
+    POMAGMA_INFO("Building sampler tables");
+
+    build_table(m_nullary_table, m_nullary_probs);
+    build_table(m_injective_table, m_injective_probs);
+    build_table(m_binary_table, m_binary_probs);
+    build_table(m_symmetric_table, m_symmetric_probs);
+
+    // grow bounded samplers until their total mass converges
+    const float tol = 1e-6;
     m_bounded_samplers.clear();
+    m_bounded_samplers.push_back(BoundedSampler(* this));
+    while (m_bounded_samplers.size() < MAX_BOUNDED_DEPTH) {
+        const BoundedSampler & prev = m_bounded_samplers.back();
+        BoundedSampler next(* this, prev);
+        bool converged = next.total - prev.total <= tol * next.total;
+        m_bounded_samplers.push_back(next);
+        if (converged) {
+            break;
+        }
+    }
+    POMAGMA_DEBUG("built " << m_bounded_samplers.size() << " bounded samplers");
 }
 
 void Sampler::load (const std::string & language_file)
@@ -143,111 +190,40 @@ void Sampler::load (const std::string & language_file)
         POMAGMA_DEBUG("setting P(" << term.name() << ") = " << term.weight());
         set_prob(term.name(), term.weight());
     }
+
+    build_tables();
 }
 
 //----------------------------------------------------------------------------
 // Sampling
 
-// unused
-Sampler::BoundedSampler::BoundedSampler ()
-    : injective(0),
-      binary(0),
-      symmetric(0),
-      total(0),
-      compound_injective(0),
-      compound_binary(0),
-      compound_symmetric(0),
-      compound_total(0)
-{
-    POMAGMA_ERROR("unused");
-}
-
 // base case
 Sampler::BoundedSampler::BoundedSampler (
         const Sampler & sampler)
-    : injective(0),
-      binary(0),
-      symmetric(0),
-      total(sampler.m_nullary_prob),
-      compound_injective(0),
-      compound_binary(0),
-      compound_symmetric(0),
-      compound_total(0)
+    : total(sampler.m_nullary_prob)
 {
+    arity.init({{NULLARY, sampler.m_nullary_prob}});
 }
 
 // induction step
 Sampler::BoundedSampler::BoundedSampler (
         const Sampler & sampler,
         const BoundedSampler & prev)
-    : injective(sampler.m_injective_prob * prev.total),
-      binary(sampler.m_binary_prob * (prev.total * prev.total)),
-      symmetric(sampler.m_symmetric_prob * (prev.total * prev.total)),
-      total(sampler.m_nullary_prob + injective + binary + symmetric),
-      compound_injective(sampler.m_injective_prob),
-      compound_binary(sampler.m_binary_prob * prev.total),
-      compound_symmetric(sampler.m_symmetric_prob * prev.total),
-      compound_total(compound_injective +
-                     compound_binary +
-                     compound_symmetric)
-{
-}
-
-inline Sampler::Arity Sampler::BoundedSampler::sample_arity (rng_t & rng) const
 {
-    POMAGMA_ASSERT3(total > 0, "zero probability mass");
-    POMAGMA_ASSERT4(total > injective + binary + symmetric,
-            "implementation assumes P(nullary) > 0");
-
-    std::uniform_real_distribution<float> random_point(0, total);
-    float r = random_point(rng);
-    // FIXME valgrind complains about the following lines,
-    // "Conditional jump or move depends on uninitialised value(s)"
-    if (binary and (r -= binary) < 0) return BINARY;
-    if (symmetric and (r -= symmetric) < 0) return SYMMETRIC;
-    if (injective and (r -= injective) < 0) return INJECTIVE;
-    return NULLARY;
-}
-
-inline Sampler::Arity Sampler::BoundedSampler::sample_compound_arity (
-        rng_t & rng) const
-{
-    POMAGMA_ASSERT3(compound_total > 0, "zero probability mass");
-    POMAGMA_ASSERT4(compound_binary > 0,
-            "implementation assumes P(compound_binary) > 0");
-
-    std::uniform_real_distribution<float> random_point(0, compound_total);
-    float r = random_point(rng);
-    // FIXME valgrind complains about the following lines,
-    // "Conditional jump or move depends on uninitialised value(s)"
-    if (symmetric and (r -= compound_symmetric) < 0) return SYMMETRIC;
-    if (injective and (r -= compound_injective) < 0) return INJECTIVE;
-    return BINARY;
-}
-
-inline const Sampler::BoundedSampler & Sampler::bounded_sampler (
-        size_t max_depth) const
-{
-    // this may safely overgrow the cache by (thread_count - 1) items
-    while (true) {
-        {
-            SharedMutex::SharedLock lock(m_bounded_samplers_mutex);
-            if (likely(max_depth < m_bounded_samplers.size())) {
-                // use cached value
-                return m_bounded_samplers[max_depth];
-            }
-        }
-        {
-            // grow cache
-            SharedMutex::UniqueLock lock(m_bounded_samplers_mutex);
-            if (unlikely(m_bounded_samplers.empty())) {
-                m_bounded_samplers.push_back(BoundedSampler(*this));
-            } else {
-                m_bounded_samplers.push_back(
-                        BoundedSampler(*this, m_bounded_samplers.back()));
-            }
-        }
-    }
+    const float injective = sampler.m_injective_prob * prev.total;
+    const float binary = sampler.m_binary_prob * (prev.total * prev.total);
+    const float symmetric =
+        sampler.m_symmetric_prob * (prev.total * prev.total);
+    total = sampler.m_nullary_prob + injective + binary + symmetric;
+    arity.init({
+        {NULLARY, sampler.m_nullary_prob},
+        {INJECTIVE, injective},
+        {BINARY, binary},
+        {SYMMETRIC, symmetric}});
+    compound_arity.init({
+        {INJECTIVE, sampler.m_injective_prob},
+        {BINARY, sampler.m_binary_prob * prev.total},
+        {SYMMETRIC, sampler.m_symmetric_prob * prev.total}});
 }
 
 Ob Sampler::try_insert_random (rng_t & rng, Policy & policy) const
@@ -260,10 +236,10 @@ Ob Sampler::try_insert_random (rng_t & rng, Policy & policy) const
                 ob = insert_random_compound(ob, depth, rng, policy);
             }
         } catch (ObInsertedException e) {
-            m_sample_count += 1;
+            Stats::increment(local_stats().sample_count);
             return e.inserted;
         } catch (ObRejectedException) {
-            m_reject_count += 1;
+            Stats::increment(local_stats().reject_count);
             continue;
         } catch (InsertionFailedException e) {
             return 0;
@@ -290,8 +266,8 @@ inline Ob Sampler::insert_random_compound (
 {
     POMAGMA_ASSERT3(max_depth > 0, "cannot make compound with max_depth 0");
     const BoundedSampler & sampler = bounded_sampler(max_depth);
-    Arity arity = sampler.sample_compound_arity(rng);
-    m_compound_arity_sample_count += 1;
+    Arity arity = sampler.compound_arity.sample(rng);
+    Stats::increment(local_stats().compound_arity_sample_count);
     //POMAGMA_DEBUG1("compound_arity = " << g_sampler_arity_names[arity]);
     switch (arity) {
         case NULLARY: {
@@ -325,8 +301,8 @@ inline Ob Sampler::insert_random (
         Policy & policy) const
 {
     const BoundedSampler & sampler = bounded_sampler(max_depth);
-    Arity arity = sampler.sample_arity(rng);
-    m_arity_sample_count += 1;
+    Arity arity = sampler.arity.sample(rng);
+    Stats::increment(local_stats().arity_sample_count);
     //POMAGMA_DEBUG1("arity = " << g_sampler_arity_names[arity]);
     switch (arity) {
         case NULLARY: {
@@ -362,7 +338,7 @@ inline Ob Sampler::insert_random_nullary (
         rng_t & rng,
         Policy & policy) const
 {
-    auto & fun = * sample(m_nullary_probs, m_nullary_prob, rng);
+    auto & fun = * m_nullary_table.sample(rng);
     return policy.sample(fun);
 }
 
@@ -371,7 +347,7 @@ inline Ob Sampler::insert_random_injective (
         rng_t & rng,
         Policy & policy) const
 {
-    auto & fun = * sample(m_injective_probs, m_injective_prob, rng);
+    auto & fun = * m_injective_table.sample(rng);
     return policy.sample(fun, key);
 }
 
@@ -381,7 +357,7 @@ inline Ob Sampler::insert_random_binary (
         rng_t & rng,
         Policy & policy) const
 {
-    auto & fun = * sample(m_binary_probs, m_binary_prob, rng);
+    auto & fun = * m_binary_table.sample(rng);
     return policy.sample(fun, lhs, rhs);
 }
 
@@ -391,7 +367,7 @@ inline Ob Sampler::insert_random_symmetric (
         rng_t & rng,
         Policy & policy) const
 {
-    auto & fun = * sample(m_symmetric_probs, m_symmetric_prob, rng);
+    auto & fun = * m_symmetric_table.sample(rng);
     return policy.sample(fun, lhs, rhs);
 }
 
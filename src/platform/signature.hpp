@@ -1,6 +1,7 @@
 #pragma once
 
 #include "util.hpp"
+#include "symbol_table.hpp"
 #include <unordered_map>
 
 namespace pomagma
@@ -22,6 +23,7 @@ class Signature : noncopyable
     std::unordered_map<std::string, InjectiveFunction *> m_injective_functions;
     std::unordered_map<std::string, BinaryFunction *> m_binary_functions;
     std::unordered_map<std::string, SymmetricFunction *> m_symmetric_functions;
+    SymbolTable m_symbols;
 
 public:
 
@@ -61,6 +63,9 @@ public:
     const std::unordered_map<std::string, SymmetricFunction *> &
         symmetric_functions () const;
 
+    // all functions, for single-probe lookup by parsers
+    const SymbolTable & symbols () const { return m_symbols; }
+
     std::string negate (const std::string & name)
     {
         if (name == "LESS") return "NLESS";
@@ -87,6 +92,7 @@ inline void Signature::clear ()
     m_injective_functions.clear();
     m_binary_functions.clear();
     m_symmetric_functions.clear();
+    m_symbols.clear();
     m_carrier = nullptr;
 }
 
@@ -109,28 +115,40 @@ inline void Signature::declare (
         const std::string & name,
         NullaryFunction & fun)
 {
-    m_nullary_functions.insert(std::make_pair(name, & fun));
+    auto inserted = m_nullary_functions.insert(std::make_pair(name, & fun));
+    if (inserted.second) {
+        m_symbols.insert(name, inserted.first->second);
+    }
 }
 
 inline void Signature::declare (
         const std::string & name,
         InjectiveFunction & fun)
 {
-    m_injective_functions.insert(std::make_pair(name, & fun));
+    auto inserted = m_injective_functions.insert(std::make_pair(name, & fun));
+    if (inserted.second) {
+        m_symbols.insert(name, inserted.first->second);
+    }
 }
 
 inline void Signature::declare (
         const std::string & name,
         BinaryFunction & fun)
 {
-    m_binary_functions.insert(std::make_pair(name, & fun));
+    auto inserted = m_binary_functions.insert(std::make_pair(name, & fun));
+    if (inserted.second) {
+        m_symbols.insert(name, inserted.first->second);
+    }
 }
 
 inline void Signature::declare (
         const std::string & name,
         SymmetricFunction & fun)
 {
-    m_symmetric_functions.insert(std::make_pair(name, & fun));
+    auto inserted = m_symmetric_functions.insert(std::make_pair(name, & fun));
+    if (inserted.second) {
+        m_symbols.insert(name, inserted.first->second);
+    }
 }
 
 
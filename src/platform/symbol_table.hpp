@@ -0,0 +1,154 @@
+#pragma once
+
+#include "util.hpp"
+#include <cstring>
+#include <vector>
+
+namespace pomagma
+{
+
+class NullaryFunction;
+class InjectiveFunction;
+class BinaryFunction;
+class SymmetricFunction;
+
+// A perfect hash table from function names to functions.
+// The table is rebuilt on every insertion, which is cheap for signatures of
+// a few dozen symbols, so that lookup is always a single hash and probe.
+// Functions are referenced through their slots in Signature, so that
+// Signature::replace need not update the table.
+class SymbolTable
+{
+public:
+
+    enum Arity { NULLARY, INJECTIVE, BINARY, SYMMETRIC };
+
+    struct Symbol
+    {
+        std::string name;
+        Arity arity;
+        NullaryFunction * const * nullary;
+        InjectiveFunction * const * injective;
+        BinaryFunction * const * binary;
+        SymmetricFunction * const * symmetric;
+    };
+
+    SymbolTable () : m_seed(0), m_shift(64), m_slots(1, 0) {}
+
+    void clear ()
+    {
+        m_symbols.clear();
+        m_seed = 0;
+        m_shift = 64;
+        m_slots.assign(1, 0);
+    }
+
+    void insert (const std::string & name, NullaryFunction * const & fun)
+    {
+        Symbol symbol = {name, NULLARY, & fun, nullptr, nullptr, nullptr};
+        insert(symbol);
+    }
+    void insert (const std::string & name, InjectiveFunction * const & fun)
+    {
+        Symbol symbol = {name, INJECTIVE, nullptr, & fun, nullptr, nullptr};
+        insert(symbol);
+    }
+    void insert (const std::string & name, BinaryFunction * const & fun)
+    {
+        Symbol symbol = {name, BINARY, nullptr, nullptr, & fun, nullptr};
+        insert(symbol);
+    }
+    void insert (const std::string & name, SymmetricFunction * const & fun)
+    {
+        Symbol symbol = {name, SYMMETRIC, nullptr, nullptr, nullptr, & fun};
+        insert(symbol);
+    }
+
+    // returns nullptr if name is not a function symbol
+    const Symbol * find (const char * name, size_t size) const
+    {
+        uint32_t index = m_slots[slot(m_seed, m_shift, name, size)];
+        if (index) {
+            const Symbol & symbol = m_symbols[index - 1];
+            if (symbol.name.size() == size and
+                memcmp(symbol.name.data(), name, size) == 0)
+            {
+                return & symbol;
+            }
+        }
+        return nullptr;
+    }
+    const Symbol * find (const std::string & name) const
+    {
+        return find(name.data(), name.size());
+    }
+
+    size_t size () const { return m_symbols.size(); }
+
+private:
+
+    static size_t slot (
+            uint64_t seed,
+            size_t shift,
+            const char * name,
+            size_t size)
+    {
+        // FNV-1a, seeded; the top bits of the hash index the slots
+        uint64_t hash = 0xcbf29ce484222325UL ^ seed;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ static_cast<unsigned char>(name[i]))
+                 * 0x100000001b3UL;
+        }
+        return shift < 64 ? (hash * 11400714819323198485ULL) >> shift : 0;
+    }
+
+    void insert (const Symbol & symbol)
+    {
+        POMAGMA_ASSERT(find(symbol.name) == nullptr,
+            "duplicate symbol: " << symbol.name);
+        m_symbols.push_back(symbol);
+        rebuild();
+    }
+
+    // searches for a collision-free seed, growing the table as needed
+    void rebuild ()
+    {
+        const size_t count = m_symbols.size();
+        size_t bits = 0;
+        while ((1UL << bits) < 2 * count) {
+            ++bits;
+        }
+        for (;; ++bits) {
+            const size_t shift = 64 - bits;
+            for (uint64_t seed = 0; seed < 256; ++seed) {
+                if (try_build(seed, shift)) {
+                    return;
+                }
+            }
+        }
+    }
+
+    bool try_build (uint64_t seed, size_t shift)
+    {
+        m_slots.assign(shift < 64 ? 1UL << (64 - shift) : 1, 0);
+        for (size_t i = 0; i < m_symbols.size(); ++i) {
+            const std::string & name = m_symbols[i].name;
+            uint32_t & index = m_slots[
+                slot(seed, shift, name.data(), name.size())];
+            if (index) {
+                return false;
+            }
+            index = 1 + i;
+        }
+        m_seed = seed;
+        m_shift = shift;
+        return true;
+    }
+
+    std::vector<Symbol> m_symbols;
+    uint64_t m_seed;
+    size_t m_shift;
+    std::vector<uint32_t> m_slots; // 1-based indices into m_symbols, 0 = none
+};
+
+} // namespace pomagma
@@ -0,0 +1,70 @@
+#include <pomagma/platform/util.hpp>
+#include <pomagma/platform/symbol_table.hpp>
+
+using namespace pomagma;
+
+void test_symbol_table (size_t symbol_count)
+{
+    POMAGMA_INFO("Testing symbol table of " << symbol_count << " symbols");
+
+    // the table only takes addresses of slots, so no functions are needed
+    std::vector<NullaryFunction *> nullary_slots(symbol_count, nullptr);
+    std::vector<BinaryFunction *> binary_slots(symbol_count, nullptr);
+
+    SymbolTable symbols;
+    for (size_t i = 0; i < symbol_count; ++i) {
+        std::ostringstream name;
+        name << "N" << i;
+        symbols.insert(name.str(), nullary_slots[i]);
+    }
+    for (size_t i = 0; i < symbol_count; ++i) {
+        std::ostringstream name;
+        name << "B" << i;
+        symbols.insert(name.str(), binary_slots[i]);
+    }
+    POMAGMA_ASSERT_EQ(symbols.size(), 2 * symbol_count);
+
+    for (size_t i = 0; i < symbol_count; ++i) {
+        std::ostringstream name;
+        name << "N" << i;
+        const SymbolTable::Symbol * symbol = symbols.find(name.str());
+        POMAGMA_ASSERT(symbol, "missing symbol " << name.str());
+        POMAGMA_ASSERT(symbol->arity == SymbolTable::NULLARY, "bad arity");
+        POMAGMA_ASSERT(symbol->nullary == & nullary_slots[i], "wrong slot");
+    }
+    for (size_t i = 0; i < symbol_count; ++i) {
+        std::ostringstream name;
+        name << "B" << i;
+        const SymbolTable::Symbol * symbol = symbols.find(name.str());
+        POMAGMA_ASSERT(symbol, "missing symbol " << name.str());
+        POMAGMA_ASSERT(symbol->arity == SymbolTable::BINARY, "bad arity");
+        POMAGMA_ASSERT(symbol->binary == & binary_slots[i], "wrong slot");
+    }
+
+    POMAGMA_ASSERT(not symbols.find(""), "found empty symbol");
+    POMAGMA_ASSERT(not symbols.find("N"), "found unknown symbol");
+    for (size_t i = symbol_count; i < 2 * symbol_count; ++i) {
+        std::ostringstream name;
+        name << "N" << i;
+        POMAGMA_ASSERT(not symbols.find(name.str()), "found unknown symbol");
+    }
+
+    // tokens are found in place, without a terminating null
+    const std::string expression = "B0 N0 N1";
+    if (symbol_count >= 2) {
+        POMAGMA_ASSERT(symbols.find(expression.data(), 2), "missing B0");
+        POMAGMA_ASSERT(symbols.find(expression.data() + 6, 2), "missing N1");
+        POMAGMA_ASSERT(not symbols.find(expression.data(), 3), "found B0_");
+    }
+}
+
+int main ()
+{
+    test_symbol_table(0);
+    test_symbol_table(1);
+    test_symbol_table(2);
+    test_symbol_table(30);
+    test_symbol_table(500);
+
+    return 0;
+}
@@ -65,7 +65,51 @@ namespace messaging { using namespace pomagma_messaging; }
 template<class T> inline T min (T x, T y) { return (x < y) ? x : y; }
 template<class T> inline T max (T x, T y) { return (x > y) ? x : y; }
 
-typedef std::default_random_engine rng_t;
+// xoshiro256** by Blackman & Vigna, seeded by splitmix64.
+// This is much faster than std::default_random_engine and is small enough
+// that each worker thread can own a stream.
+class Xoshiro256
+{
+    uint64_t m_state[4];
+
+    static uint64_t rotl (uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+
+    typedef uint64_t result_type;
+    static constexpr result_type min () { return 0; }
+    static constexpr result_type max () { return ~result_type(0); }
+
+    explicit Xoshiro256 (uint64_t seed = 0) { this->seed(seed); }
+
+    void seed (uint64_t seed)
+    {
+        for (uint64_t & word : m_state) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    result_type operator() ()
+    {
+        const uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        const uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+};
+
+typedef Xoshiro256 rng_t;
 
 template<size_t x> struct static_log2i
 {
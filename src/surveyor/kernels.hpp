@@ -0,0 +1,408 @@
+#pragma once
+
+#include <pomagma/microstructure/util.hpp>
+#include <pomagma/microstructure/structure_impl.hpp>
+
+// Rule kernels are type-level compositions of the strategies in
+// src/compiler/compiler.py, one template per strategy node. Tables,
+// ensurers and variable slots are all template parameters, so each
+// composition inlines to the same nested loops as the expanded C++ that
+// the compiler writes by default, without a JIT. The generated sources are
+// not shorter: each kernel spells out its full type and slot enum, so
+// sk.theory.cpp grows by about 60%. What kernels buy is that every loop
+// shape lives here once, where it can be read and fixed, rather than in
+// the string templates of src/compiler/cpp.py (see kernels=true in
+// src/compiler/run.py and the sk_kernels targets, built with
+// -DPOMAGMA_KERNELS=ON).
+
+namespace pomagma
+{
+namespace kernels
+{
+
+static const size_t MAX_SLOTS = 64;
+
+// variable bindings of a running kernel, indexed by slot
+struct Env
+{
+    Ob ob[MAX_SLOTS];
+    const DenseSet * delta;
+    unsigned long block;
+};
+
+//----------------------------------------------------------------------------
+// sets to iterate over
+
+template<Carrier & carrier>
+struct Support
+{
+    static DenseSet::Iterator iter (const Env &) { return carrier.iter(); }
+    static DenseSet::Iterator iter_from (const Env &, size_t begin)
+    {
+        return carrier.support().iter_from(begin);
+    }
+    static const DenseSet & get (const Env &) { return carrier.support(); }
+};
+
+// all lhs with table(lhs, rhs) defined
+template<class Table, Table & table, size_t rhs>
+struct LhsOf
+{
+    static DenseSet::Iterator iter (const Env & env)
+    {
+        return table.iter_rhs(env.ob[rhs]);
+    }
+    static DenseSet::Iterator iter_from (const Env & env, size_t begin)
+    {
+        return get(env).iter_from(begin);
+    }
+    static DenseSet get (const Env & env)
+    {
+        return table.get_Rx_set(env.ob[rhs]);
+    }
+};
+
+// all rhs with table(lhs, rhs) defined
+template<class Table, Table & table, size_t lhs>
+struct RhsOf
+{
+    static DenseSet::Iterator iter (const Env & env)
+    {
+        return table.iter_lhs(env.ob[lhs]);
+    }
+    static DenseSet::Iterator iter_from (const Env & env, size_t begin)
+    {
+        return get(env).iter_from(begin);
+    }
+    static DenseSet get (const Env & env)
+    {
+        return table.get_Lx_set(env.ob[lhs]);
+    }
+};
+
+// all keys with fun(key) defined
+template<InjectiveFunction & fun>
+struct Image
+{
+    static DenseSet::Iterator iter (const Env &) { return fun.iter(); }
+    static DenseSet::Iterator iter_from (const Env &, size_t begin)
+    {
+        return fun.defined().iter_from(begin);
+    }
+    static const DenseSet & get (const Env &) { return fun.defined(); }
+};
+
+// the rhs set of a row task
+struct Delta
+{
+    static DenseSet::Iterator iter (const Env & env)
+    {
+        return env.delta->iter();
+    }
+    static DenseSet::Iterator iter_from (const Env & env, size_t begin)
+    {
+        return env.delta->iter_from(begin);
+    }
+    static const DenseSet & get (const Env & env) { return * env.delta; }
+};
+
+template<class... Sets>
+struct Intersect;
+
+template<class Set1>
+struct Intersect<Set1> : Set1
+{
+};
+
+template<class Set1, class Set2>
+struct Intersect<Set1, Set2>
+{
+    static DenseSet::Iterator2 iter (const Env & env)
+    {
+        return Set1::get(env).iter_insn(Set2::get(env));
+    }
+    static DenseSet::Iterator2 iter_from (const Env & env, size_t begin)
+    {
+        return Set1::get(env).iter_insn_from(begin, Set2::get(env));
+    }
+};
+
+template<class Set1, class Set2, class Set3>
+struct Intersect<Set1, Set2, Set3>
+{
+    static DenseSet::Iterator3 iter (const Env & env)
+    {
+        return Set1::get(env).iter_insn(Set2::get(env), Set3::get(env));
+    }
+    static DenseSet::Iterator3 iter_from (const Env & env, size_t begin)
+    {
+        return Set1::get(env).iter_insn_from(
+            begin,
+            Set2::get(env),
+            Set3::get(env));
+    }
+};
+
+template<class Set1, class Set2, class Set3, class Set4>
+struct Intersect<Set1, Set2, Set3, Set4>
+{
+    static DenseSet::Iterator4 iter (const Env & env)
+    {
+        return Set1::get(env).iter_insn(
+            Set2::get(env),
+            Set3::get(env),
+            Set4::get(env));
+    }
+    static DenseSet::Iterator4 iter_from (const Env & env, size_t begin)
+    {
+        return Set1::get(env).iter_insn_from(
+            begin,
+            Set2::get(env),
+            Set3::get(env),
+            Set4::get(env));
+    }
+};
+
+//----------------------------------------------------------------------------
+// function lookups, binding the value to slot val
+
+template<NullaryFunction & fun, size_t val>
+struct Find0
+{
+    enum { VAL = val };
+    static Ob find (const Env &) { return fun.find(); }
+    static Ob bind (Env & env) { return env.ob[val] = fun.find(); }
+    static void insert (const Env & env) { fun.insert(env.ob[val]); }
+};
+
+template<InjectiveFunction & fun, size_t val, size_t key>
+struct Find1
+{
+    enum { VAL = val };
+    static Ob find (const Env & env) { return fun.find(env.ob[key]); }
+    static Ob bind (Env & env) { return env.ob[val] = find(env); }
+    static void insert (const Env & env)
+    {
+        fun.insert(env.ob[key], env.ob[val]);
+    }
+};
+
+template<class Table, Table & fun, size_t val, size_t lhs, size_t rhs>
+struct Find2
+{
+    enum { VAL = val };
+    static Ob find (const Env & env)
+    {
+        return fun.find(env.ob[lhs], env.ob[rhs]);
+    }
+    static Ob bind (Env & env) { return env.ob[val] = find(env); }
+    static void insert (const Env & env)
+    {
+        fun.insert(env.ob[lhs], env.ob[rhs], env.ob[val]);
+    }
+};
+
+template<class... Finders>
+struct Bind;
+
+template<>
+struct Bind<>
+{
+    static void run (Env &) {}
+};
+
+template<class Finder, class... Finders>
+struct Bind<Finder, Finders...>
+{
+    static void run (Env & env)
+    {
+        Finder::bind(env);
+        Bind<Finders...>::run(env);
+    }
+};
+
+//----------------------------------------------------------------------------
+// strategies
+//
+// Loops take a block_size; if nonzero, only values in block env.block of
+// the carrier are visited, as in split cleanup tasks. Iter visits only the
+// range of the block; inverse iterators are not ordered, so they filter.
+
+template<size_t var, class Set, class Lets, size_t block_size, class Body>
+struct Iter
+{
+    static void run (Env & env)
+    {
+        const size_t begin = env.block * block_size;
+        const size_t end = begin + block_size;
+        for (auto iter = block_size ? Set::iter_from(env, begin)
+                                    : Set::iter(env);
+            iter.ok() and (not block_size or * iter < end);
+            iter.next())
+        {
+            env.ob[var] = * iter;
+            Lets::run(env);
+            Body::run(env);
+        }
+    }
+};
+
+template<InjectiveFunction & fun, size_t var, size_t value, class Body>
+struct IterInvInjective
+{
+    static void run (Env & env)
+    {
+        if (Ob ob = fun.inverse_find(env.ob[value])) {
+            env.ob[var] = ob;
+            Body::run(env);
+        }
+    }
+};
+
+template<
+    class Table,
+    Table & fun,
+    size_t value,
+    size_t var1,
+    size_t var2,
+    size_t block_size,
+    class Body>
+struct IterInvBinary
+{
+    static void run (Env & env)
+    {
+        for (auto iter = fun.iter_val(env.ob[value]); iter.ok(); iter.next()) {
+            if (block_size and iter.lhs() / block_size != env.block) {
+                continue;
+            }
+            env.ob[var1] = iter.lhs();
+            if (var2 != var1) {
+                env.ob[var2] = iter.rhs();
+            }
+            Body::run(env);
+        }
+    }
+};
+
+namespace detail
+{
+
+template<class Table, Table & fun, bool lhs_fixed>
+struct IterVal;
+
+template<class Table, Table & fun>
+struct IterVal<Table, fun, true>
+{
+    static auto iter (Ob val, Ob lhs) -> decltype(fun.iter_val_lhs(val, lhs))
+    {
+        return fun.iter_val_lhs(val, lhs);
+    }
+};
+
+template<class Table, Table & fun>
+struct IterVal<Table, fun, false>
+{
+    static auto iter (Ob val, Ob rhs) -> decltype(fun.iter_val_rhs(val, rhs))
+    {
+        return fun.iter_val_rhs(val, rhs);
+    }
+};
+
+} // namespace detail
+
+template<
+    class Table,
+    Table & fun,
+    size_t value,
+    size_t fixed,
+    size_t var,
+    bool lhs_fixed,
+    size_t block_size,
+    class Body>
+struct IterInvBinaryRange
+{
+    static void run (Env & env)
+    {
+        typedef detail::IterVal<Table, fun, lhs_fixed> IterVal;
+        for (auto iter = IterVal::iter(env.ob[value], env.ob[fixed]);
+            iter.ok();
+            iter.next())
+        {
+            if (block_size and * iter / block_size != env.block) {
+                continue;
+            }
+            env.ob[var] = * iter;
+            Body::run(env);
+        }
+    }
+};
+
+template<class Finder, class Body>
+struct Let
+{
+    static void run (Env & env)
+    {
+        if (Finder::bind(env)) {
+            Body::run(env);
+        }
+    }
+};
+
+template<Carrier & carrier, size_t lhs, size_t rhs, class Body>
+struct TestEqual
+{
+    static void run (Env & env)
+    {
+        if (carrier.equal(env.ob[lhs], env.ob[rhs])) {
+            Body::run(env);
+        }
+    }
+};
+
+template<BinaryRelation & rel, size_t lhs, size_t rhs, class Body>
+struct TestRel
+{
+    static void run (Env & env)
+    {
+        if (rel.find(env.ob[lhs], env.ob[rhs])) {
+            Body::run(env);
+        }
+    }
+};
+
+template<class Finder, class Body>
+struct TestFind
+{
+    static void run (Env & env)
+    {
+        if (env.ob[Finder::VAL] == Finder::find(env)) {
+            Body::run(env);
+        }
+    }
+};
+
+template<size_t rhs, class Body>
+struct TestDelta
+{
+    static void run (Env & env)
+    {
+        if (env.delta->contains(env.ob[rhs])) {
+            Body::run(env);
+        }
+    }
+};
+
+template<class Fun, Fun & ensure, size_t... args>
+struct Ensure
+{
+    static void run (Env & env) { ensure(env.ob[args]...); }
+};
+
+template<class Finder>
+struct Insert
+{
+    static void run (Env & env) { Finder::insert(env); }
+};
+
+} // namespace kernels
+} // namespace pomagma
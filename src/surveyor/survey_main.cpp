@@ -28,6 +28,8 @@ int main (int argc, char ** argv)
             << "  POMAGMA_SIZE = " << pomagma::DEFAULT_ITEM_DIM << "\n"
             << "  POMAGMA_LOG_FILE = " << pomagma::DEFAULT_LOG_FILE << "\n"
             << "  POMAGMA_LOG_LEVEL = " << pomagma::DEFAULT_LOG_LEVEL << "\n"
+            << "  POMAGMA_SAMPLE_BATCH = "
+                << pomagma::DEFAULT_SAMPLE_BATCH_SIZE << "\n"
             ;
         POMAGMA_WARN("incorrect program args");
         exit(1);
@@ -41,6 +43,9 @@ int main (int argc, char ** argv)
 
     // set params
     pomagma::Scheduler::set_thread_count(thread_count);
+    pomagma::Scheduler::set_sample_batch_size(pomagma::getenv_default(
+        "POMAGMA_SAMPLE_BATCH",
+        pomagma::DEFAULT_SAMPLE_BATCH_SIZE));
     pomagma::declare_signature();
     pomagma::load_language(language_file);
     pomagma::load_structure(structure_in);
@@ -6,7 +6,12 @@
 #include <pomagma/microstructure/structure_impl.hpp>
 #include <pomagma/microstructure/scheduler.hpp>
 #include "insert_parser.hpp"
+#include "kernels.hpp"
+#include <algorithm>
 #include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -24,24 +29,179 @@ void load_structure (const std::string & filename) { structure.load(filename); }
 void dump_structure (const std::string & filename) { structure.dump(filename); }
 void load_language (const std::string & filename) { sampler.load(filename); }
 
-void schedule_merge (Ob dep) { schedule(MergeTask(dep)); }
-void schedule_exists (Ob ob) { schedule(ExistsTask(ob)); }
-void schedule_less (Ob lhs, Ob rhs) { schedule(PositiveOrderTask(lhs, rhs)); }
-void schedule_nless (Ob lhs, Ob rhs) { schedule(NegativeOrderTask(lhs, rhs)); }
+// Tables are indexed by the generated theory, which defines CARRIER_TABLE,
+// LESS_TABLE, NLESS_TABLE, one NAME_TABLE per function, and TABLE_COUNT
+// before including this file.
+static_assert(TABLE_COUNT >= 3, "theory defines too few tables");
+
+// facts found by this thread, to attribute them to the cleanup task that
+// found them
+thread_local unsigned long t_fact_count = 0;
+
+// Each thread counts changes to each table in counters only it writes. The
+// cleanup scheduler folds these in whenever it polls, stamping every table
+// whose counts moved with a new epoch, so that a cleanup block can be
+// skipped while no table it reads has changed since it last ran. A change
+// is stamped no earlier than it is made, which can only dirty blocks.
+// The carrier changes with every new ob and merge; since merges move
+// entries of every table without scheduling events, every block reads it.
+class ChangeClocks : noncopyable
+{
+    struct Counts
+    {
+        std::atomic<unsigned long> changes[TABLE_COUNT];
+        char padding[64]; // keep other threads off the last cache line
+
+        Counts ()
+        {
+            for (size_t i = 0; i < TABLE_COUNT; ++i) {
+                changes[i].store(0, relaxed);
+            }
+        }
+    };
+
+    static thread_local Counts * t_counts;
+
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Counts>> m_threads;
+    unsigned long m_folded[TABLE_COUNT];
+    std::atomic<unsigned long> m_changed[TABLE_COUNT];
+    std::atomic<unsigned long> m_epoch;
+
+public:
+
+    ChangeClocks () : m_epoch(0)
+    {
+        for (size_t i = 0; i < TABLE_COUNT; ++i) {
+            m_folded[i] = 0;
+            m_changed[i].store(0, relaxed);
+        }
+    }
+
+    template<size_t table>
+    void touch (unsigned long count)
+    {
+        static_assert(table < TABLE_COUNT, "bad table");
+        std::atomic<unsigned long> & changes = counts().changes[table];
+        changes.store(changes.load(relaxed) + count, release);
+    }
+
+    // called by the cleanup scheduler each time it polls
+    void fold ()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        unsigned long sums[TABLE_COUNT] = {0};
+        for (const auto & counts : m_threads) {
+            for (size_t i = 0; i < TABLE_COUNT; ++i) {
+                sums[i] += counts->changes[i].load(acquire);
+            }
+        }
+        const unsigned long epoch = m_epoch.load(relaxed) + 1;
+        bool changed = false;
+        for (size_t i = 0; i < TABLE_COUNT; ++i) {
+            if (sums[i] != m_folded[i]) {
+                m_folded[i] = sums[i];
+                m_changed[i].store(epoch, relaxed);
+                changed = true;
+            }
+        }
+        if (changed) {
+            m_epoch.store(epoch, release);
+        }
+    }
+
+    unsigned long epoch () const { return m_epoch.load(acquire); }
+
+    // the epoch at the latest change of any of tables
+    unsigned long changed (std::initializer_list<size_t> tables) const
+    {
+        unsigned long result = 0;
+        for (size_t table : tables) {
+            result = std::max(result, m_changed[table].load(relaxed));
+        }
+        return result;
+    }
+
+private:
+
+    Counts & counts ()
+    {
+        if (unlikely(t_counts == nullptr)) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_threads.push_back(std::unique_ptr<Counts>(new Counts()));
+            t_counts = m_threads.back().get();
+        }
+        return * t_counts;
+    }
+};
+
+thread_local ChangeClocks::Counts * ChangeClocks::t_counts = nullptr;
+
+ChangeClocks g_change_clocks;
+
+template<size_t table>
+inline void count_change (unsigned long count = 1)
+{
+    t_fact_count += count;
+    g_change_clocks.touch<table>(count);
+}
+
+extern Carrier carrier;
+extern BinaryRelation LESS;
+extern BinaryRelation NLESS;
+
+void schedule_merge (Ob dep)
+{
+    count_change<CARRIER_TABLE>();
+    schedule(MergeTask(dep));
+}
+void schedule_exists (Ob ob)
+{
+    count_change<CARRIER_TABLE>();
+    schedule(ExistsTask(ob));
+}
+void schedule_less (Ob lhs, Ob rhs)
+{
+    count_change<LESS_TABLE>();
+    schedule(PositiveOrderTask(lhs, rhs));
+}
+void schedule_nless (Ob lhs, Ob rhs)
+{
+    count_change<NLESS_TABLE>();
+    schedule(NegativeOrderTask(lhs, rhs));
+}
+void schedule_less_row (Ob lhs, const DenseSet & rhs)
+{
+    count_change<LESS_TABLE>(rhs.count_items());
+    schedule_positive_order_row(lhs, rhs);
+}
+void schedule_nless_row (Ob lhs, const DenseSet & rhs)
+{
+    count_change<NLESS_TABLE>(rhs.count_items());
+    schedule_negative_order_row(lhs, rhs);
+}
+template<size_t table>
 void schedule_nullary_function (const NullaryFunction * fun)
 {
+    count_change<table>();
     schedule(NullaryFunctionTask(*fun));
 }
+template<size_t table>
 void schedule_injective_function (const InjectiveFunction * fun, Ob arg)
 {
+    count_change<table>();
     schedule(InjectiveFunctionTask(*fun, arg));
 }
+template<size_t table>
 void schedule_binary_function (const BinaryFunction * fun, Ob lhs, Ob rhs)
 {
+    count_change<table>();
     schedule(BinaryFunctionTask(*fun, lhs, rhs));
 }
+template<size_t table>
 void schedule_symmetric_function (const SymmetricFunction * fun, Ob lhs, Ob rhs)
 {
+    count_change<table>();
     schedule(SymmetricFunctionTask(*fun, lhs, rhs));
 }
 
@@ -50,8 +210,8 @@ Carrier carrier(
     schedule_exists,
     schedule_merge);
 
-BinaryRelation LESS(carrier, schedule_less);
-BinaryRelation NLESS(carrier, schedule_nless);
+BinaryRelation LESS(carrier, schedule_less, schedule_less_row);
+BinaryRelation NLESS(carrier, schedule_nless, schedule_nless_row);
 
 //----------------------------------------------------------------------------
 // validation
@@ -78,6 +238,64 @@ void log_stats ()
 
 //----------------------------------------------------------------------------
 // basic ensurers
+//
+// Order facts are buffered per thread while consecutive facts share an lhs,
+// then inserted as one row, so that a rule ensuring LESS x y over many y
+// schedules a single row task. Every task flushes before it returns, while
+// still holding the scheduler's shared lock, so no buffered ob is merged.
+
+class OrderBuffer : noncopyable
+{
+    // shorter rows are cheaper to insert pair by pair
+    static constexpr size_t MIN_ROW_SIZE = 8;
+
+    BinaryRelation & m_rel;
+    Ob m_lhs;
+    DenseSet m_row;
+    std::vector<Ob> m_rhs;
+
+public:
+
+    OrderBuffer (BinaryRelation & rel)
+        : m_rel(rel),
+          m_lhs(0),
+          m_row(rel.item_dim())
+    {
+    }
+
+    void insert (Ob lhs, Ob rhs)
+    {
+        if (m_rel.find(lhs, rhs)) {
+            return;
+        }
+        if (lhs != m_lhs) {
+            flush();
+            m_lhs = lhs;
+        }
+        if (not m_row.contains(rhs)) {
+            m_row.insert(rhs);
+            m_rhs.push_back(rhs);
+        }
+    }
+
+    void flush ()
+    {
+        if (m_rhs.size() < MIN_ROW_SIZE) {
+            for (Ob rhs : m_rhs) {
+                m_rel.insert(m_lhs, rhs);
+            }
+        } else {
+            m_rel.insert(m_lhs, m_row);
+        }
+        for (Ob rhs : m_rhs) {
+            m_row.remove(rhs);
+        }
+        m_rhs.clear();
+    }
+};
+
+thread_local OrderBuffer t_less_buffer(LESS);
+thread_local OrderBuffer t_nless_buffer(NLESS);
 
 inline void ensure_equal (Ob lhs, Ob rhs)
 {
@@ -86,12 +304,18 @@ inline void ensure_equal (Ob lhs, Ob rhs)
 
 inline void ensure_less (Ob lhs, Ob rhs)
 {
-    LESS.insert(lhs, rhs);
+    t_less_buffer.insert(lhs, rhs);
 }
 
 inline void ensure_nless (Ob lhs, Ob rhs)
 {
-    NLESS.insert(lhs, rhs);
+    t_nless_buffer.insert(lhs, rhs);
+}
+
+inline void flush_ensurers ()
+{
+    t_less_buffer.flush();
+    t_nless_buffer.flush();
 }
 
 //----------------------------------------------------------------------------
@@ -130,6 +354,7 @@ void execute (const AssumeTask & task)
 	} else {
         POMAGMA_ERROR("bad relation type: " << type);
 	}
+    flush_ensurers();
 }
 
 //----------------------------------------------------------------------------
@@ -168,21 +393,30 @@ class CleanupProfiler
 {
     static std::vector<atomic_default<unsigned long>> s_counts;
     static std::vector<atomic_default<unsigned long>> s_elapsed;
+    static std::vector<atomic_default<unsigned long>> s_facts;
 
 public:
 
     class Block
     {
         const unsigned long m_type;
+        const unsigned long m_fact_count;
         Timer m_timer;
     public:
-        Block (unsigned long type) : m_type(type) {}
+        Block (unsigned long type)
+            : m_type(type),
+              m_fact_count(t_fact_count)
+        {
+        }
         ~Block ()
         {
             s_elapsed[m_type].fetch_add(
                 m_timer.elapsed_us(),
                 std::memory_order_acq_rel);
             s_counts[m_type].fetch_add(1, std::memory_order_acq_rel);
+            s_facts[m_type].fetch_add(
+                t_fact_count - m_fact_count,
+                std::memory_order_acq_rel);
         }
     };
 
@@ -190,22 +424,223 @@ public:
     {
         s_counts.resize(task_count);
         s_elapsed.resize(task_count);
+        s_facts.resize(task_count);
+    }
+
+    static unsigned long count (unsigned long type)
+    {
+        return s_counts[type].load(relaxed);
+    }
+    static unsigned long elapsed_us (unsigned long type)
+    {
+        return s_elapsed[type].load(relaxed);
+    }
+    static unsigned long facts (unsigned long type)
+    {
+        return s_facts[type].load(relaxed);
     }
 
     void cleanup ()
     {
         unsigned long task_count = s_counts.size();
-        POMAGMA_INFO("Task Id\tCount\tElapsed sec");
+        POMAGMA_INFO("Task Id\tCount\tElapsed sec\tFacts");
         for (unsigned long i = 0; i < task_count; ++i) {
             POMAGMA_INFO(
                 std::setw(4) << i <<
                 std::setw(8) << s_counts[i].load() <<
-                std::setw(16) << (s_elapsed[i].load() * 1e-6));
+                std::setw(16) << (s_elapsed[i].load() * 1e-6) <<
+                std::setw(12) << s_facts[i].load());
         }
     }
 };
 
 std::vector<atomic_default<unsigned long>> CleanupProfiler::s_counts;
 std::vector<atomic_default<unsigned long>> CleanupProfiler::s_elapsed;
+std::vector<atomic_default<unsigned long>> CleanupProfiler::s_facts;
+
+//----------------------------------------------------------------------------
+// cleanup scheduling
+
+// Each pass visits every (type, block) once, visiting types in order of
+// decreasing recent yield (new facts per ms), as measured by CleanupProfiler.
+// Blocks of one type are handed out in chunks sized to take about
+// TARGET_CHUNK_US. A block that found nothing is clean until one of the
+// tables its type reads changes (see ChangeClocks), and clean blocks are
+// skipped.
+class CleanupScheduler : noncopyable
+{
+    static constexpr unsigned long TARGET_CHUNK_US = 10000;
+    static constexpr unsigned long MAX_CHUNK_SIZE = 64;
+    static constexpr float YIELD_DECAY = 0.5f;
+
+    const unsigned long m_type_count;
+    const unsigned long m_unsplit_count;
+    const unsigned long m_block_count;
+    unsigned long (* const m_changed) (unsigned long type);
+
+    // clean marks are 1 + the epoch when a block last found nothing
+    std::vector<atomic_default<unsigned long>> m_clean;
+    std::atomic<bool> m_pending;
+    std::atomic<bool> m_active;
+
+    std::mutex m_mutex;
+    std::vector<unsigned long> m_order;
+    unsigned long m_type_pos;
+    unsigned long m_block_pos;
+    std::vector<float> m_yield;
+    std::vector<unsigned long> m_elapsed;
+    std::vector<unsigned long> m_facts;
+
+public:
+
+    class Block
+    {
+        atomic_default<unsigned long> & m_clean;
+        const unsigned long m_epoch;
+        const unsigned long m_thread_fact_count;
+    public:
+        Block (CleanupScheduler & scheduler,
+               unsigned long type,
+               unsigned long block)
+            : m_clean(scheduler.m_clean[scheduler.index(type, block)]),
+              m_epoch(g_change_clocks.epoch()),
+              m_thread_fact_count(t_fact_count)
+        {
+        }
+        ~Block ()
+        {
+            if (t_fact_count == m_thread_fact_count) {
+                m_clean.store(1 + m_epoch, relaxed);
+            }
+        }
+    };
+
+    CleanupScheduler (
+            unsigned long type_count,
+            unsigned long unsplit_count,
+            unsigned long block_count,
+            unsigned long (* changed) (unsigned long type))
+        : m_type_count(type_count),
+          m_unsplit_count(unsplit_count),
+          m_block_count(block_count),
+          m_changed(changed),
+          m_clean(type_count * block_count),
+          m_pending(false),
+          m_active(false),
+          m_order(type_count),
+          m_type_pos(0),
+          m_block_pos(0),
+          m_yield(type_count, 0),
+          m_elapsed(type_count, 0),
+          m_facts(type_count, 0)
+    {
+        for (unsigned long type = 0; type < type_count; ++type) {
+            m_order[type] = type;
+        }
+    }
+
+    unsigned long block_count (unsigned long type) const
+    {
+        return type < m_unsplit_count ? 1 : m_block_count;
+    }
+
+    // the epoch at the latest change of any table read by type
+    unsigned long changed (unsigned long type) const
+    {
+        return m_changed(type);
+    }
+
+    bool is_clean (
+            unsigned long type,
+            unsigned long block,
+            unsigned long changed) const
+    {
+        return m_clean[index(type, block)].load(relaxed) > changed;
+    }
+
+    void push_all () { m_pending.store(true, release); }
+
+    bool try_pop (CleanupTask & task)
+    {
+        if (not m_active.load(relaxed) and not m_pending.load(relaxed)) {
+            return false;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        g_change_clocks.fold();
+        while (true) {
+            if (not m_active.load(relaxed)) {
+                if (not m_pending.exchange(false, acquire)) {
+                    return false;
+                }
+                begin_pass();
+            }
+            if (m_type_pos == m_type_count) {
+                m_active.store(false, relaxed);
+                continue;
+            }
+            const unsigned long type = m_order[m_type_pos];
+            const unsigned long end = block_count(type);
+            const unsigned long changed = this->changed(type);
+            while (m_block_pos < end and is_clean(type, m_block_pos, changed)) {
+                ++m_block_pos;
+            }
+            if (m_block_pos == end) {
+                ++m_type_pos;
+                m_block_pos = 0;
+                continue;
+            }
+            task.type = type;
+            task.block_begin = m_block_pos;
+            task.block_end = std::min(end, m_block_pos + chunk_size(type));
+            m_block_pos = task.block_end;
+            return true;
+        }
+    }
+
+private:
+
+    size_t index (unsigned long type, unsigned long block) const
+    {
+        POMAGMA_ASSERT6(type < m_type_count, "bad cleanup type " << type);
+        POMAGMA_ASSERT6(block < m_block_count, "bad cleanup block " << block);
+        return type * m_block_count + block;
+    }
+
+    unsigned long chunk_size (unsigned long type) const
+    {
+        unsigned long count = CleanupProfiler::count(type);
+        if (count == 0) {
+            return 1;
+        }
+        unsigned long block_us = CleanupProfiler::elapsed_us(type) / count;
+        unsigned long size = TARGET_CHUNK_US / (1 + block_us);
+        if (size > MAX_CHUNK_SIZE) { return MAX_CHUNK_SIZE; }
+        if (size < 1) { return 1; }
+        return size;
+    }
+
+    void begin_pass ()
+    {
+        for (unsigned long type = 0; type < m_type_count; ++type) {
+            unsigned long elapsed = CleanupProfiler::elapsed_us(type);
+            unsigned long facts = CleanupProfiler::facts(type);
+            if (elapsed > m_elapsed[type]) {
+                float recent = 1e3f * (facts - m_facts[type])
+                                    / (elapsed - m_elapsed[type]);
+                m_yield[type] = YIELD_DECAY * m_yield[type]
+                              + (1 - YIELD_DECAY) * recent;
+                m_elapsed[type] = elapsed;
+                m_facts[type] = facts;
+            }
+        }
+        std::stable_sort(m_order.begin(), m_order.end(),
+            [this](unsigned long lhs, unsigned long rhs){
+                return m_yield[lhs] > m_yield[rhs];
+            });
+        m_active.store(true, relaxed);
+        m_type_pos = 0;
+        m_block_pos = 0;
+    }
+};
 
 } // namespace pomagma
@@ -12,39 +12,157 @@ namespace pomagma
 namespace detail
 {
 
+//----------------------------------------------------------------------------
+// Facts are assumed in two phases: all lines are first parsed and resolved to
+// obs in parallel, since parsing only reads the structure; then relations are
+// inserted row-wise, one relation per OpenMP iteration, and equations are merged.
+
+struct Fact
+{
+    uint32_t type; // 0 = EQUAL, otherwise 1 + index into relations
+    Ob lhs;
+    Ob rhs;
+};
+
+typedef std::pair<Ob, Ob> Pair;
+
+std::vector<std::string> read_lines (const char * theory_file)
+{
+    std::vector<std::string> lines;
+    for (LineParser iter(theory_file); iter.ok(); iter.next()) {
+        lines.push_back(* iter);
+    }
+    return lines;
+}
+
+std::vector<Fact> parse_facts (
+        Structure & structure,
+        const std::vector<std::string> & relations,
+        const std::vector<std::string> & expressions)
+{
+    const size_t fact_count = expressions.size();
+    std::vector<Fact> facts(fact_count);
+
+    #pragma omp parallel
+    {
+        FindParser parser(structure.signature());
+
+        #pragma omp for schedule(dynamic, 64)
+        for (size_t i = 0; i < fact_count; ++i) {
+            const std::string & expression = expressions[i];
+            POMAGMA_DEBUG("assume " << expression);
+
+            Fact & fact = facts[i];
+            parser.begin(expression);
+            std::string type = parser.parse_token();
+            fact.lhs = parser.parse_term();
+            fact.rhs = parser.parse_term();
+            parser.end();
+
+            if (type == "EQUAL") {
+                fact.type = 0;
+            } else {
+                auto r = std::find(relations.begin(), relations.end(), type);
+                POMAGMA_ASSERT(r != relations.end(),
+                    "bad relation type: " << type);
+                fact.type = 1 + (r - relations.begin());
+            }
+        }
+    }
+
+    return facts;
+}
+
+// returns the number of new facts
+size_t assume_relation (BinaryRelation & rel, std::vector<Pair> & pairs)
+{
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    size_t new_count = 0;
+    DenseSet row(rel.item_dim());
+    std::vector<Ob> row_obs; // only facts not already holding enter row
+    for (size_t begin = 0, end = 0; begin < pairs.size(); begin = end) {
+        const Ob lhs = pairs[begin].first;
+        for (end = begin; end < pairs.size() and pairs[end].first == lhs;
+            ++end)
+        {
+            const Ob rhs = pairs[end].second;
+            if (not rel.find(lhs, rhs)) {
+                row.insert(rhs);
+                row_obs.push_back(rhs);
+            }
+        }
+        rel.insert(lhs, row);
+        for (Ob rhs : row_obs) {
+            row.remove(rhs);
+        }
+        new_count += row_obs.size();
+        row_obs.clear();
+    }
+
+    return new_count;
+}
+
 std::map<std::string, size_t> assume_facts (
         Structure & structure,
         const char * theory_file)
 {
     POMAGMA_INFO("assuming core facts");
 
-    size_t pos_count = 0;
-    size_t neg_count = 0;
+    std::vector<std::string> relations;
+    for (const auto & pair : structure.signature().binary_relations()) {
+        relations.push_back(pair.first);
+    }
 
-    for (LineParser iter(theory_file); iter.ok(); iter.next()) {
-        const std::string & expression = * iter;
-        POMAGMA_DEBUG("assume " << expression);
+    std::vector<Fact> facts;
+    {
+        POMAGMA_DEBUG("parsing facts");
+        const std::vector<std::string> expressions = read_lines(theory_file);
+        facts = parse_facts(structure, relations, expressions);
+    }
 
-        FindParser parser(structure.signature());
-        parser.begin(expression);
-        std::string type = parser.parse_token();
-        Ob lhs = parser.parse_term();
-        Ob rhs = parser.parse_term();
-        parser.end();
-
-        if (type == "EQUAL") {
-            if (lhs != rhs) {
-                structure.carrier().ensure_equal(lhs, rhs);
+    POMAGMA_DEBUG("sorting facts");
+    size_t pos_count = 0;
+    size_t neg_count = 0;
+    std::vector<Pair> equations;
+    std::vector<std::vector<Pair>> pairs(relations.size());
+    for (const Fact & fact : facts) {
+        if (fact.type == 0) {
+            if (fact.lhs != fact.rhs) {
+                equations.push_back(Pair(fact.lhs, fact.rhs));
                 ++pos_count;
             }
         } else {
-            BinaryRelation & rel = structure.binary_relation(type);
-            if (not rel.find(lhs, rhs)) {
-                rel.insert(lhs, rhs);
-                ++(type[0] == 'N' ? neg_count : pos_count);
-            }
+            pairs[fact.type - 1].push_back(Pair(fact.lhs, fact.rhs));
         }
     }
+    std::vector<Fact>().swap(facts);
+
+    // relations are assumed first, so that merges are checked against them
+    POMAGMA_DEBUG("inserting relations");
+    const size_t relation_count = relations.size();
+    std::vector<BinaryRelation *> rels;
+    for (const std::string & name : relations) {
+        rels.push_back(& structure.binary_relation(name));
+    }
+    std::vector<size_t> new_counts(relation_count, 0);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t i = 0; i < relation_count; ++i) {
+        new_counts[i] = assume_relation(* rels[i], pairs[i]);
+    }
+    for (size_t i = 0; i < relation_count; ++i) {
+        (relations[i][0] == 'N' ? neg_count : pos_count) += new_counts[i];
+    }
+
+    POMAGMA_DEBUG("merging " << equations.size() << " equations");
+    Carrier & carrier = structure.carrier();
+    for (const Pair & equation : equations) {
+        carrier.ensure_equal(
+            carrier.find(equation.first),
+            carrier.find(equation.second));
+    }
 
     std::map<std::string, size_t> counts;
     counts["pos"] = pos_count;
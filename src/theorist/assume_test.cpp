@@ -0,0 +1,82 @@
+#include "assume.hpp"
+#include <pomagma/macrostructure/structure_impl.hpp>
+#include <cstdio>
+#include <fstream>
+
+using namespace pomagma;
+
+static const char * NAMES[] = {"A", "B", "C", "D", "E", "F", "G", "H"};
+static const size_t NAME_COUNT = sizeof(NAMES) / sizeof(NAMES[0]);
+
+void init_structure (Structure & structure)
+{
+    structure.init_carrier(63);
+    Signature & signature = structure.signature();
+    Carrier & carrier = structure.carrier();
+    signature.declare("LESS", * new BinaryRelation(carrier));
+    signature.declare("NLESS", * new BinaryRelation(carrier));
+    for (const char * name : NAMES) {
+        NullaryFunction * fun = new NullaryFunction(carrier);
+        fun->insert(carrier.unsafe_insert());
+        signature.declare(name, * fun);
+    }
+}
+
+Ob find (Structure & structure, const char * name)
+{
+    return structure.nullary_function(name).find();
+}
+
+void test_assume_facts_already_holding ()
+{
+    POMAGMA_INFO("Testing assume of facts that already hold");
+    Structure structure;
+    init_structure(structure);
+    BinaryRelation & LESS = structure.binary_relation("LESS");
+    BinaryRelation & NLESS = structure.binary_relation("NLESS");
+
+    // these already hold, including every fact of the long row of A
+    LESS.insert(find(structure, "A"), find(structure, "B"));
+    LESS.insert(find(structure, "A"), find(structure, "D"));
+    NLESS.insert(find(structure, "C"), find(structure, "A"));
+
+    const char * filename = "assume_test.facts";
+    {
+        std::ofstream file(filename);
+        for (size_t i = 1; i < NAME_COUNT; ++i) {
+            file << "LESS A " << NAMES[i] << "\n";
+        }
+        file << "LESS A B\n"; // repeated
+        file << "LESS B C\n";
+        file << "NLESS C A\n";
+        file << "NLESS C B\n";
+        file << "EQUAL A A\n";
+    }
+    auto counts = assume(structure, filename);
+    std::remove(filename);
+
+    POMAGMA_ASSERT_EQ(counts["pos"], NAME_COUNT - 3 + 1);
+    POMAGMA_ASSERT_EQ(counts["neg"], 1);
+    POMAGMA_ASSERT_EQ(counts["merge"], 0);
+    for (size_t i = 1; i < NAME_COUNT; ++i) {
+        POMAGMA_ASSERT(
+            LESS.find(find(structure, "A"), find(structure, NAMES[i])),
+            "missing LESS A " << NAMES[i]);
+    }
+    POMAGMA_ASSERT(LESS.find(find(structure, "B"), find(structure, "C")),
+        "missing LESS B C");
+    POMAGMA_ASSERT(NLESS.find(find(structure, "C"), find(structure, "B")),
+        "missing NLESS C B");
+    POMAGMA_ASSERT_EQ(LESS.count_pairs(), NAME_COUNT - 1 + 1);
+    POMAGMA_ASSERT_EQ(NLESS.count_pairs(), 2);
+    structure.validate();
+}
+
+int main ()
+{
+    Log::Context log_context("Theorist Assume Test");
+
+    test_assume_facts_already_holding();
+
+    return 0;
+}
@@ -12,11 +12,10 @@ namespace pomagma
 namespace detail
 {
 
-std::vector<Ob> conjecture_diverge (
+std::vector<Ob> collect_conjectures (
         Structure & structure,
         const std::vector<float> & probs,
-        const std::vector<std::string> & routes,
-        const char * conjectures_file)
+        size_t max_count)
 {
     POMAGMA_INFO("Conjecturing divergent terms");
     const Carrier & carrier = structure.carrier();
@@ -25,32 +24,51 @@ std::vector<Ob> conjecture_diverge (
     const Ob TOP = structure.nullary_function("TOP").find();
 
     POMAGMA_DEBUG("collecting conjectures");
-    DenseSet conjecture_set(carrier.item_count());
-    conjecture_set.set_diff(carrier.support(), NLESS.get_Rx_set(BOT));
-    POMAGMA_ASSERT(conjecture_set.contains(BOT), "BOT not conjectured");
-    POMAGMA_ASSERT(not conjecture_set.contains(TOP), "TOP conjectured");
-    conjecture_set.remove(BOT);
+    POMAGMA_ASSERT(not NLESS.find(BOT, BOT), "BOT not conjectured");
+    POMAGMA_ASSERT(NLESS.find(TOP, BOT), "TOP conjectured");
+
+    // test divergence a word at a time: an ob is undecided iff it is
+    // supported and not known to be NLESS BOT
+    const DenseSet & support = carrier.support();
+    const DenseSet nless_bot = NLESS.get_Rx_set(BOT);
+    POMAGMA_ASSERT_EQ(support.word_dim(), nless_bot.word_dim());
+    const Word * pos = support.raw_data();
+    const Word * neg = nless_bot.raw_data();
     std::vector<Ob> conjectures;
-    for (auto iter = conjecture_set.iter(); iter.ok(); iter.next()) {
-        Ob ob = * iter;
-        conjectures.push_back(ob);
+    for (size_t quot = 0, end = support.word_dim(); quot < end; ++quot) {
+        for (Word word = pos[quot] & ~neg[quot]; word; word &= word - 1) {
+            Ob ob = quot * BITS_PER_WORD + __builtin_ctzl(word);
+            if (ob != BOT) {
+                conjectures.push_back(ob);
+            }
+        }
     }
 
     POMAGMA_DEBUG("sorting " << conjectures.size() << " conjectures");
-    std::sort(
+    max_count = std::min(max_count, conjectures.size());
+    std::partial_sort(
         conjectures.begin(),
+        conjectures.begin() + max_count,
         conjectures.end(),
         [&](const Ob & x, const Ob & y){ return probs[x] > probs[y]; });
+    conjectures.resize(max_count);
 
+    return conjectures;
+}
+
+void write_conjectures (
+        const std::vector<Ob> & conjectures,
+        const RouteDag & routes,
+        const char * conjectures_file)
+{
     POMAGMA_DEBUG("writing conjectures to " << conjectures_file);
     std::ofstream file(conjectures_file, std::ios::out | std::ios::trunc);
     POMAGMA_ASSERT(file, "failed to open " << conjectures_file);
     file << "# divergence conjectures generated by pomagma";
     for (auto ob : conjectures) {
-        file << "\nEQUAL BOT " << routes[ob];
+        file << "\nEQUAL BOT ";
+        routes.write(file, ob);
     }
-
-    return conjectures;
 }
 
 } // namespace detail
@@ -58,31 +76,32 @@ std::vector<Ob> conjecture_diverge (
 size_t conjecture_diverge (
         Structure & structure,
         const char * language_file,
-        const char * conjectures_file)
+        const char * conjectures_file,
+        size_t max_count)
 {
-    std::vector<float> probs;
-    std::vector<std::string> routes;
     auto language = load_language(language_file);
-    {
-        Router router(structure.signature(), language);
-        probs = router.measure_probs();
-        routes = router.find_routes();
-    }
+    Router router(structure.signature(), language);
+    const std::vector<float> probs = router.measure_probs();
 
-    return conjecture_diverge(structure, probs, routes, conjectures_file);
+    // only routes of conjectured obs are ever serialized
+    const auto conjectures =
+        detail::collect_conjectures(structure, probs, max_count);
+    const RouteDag routes = router.find_route_dag();
+    detail::write_conjectures(conjectures, routes, conjectures_file);
+
+    return conjectures.size();
 }
 
 size_t conjecture_diverge (
         Structure & structure,
         const std::vector<float> & probs,
-        const std::vector<std::string> & routes,
-        const char * conjectures_file)
+        const RouteDag & routes,
+        const char * conjectures_file,
+        size_t max_count)
 {
-    auto conjectures = detail::conjecture_diverge(
-        structure,
-        probs,
-        routes,
-        conjectures_file);
+    const auto conjectures =
+        detail::collect_conjectures(structure, probs, max_count);
+    detail::write_conjectures(conjectures, routes, conjectures_file);
 
     return conjectures.size();
 }
@@ -2,6 +2,7 @@
 
 #include <pomagma/macrostructure/util.hpp>
 #include <pomagma/macrostructure/structure.hpp>
+#include <pomagma/macrostructure/router.hpp>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -9,15 +10,21 @@
 namespace pomagma
 {
 
+// by default all undecided obs are conjectured
+static const size_t DEFAULT_DIVERGE_COUNT = MAX_ITEM_DIM;
+
+// conjectures at most max_count undecided obs, most probable first
 size_t conjecture_diverge (
         Structure & structure,
         const char * language_file,
-        const char * conjectures_file);
+        const char * conjectures_file,
+        size_t max_count = DEFAULT_DIVERGE_COUNT);
 
 size_t conjecture_diverge (
         Structure & structure,
         const std::vector<float> & probs,
-        const std::vector<std::string> & routes,
-        const char * conjectures_file);
+        const RouteDag & routes,
+        const char * conjectures_file,
+        size_t max_count = DEFAULT_DIVERGE_COUNT);
 
 } // namespace pomagma
@@ -5,6 +5,7 @@
 #include <pomagma/macrostructure/router.hpp>
 #include <pomagma/language/language.hpp>
 #include <algorithm>
+#include <mutex>
 
 namespace pomagma
 {
@@ -12,10 +13,49 @@ namespace pomagma
 namespace detail
 {
 
+struct ScoredPair
+{
+    float score;
+    std::pair<Ob, Ob> pair;
+};
+
+// orders by descending score, breaking ties deterministically
+inline bool greater (const ScoredPair & x, const ScoredPair & y)
+{
+    return x.score > y.score or (x.score == y.score and x.pair < y.pair);
+}
+
+// keeps the max_count best pairs as a heap whose front is the worst
+inline void push_bounded (
+        std::vector<ScoredPair> & heap,
+        const ScoredPair & scored,
+        size_t max_count)
+{
+    if (heap.size() < max_count) {
+        heap.push_back(scored);
+        std::push_heap(heap.begin(), heap.end(), greater);
+    } else if (max_count and greater(scored, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        heap.back() = scored;
+        std::push_heap(heap.begin(), heap.end(), greater);
+    }
+}
+
+inline std::vector<Ob> get_obs (const Carrier & carrier)
+{
+    std::vector<Ob> obs;
+    for (auto iter = carrier.iter(); iter.ok(); iter.next()) {
+        obs.push_back(* iter);
+    }
+    return obs;
+}
+
+// Candidates are streamed row by row: rhs ranges over the support minus
+// both NLESS lines of lhs, and each thread keeps only its top max_count pairs.
 std::vector<std::pair<Ob, Ob>> conjecture_equal (
         Structure & structure,
         const std::vector<float> & probs,
-        const std::vector<std::string> & routes,
+        const RouteDag & routes,
         const char * conjectures_file,
         size_t max_count)
 {
@@ -24,45 +64,56 @@ std::vector<std::pair<Ob, Ob>> conjecture_equal (
     const BinaryRelation & NLESS = structure.binary_relation("NLESS");
 
     POMAGMA_DEBUG("collecting conjectures");
-    std::vector<std::pair<Ob, Ob>> conjectures;
-    for (auto iter = carrier.iter(); iter.ok(); iter.next()) {
-        Ob lhs = * iter;
-        for (auto iter = carrier.iter(); iter.ok(); iter.next()) {
-            Ob rhs = * iter;
-            if (rhs >= lhs) { break; }
-            if (NLESS.find_Lx(lhs, rhs)) { continue; }
-            if (NLESS.find_Rx(rhs, lhs)) { continue; }
-            conjectures.push_back(std::make_pair(lhs, rhs));
+    std::vector<ScoredPair> best;
+    const std::vector<Ob> obs = get_obs(carrier);
+    const size_t ob_count = obs.size();
+    std::mutex mutex;
+
+    #pragma omp parallel
+    {
+        DenseSet candidates(carrier.item_dim());
+        std::vector<ScoredPair> batch;
+
+        #pragma omp for schedule(dynamic, 1)
+        for (size_t i = 0; i < ob_count; ++i) {
+            Ob lhs = obs[i];
+            candidates.set_pnn(
+                carrier.support(),
+                NLESS.get_Lx_set(lhs),
+                NLESS.get_Rx_set(lhs));
+            for (auto iter = candidates.iter(); iter.ok(); iter.next()) {
+                Ob rhs = * iter;
+                if (rhs >= lhs) { break; }
+                ScoredPair scored = {
+                    probs[lhs] * probs[rhs],
+                    std::make_pair(lhs, rhs)};
+                push_bounded(batch, scored, max_count);
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (const auto & scored : batch) {
+            push_bounded(best, scored, max_count);
         }
     }
 
     POMAGMA_DEBUG("sorting conjectures");
-    max_count = std::min(max_count, conjectures.size());
-    auto sort_by_prob = [&](
-            const std::pair<Ob, Ob> & x,
-            const std::pair<Ob, Ob> & y)
-    {
-        return probs[x.first] * probs[x.second]
-             > probs[y.first] * probs[y.second];
-    };
-    if (conjectures.size() > max_count) {
-        std::nth_element(
-                conjectures.begin(),
-                conjectures.begin() + max_count,
-                conjectures.end(),
-                sort_by_prob);
-        conjectures.resize(max_count);
+    std::sort_heap(best.begin(), best.end(), greater);
+    std::vector<std::pair<Ob, Ob>> conjectures;
+    for (const auto & scored : best) {
+        conjectures.push_back(scored.pair);
     }
-    std::sort(conjectures.begin(), conjectures.end(), sort_by_prob);
 
     POMAGMA_DEBUG("writing conjectures to " << conjectures_file);
     std::ofstream file(conjectures_file, std::ios::out | std::ios::trunc);
     POMAGMA_ASSERT(file, "failed to open " << conjectures_file);
     file << "# equality conjectures generated by pomagma\n";
     for (auto pair : conjectures) {
-        const auto & lhs = routes[pair.first];
-        const auto & rhs = routes[pair.second];
-        file << "EQUAL " << lhs << " " << rhs << "\n";
+        file << "EQUAL ";
+        routes.write(file, pair.first);
+        file << " ";
+        routes.write(file, pair.second);
+        file << "\n";
     }
 
     return conjectures;
@@ -71,7 +122,7 @@ std::vector<std::pair<Ob, Ob>> conjecture_equal (
 void try_prove_nless (
         Structure & structure,
         const std::unordered_map<std::string, float> & language,
-        const std::vector<std::string> & routes,
+        const RouteDag & routes,
         const std::vector<std::pair<Ob, Ob>> & conjectures,
         const char * conjectures_file,
         const char * theorems_file)
@@ -79,25 +130,60 @@ void try_prove_nless (
     POMAGMA_INFO("Trying to prove inequality theorems");
     const BinaryRelation & LESS = structure.binary_relation("LESS");
 
+    POMAGMA_DEBUG("streaming theorems to " << theorems_file);
+    std::ofstream theorems(theorems_file, std::ios::out | std::ios::app);
+    POMAGMA_ASSERT(theorems, "failed to open " << theorems_file);
+    theorems << "# nless theorems proved by pomagma" << std::endl;
+    size_t theorem_count = 0;
+    std::mutex theorems_mutex;
+
+    const size_t conjecture_count = conjectures.size();
+    std::vector<float> entropies(conjecture_count);
+    {
+        const Router router(structure.signature(), language);
+        RefutationCache refuted;
+
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < conjecture_count; ++i) {
+            const Ob lhs = conjectures[i].first;
+            const Ob rhs = conjectures[i].second;
+            POMAGMA_INFO("Hypothesizing "
+                << routes[lhs] << " = " << routes[rhs]);
+            float entropy = hypothesize_entropy(
+                structure,
+                router,
+                conjectures[i],
+                & refuted);
+            entropies[i] = entropy;
+
+            bool consistent = (entropy > 0);
+            if (not consistent) {
+                std::string nless;
+                if (LESS.find(lhs, rhs)) {
+                    nless = "NLESS " + routes[rhs] + " " + routes[lhs];
+                } else if (LESS.find(rhs, lhs)) {
+                    nless = "NLESS " + routes[lhs] + " " + routes[rhs];
+                }
+                if (not nless.empty()) {
+                    std::unique_lock<std::mutex> lock(theorems_mutex);
+                    theorems << nless << std::endl;
+                    ++theorem_count;
+                }
+            }
+        }
+    }
+    POMAGMA_DEBUG("wrote " << theorem_count << " theorems to " <<
+        theorems_file);
+
     std::vector<std::pair<float, std::string>> filtered_conjectures;
-    std::vector<std::string> theorems;
-    for (auto pair : conjectures) {
-        const Ob lhs = pair.first;
-        const Ob rhs = pair.second;
-        std::string equation = "EQUAL " + routes[lhs] + " " + routes[rhs];
-        POMAGMA_INFO("Hypothesizing " << equation);
-        float entropy = hypothesize_entropy(structure, language, pair);
+    for (size_t i = 0; i < conjecture_count; ++i) {
+        float entropy = entropies[i];
         bool consistent = (entropy > 0);
         if (consistent) {
+            const Ob lhs = conjectures[i].first;
+            const Ob rhs = conjectures[i].second;
+            std::string equation = "EQUAL " + routes[lhs] + " " + routes[rhs];
             filtered_conjectures.push_back(std::make_pair(entropy, equation));
-        } else {
-            if (LESS.find(lhs, rhs)) {
-                std::string nless = "NLESS " + routes[rhs] + " " + routes[lhs];
-                theorems.push_back(nless);
-            } else if (LESS.find(rhs, lhs)) {
-                std::string nless = "NLESS " + routes[lhs] + " " + routes[rhs];
-                theorems.push_back(nless);
-            }
         }
     }
     std::sort(filtered_conjectures.begin(), filtered_conjectures.end());
@@ -113,16 +199,6 @@ void try_prove_nless (
             file << equation << "\n";
         }
     }
-    {
-        POMAGMA_DEBUG("writing " << theorems.size() << " theorems to " <<
-            theorems_file);
-        std::ofstream file(theorems_file, std::ios::out | std::ios::app);
-        POMAGMA_ASSERT(file, "failed to open " << theorems_file);
-        file << "# nless theorems proved by pomagma\n";
-        for (const auto & theorem : theorems) {
-            file << theorem << "\n";
-        }
-    }
 }
 
 } // namespace detail
@@ -134,12 +210,12 @@ size_t conjecture_equal (
         size_t max_count)
 {
     std::vector<float> probs;
-    std::vector<std::string> routes;
+    RouteDag routes;
     {
         const auto language = load_language(language_file);
         Router router(structure.signature(), language);
         probs = router.measure_probs();
-        routes = router.find_routes();
+        routes = router.find_route_dag();
     }
 
     return conjecture_equal(
@@ -153,7 +229,7 @@ size_t conjecture_equal (
 size_t conjecture_equal (
         Structure & structure,
         const std::vector<float> & probs,
-        const std::vector<std::string> & routes,
+        const RouteDag & routes,
         const char * conjectures_file,
         size_t max_count)
 {
@@ -176,12 +252,12 @@ void try_prove_nless (
         size_t max_count)
 {
     std::vector<float> probs;
-    std::vector<std::string> routes;
+    RouteDag routes;
     auto language = load_language(language_file);
     {
         Router router(structure.signature(), language);
         probs = router.measure_probs();
-        routes = router.find_routes();
+        routes = router.find_route_dag();
     }
 
     const auto conjectures = detail::conjecture_equal(
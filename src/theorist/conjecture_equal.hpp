@@ -22,7 +22,7 @@ size_t conjecture_equal (
 size_t conjecture_equal (
         Structure & structure,
         const std::vector<float> & probs,
-        const std::vector<std::string> & routes,
+        const RouteDag & routes,
         const char * conjectures_file,
         size_t max_count = DEFAULT_CONJECTURE_COUNT);
 
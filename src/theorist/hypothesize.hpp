@@ -2,14 +2,19 @@
 
 #include <pomagma/macrostructure/util.hpp>
 #include <pomagma/macrostructure/structure.hpp>
+#include <pomagma/macrostructure/router.hpp>
+#include <pomagma/macrostructure/snapshot.hpp>
 
 namespace pomagma
 {
 
+// This only reads structure, so may be called concurrently.
+// Returns zero entropy if the equation is inconsistent.
 float hypothesize_entropy (
         Structure & structure,
-        const std::unordered_map<std::string, float> & language,
+        const Router & router,
         const std::pair<Ob, Ob> & equation,
+        RefutationCache * refuted = nullptr,
         float reltol = 1e-2f);
 
 } // namespace pomagma